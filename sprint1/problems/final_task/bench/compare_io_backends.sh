@@ -0,0 +1,24 @@
+#!/bin/bash
+# Сравнивает бэкенды Asio: один и тот же game_server, собранный с epoll и с io_uring,
+# под одинаковой нагрузкой http_load (RPS и p99). Обычно запускается целью bench_io_backends.
+# Запуск вручную из каталога сборки, где лежат bin/game_server_{epoll,io_uring} и bin/http_load:
+#   ../bench/compare_io_backends.sh ../data/config.json [аргументы http_load]
+# SERVER_ARGS передаёт серверу дополнительные аргументы, например SERVER_ARGS=--serve-mode=sharded
+set -e
+
+CONFIG=${1:?"Usage: compare_io_backends.sh <game-config-json> [http_load args]"}
+shift
+BIN_DIR=${BIN_DIR:-bin}
+
+echo "kernel: $(uname -r)"
+for BACKEND in epoll io_uring; do
+    "${BIN_DIR}/game_server_${BACKEND}" "${CONFIG}" ${SERVER_ARGS} >/dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 1
+
+    echo "=== backend: ${BACKEND}"
+    "${BIN_DIR}/http_load" "$@" || true
+
+    kill -TERM ${SERVER_PID}
+    wait ${SERVER_PID} || true
+done
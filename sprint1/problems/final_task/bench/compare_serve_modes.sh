@@ -0,0 +1,24 @@
+#!/bin/bash
+# Сравнивает режимы обслуживания game_server: общий io_context и шардирование по ядрам.
+# Запуск из каталога сборки, где лежат bin/game_server и bin/http_load:
+#   ../bench/compare_serve_modes.sh ../data/config.json [аргументы http_load]
+# Запросы обрабатываются в потоках io_context (--scheduling=inline), иначе замер показал бы переход
+# в общий пул потоков, а не разницу режимов. SCHEDULING=priority сравнивает режимы с пулами
+set -e
+
+CONFIG=${1:?"Usage: compare_serve_modes.sh <game-config-json> [http_load args]"}
+shift
+BIN_DIR=${BIN_DIR:-bin}
+SCHEDULING=${SCHEDULING:-inline}
+
+for MODE in shared sharded; do
+    "${BIN_DIR}/game_server" "${CONFIG}" --serve-mode=${MODE} --scheduling=${SCHEDULING} >/dev/null 2>&1 &
+    SERVER_PID=$!
+    sleep 1
+
+    echo "=== serve mode: ${MODE}, scheduling: ${SCHEDULING}"
+    "${BIN_DIR}/http_load" "$@" || true
+
+    kill -TERM ${SERVER_PID}
+    wait ${SERVER_PID} || true
+done
@@ -0,0 +1,161 @@
+// bench/compression_bench.cpp
+// Цена сжатия gzip в процессорном времени против сэкономленных байт.
+// Входные данные: JSON большой карты (по умолчанию 10 000 дорог, как ответ /api/v1/maps/:id)
+// и файлы, переданные в командной строке (например, static/js/three.js).
+// Для каждого входа и степени сжатия печатает время сжатия, скорость, размер результата,
+// долю сэкономленных байт и сколько миллисекунд процессора стоит каждый сэкономленный мегабайт.
+// Для карты сравнивает также сжатие целиком и на лету (GzipBodyStream поверх MapJsonStream,
+// как при отправке карты, которой нет в каталоге) и проверяет, что результаты совпадают.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dynamic_compression.h"
+#include "map_json.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int LEVELS[] = {1, 4, 6, 9};
+
+double ToMs(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+model::Map MakeMap(std::size_t roads) {
+    model::Map map{model::Map::Id{"big"}, "Big map"};
+    for (std::size_t i = 0; i < roads; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        if (i % 2 == 0) {
+            map.AddRoad({model::Road::HORIZONTAL, {c, c + 1}, c + 40});
+        } else {
+            map.AddRoad({model::Road::VERTICAL, {c, c + 1}, c + 30});
+        }
+    }
+    for (std::size_t i = 0; i < roads / 10; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        map.AddBuilding(model::Building{{{c, c}, {30, 20}}});
+    }
+    for (std::size_t i = 0; i < roads / 100; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        map.AddOffice({model::Office::Id{"o" + std::to_string(i)}, {c, c}, {5, 0}});
+    }
+    return map;
+}
+
+struct Result {
+    double ms = 0;
+    std::size_t compressed_size = 0;
+};
+
+template <typename Fn>
+Result Measure(std::size_t iterations, Fn&& fn) {
+    Result result;
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        result.compressed_size = fn();
+    }
+    result.ms = ToMs(Clock::now() - start) / static_cast<double>(iterations);
+    return result;
+}
+
+void Print(std::string_view name, std::size_t original_size, const Result& result) {
+    const double original_mb = static_cast<double>(original_size) / (1024 * 1024);
+    const auto saved = original_size - std::min(original_size, result.compressed_size);
+    const double saved_mb = static_cast<double>(saved) / (1024 * 1024);
+    std::cout << "  " << name << std::fixed << std::setprecision(2) << result.ms << " ms, "
+              << (result.ms > 0 ? original_mb / (result.ms / 1000) : 0) << " MB/s, " << result.compressed_size
+              << " bytes, saved " << (original_size != 0 ? 100.0 * saved / original_size : 0) << "%, "
+              << (saved_mb > 0 ? result.ms / saved_mb : 0) << " CPU ms per saved MB\n";
+}
+
+void BenchBuffer(std::string_view name, std::string_view data, std::size_t iterations) {
+    std::cout << name << ": " << data.size() << " bytes\n";
+    for (int level : LEVELS) {
+        const auto result = Measure(iterations, [&] {
+            return http_server::GzipCompress(data, level).size();
+        });
+        Print("gzip -" + std::to_string(level) + ":            ", data.size(), result);
+    }
+}
+
+bool ReadFile(const char* path, std::string& data) {
+    std::ifstream input{path, std::ios::binary};
+    if (!input) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t roads = 10'000;
+    std::size_t iterations = 10;
+    std::vector<const char*> files;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--roads="sv)) {
+            roads = std::max(1, std::atoi(argv[i] + "--roads="sv.size()));
+        } else if (arg.starts_with("--iterations="sv)) {
+            iterations = std::max(1, std::atoi(argv[i] + "--iterations="sv.size()));
+        } else if (arg.starts_with("--"sv)) {
+            std::cerr << "Usage: compression_bench [--roads=N] [--iterations=N] [file...]"sv << std::endl;
+            return EXIT_FAILURE;
+        } else {
+            files.push_back(argv[i]);
+        }
+    }
+
+    const auto map = MakeMap(roads);
+    std::string map_json;
+    json_writer::JsonWriter writer{map_json};
+    http_handler::WriteMap(writer, map);
+    BenchBuffer("map JSON, " + std::to_string(roads) + " roads", map_json, iterations);
+
+    // На лету: части по 16 КБ, как при отправке карты с Transfer-Encoding: chunked
+    const http_server::DynamicCompressionOptions options;
+    auto budget = std::make_shared<http_server::CompressionBudget>(1);
+    std::string streamed;
+    const auto stream = Measure(iterations, [&] {
+        http_server::GzipBodyStream gzip_stream{std::make_unique<http_handler::MapJsonStream>(map), options.level,
+                                                std::move(*budget->TryAcquire())};
+        streamed.clear();
+        std::string chunk;
+        bool more = true;
+        while (more) {
+            chunk.clear();
+            more = gzip_stream.Next(chunk);
+            streamed += chunk;
+        }
+        return streamed.size();
+    });
+    Print("stream -" + std::to_string(options.level) + " (16 KB parts): ", map_json.size(), stream);
+
+    for (const char* path : files) {
+        std::string data;
+        if (!ReadFile(path, data)) {
+            std::cerr << "Failed to read "sv << path << std::endl;
+            return EXIT_FAILURE;
+        }
+        BenchBuffer(path, data, iterations);
+    }
+
+    // Части сжимаются тем же кодировщиком, что и буфер целиком, поэтому результат совпадает
+    // с GzipCompress байт в байт
+    if (streamed != http_server::GzipCompress(map_json, options.level)) {
+        std::cerr << "Streamed and buffered gzip differ"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+}
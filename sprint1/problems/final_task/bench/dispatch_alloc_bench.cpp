@@ -0,0 +1,132 @@
+// bench/dispatch_alloc_bench.cpp
+// Микробенчмарк передачи запроса обработчику и ответа обратно в сессию, без сети.
+// Сравнивает прежнюю схему со стиранием типа через std::function и текущую:
+//   before — обработчик хранится в std::function, для каждого запроса создаётся лямбда отправки,
+//            которую сессия и обработчик дважды оборачивают в std::function;
+//   after  — тип обработчика известен сессии на этапе компиляции, колбэк отправки —
+//            ResponseSender, а обработчик приводит его к SmallFunction.
+// Для каждой схемы печатает число выделений памяти и время в расчёте на один запрос.
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include "alloc_counter.h"
+#include "http_server.h"
+#include "small_function.h"
+
+using namespace std::literals;
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace {
+
+using http_server::Request;
+using http_server::Response;
+
+// Заменяет сессию: принимает ответы и считает их
+struct ResponseSink {
+    std::size_t responses = 0;
+
+    void OnResponse(std::uint64_t /*seq*/, Response&& /*res*/) {
+        ++responses;
+    }
+};
+
+// Колбэк отправки того же устройства, что и http_server::ResponseSender
+class SinkSender {
+public:
+    SinkSender(std::shared_ptr<ResponseSink> sink, std::uint64_t seq) noexcept
+        : sink_(std::move(sink))
+        , seq_(seq) {
+    }
+
+    void operator()(Response&& res) const {
+        sink_->OnResponse(seq_, std::move(res));
+    }
+
+private:
+    std::shared_ptr<ResponseSink> sink_;
+    std::uint64_t seq_;
+};
+static_assert(sizeof(SinkSender) == sizeof(http_server::ResponseSender));
+
+// Обработчик, который, как http_handler::RequestHandler, приводит колбэк к конкретному типу
+template <typename SendCallback>
+struct Handler {
+    http_server::PreparedResponsePtr prepared;
+
+    template <typename Send>
+    void operator()(Request&& req, Send&& send) const {
+        SendCallback sender = std::forward<Send>(send);
+        sender(http_server::CachedResponse{prepared, req.version(), req.keep_alive()});
+    }
+};
+
+struct Result {
+    double allocations_per_request;
+    double ns_per_request;
+};
+
+template <typename Dispatch>
+Result Measure(std::size_t requests, Dispatch&& dispatch) {
+    const auto allocations_before = alloc_counter::GetThreadAllocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t seq = 0; seq < requests; ++seq) {
+        dispatch(seq);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocations = alloc_counter::GetThreadAllocations() - allocations_before;
+    return {
+        static_cast<double>(allocations) / static_cast<double>(requests),
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+            / static_cast<double>(requests),
+    };
+}
+
+void Print(std::string_view name, const Result& result) {
+    std::cout << name << "allocations/request: " << result.allocations_per_request
+              << ", ns/request: " << result.ns_per_request << '\n';
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t requests = 1'000'000;
+    if (argc > 2) {
+        std::cerr << "Usage: dispatch_alloc_bench [requests]"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (argc == 2) {
+        requests = std::max(1, std::atoi(argv[1]));
+    }
+
+    const auto prepared = http_server::MakePreparedResponse(http::status::ok, "application/json", "[]");
+    auto sink = std::make_shared<ResponseSink>();
+
+    // Запрос создаётся один раз: его разбор одинаков в обеих схемах и здесь не измеряется
+    Request req{http::verb::get, "/api/v1/maps", 11};
+
+    // Прежняя схема
+    using ErasedSend = std::function<void(Response&&)>;
+    std::function<void(Request&&, ErasedSend&&)> erased_handler = Handler<ErasedSend>{prepared};
+    const auto before = Measure(requests, [&](std::uint64_t seq) {
+        auto send_cb = [self = sink, seq](Response&& res) {
+            self->OnResponse(seq, std::move(res));
+        };
+        erased_handler(std::move(req), std::move(send_cb));
+    });
+
+    // Текущая схема
+    Handler<http_server::SmallFunction<void(Response&&)>> handler{prepared};
+    const auto after = Measure(requests, [&](std::uint64_t seq) {
+        handler(std::move(req), SinkSender{sink, seq});
+    });
+
+    std::cout << "requests: " << requests << '\n';
+    Print("before (std::function): "sv, before);
+    Print("after  (templated):     "sv, after);
+    return sink->responses == 2 * requests ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,192 @@
+// bench/dog_tick_bench.cpp
+// Тик игры для миллиона собак (по умолчанию) на синтетическом городе из road_index_bench: собаки
+// стоят в случайных точках дорог и идут в случайных направлениях со случайной скоростью, пока
+// не упрутся в край дороги. Сравнивает:
+//   aos — прежнее устройство: каждая собака — объект в куче за std::shared_ptr, поля (положение,
+//         скорость, направление, рюкзак, очки) перемешаны, собаки сеанса перебираются по указателям;
+//   soa — model::DogStore: поля в отдельных плотных массивах, векторизуемое ядро Advance.
+// Печатает время одного тика для каждого способа и проверяет, что положения собак совпадают.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "dog_store.h"
+#include "road_index.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr model::Coord BLOCK = 10;
+constexpr double TICK_SECONDS = 0.05;
+
+std::vector<model::Road> MakeCity(std::size_t target_roads) {
+    std::size_t n = 2;
+    while (2 * (n + 1) * n <= target_roads) {
+        ++n;
+    }
+    std::vector<model::Road> roads;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto line = static_cast<model::Coord>(i) * BLOCK;
+        for (std::size_t j = 0; j + 1 < n; ++j) {
+            const auto from = static_cast<model::Coord>(j) * BLOCK;
+            roads.emplace_back(model::Road::HORIZONTAL, model::Point{from, line}, from + BLOCK);
+            roads.emplace_back(model::Road::VERTICAL, model::Point{line, from + BLOCK}, from);
+        }
+    }
+    return roads;
+}
+
+// Собака в прежнем устройстве: всё состояние в одном объекте в куче
+struct HeapDog {
+    model::Position position;
+    model::Speed speed;
+    model::Direction direction;
+    double limit;
+    double time_left;
+    std::vector<int> bag;
+    int score = 0;
+};
+
+struct Movement {
+    model::Direction direction;
+    double speed;
+};
+
+bool IsHorizontal(model::Direction direction) {
+    return direction == model::Direction::WEST || direction == model::Direction::EAST;
+}
+
+// То же правило, что у DogStore::SetMovement
+void SetMovement(HeapDog& dog, const model::RoadIndex& index, Movement movement) {
+    const auto target = index.GetFarthestPoint(dog.position, movement.direction);
+    const bool horizontal = IsHorizontal(movement.direction);
+    const double sign =
+        movement.direction == model::Direction::EAST || movement.direction == model::Direction::SOUTH ? 1.0 : -1.0;
+    dog.direction = movement.direction;
+    dog.limit = horizontal ? target.x : target.y;
+    dog.speed = horizontal ? model::Speed{sign * movement.speed, 0.0} : model::Speed{0.0, sign * movement.speed};
+    const double distance = horizontal ? std::abs(target.x - dog.position.x) : std::abs(target.y - dog.position.y);
+    dog.time_left = movement.speed > 0.0 ? distance / movement.speed : 0.0;
+}
+
+void Advance(const std::vector<std::shared_ptr<HeapDog>>& dogs, double dt) {
+    for (const auto& dog : dogs) {
+        const double step = std::max(std::min(dt, dog->time_left), 0.0);
+        dog->position.x += dog->speed.vx * step;
+        dog->position.y += dog->speed.vy * step;
+        dog->time_left -= step;
+    }
+}
+
+model::Position GetClampedPosition(const HeapDog& dog) {
+    auto position = dog.position;
+    double& along = IsHorizontal(dog.direction) ? position.x : position.y;
+    along = dog.direction == model::Direction::EAST || dog.direction == model::Direction::SOUTH
+              ? std::min(along, dog.limit)
+              : std::max(along, dog.limit);
+    return position;
+}
+
+double MsPerTick(Clock::duration elapsed, std::size_t ticks) {
+    return std::chrono::duration<double, std::milli>(elapsed).count() / static_cast<double>(ticks);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t dogs_count = 1'000'000;
+    std::size_t ticks = 100;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--dogs="sv)) {
+            dogs_count = std::max(1, std::atoi(argv[i] + "--dogs="sv.size()));
+        } else if (arg.starts_with("--ticks="sv)) {
+            ticks = std::max(1, std::atoi(argv[i] + "--ticks="sv.size()));
+        } else {
+            std::cerr << "Usage: dog_tick_bench [--dogs=N] [--ticks=N]"sv << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto roads = MakeCity(10'000);
+    const model::RoadIndex index{roads};
+
+    std::mt19937_64 random{42};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::uniform_real_distribution<double> speed{0.5, 5.0};
+    std::uniform_int_distribution<std::size_t> road_index{0, roads.size() - 1};
+    std::uniform_int_distribution<int> direction{0, 3};
+
+    model::DogStore store{index};
+    store.Reserve(dogs_count);
+    std::vector<model::DogStore::Handle> handles;
+    handles.reserve(dogs_count);
+    std::vector<std::shared_ptr<HeapDog>> heap_dogs;
+    heap_dogs.reserve(dogs_count);
+    for (std::size_t i = 0; i < dogs_count; ++i) {
+        const auto& road = roads[road_index(random)];
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        const double t = unit(random);
+        const model::Position position{start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t};
+        const Movement movement{static_cast<model::Direction>(direction(random)), speed(random)};
+
+        auto dog = store.Get(store.Add(position));
+        dog.SetMovement(movement.direction, movement.speed);
+        handles.push_back(dog.GetHandle());
+
+        auto heap_dog = std::make_shared<HeapDog>();
+        heap_dog->position = position;
+        SetMovement(*heap_dog, index, movement);
+        heap_dogs.push_back(std::move(heap_dog));
+    }
+    // В долгоживущем сервере собаки создаются вперемешку с другими объектами, и порядок
+    // перебора сеанса не совпадает с порядком в памяти
+    std::vector<std::size_t> order(dogs_count);
+    for (std::size_t i = 0; i < dogs_count; ++i) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+    std::vector<std::shared_ptr<HeapDog>> session_dogs;
+    session_dogs.reserve(dogs_count);
+    for (std::size_t i : order) {
+        session_dogs.push_back(heap_dogs[i]);
+    }
+
+    auto start = Clock::now();
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        Advance(session_dogs, TICK_SECONDS);
+    }
+    const auto aos_time = Clock::now() - start;
+
+    start = Clock::now();
+    for (std::size_t tick = 0; tick < ticks; ++tick) {
+        store.Advance(TICK_SECONDS);
+    }
+    const auto soa_time = Clock::now() - start;
+
+    std::size_t moving = 0;
+    for (std::size_t i = 0; i < dogs_count; ++i) {
+        const auto position = store.Get(handles[i]).GetPosition();
+        const auto expected = GetClampedPosition(*heap_dogs[i]);
+        if (std::abs(position.x - expected.x) > 1e-9 || std::abs(position.y - expected.y) > 1e-9) {
+            std::cerr << "Store and heap dogs disagree at dog "sv << i << std::endl;
+            return EXIT_FAILURE;
+        }
+        const auto dog_speed = store.Get(handles[i]).GetSpeed();
+        moving += dog_speed.vx != 0.0 || dog_speed.vy != 0.0 ? 1 : 0;
+    }
+
+    std::cout << "dogs: " << dogs_count << ", ticks: " << ticks << " of " << TICK_SECONDS << " s, still moving: "
+              << moving << '\n';
+    std::cout << "tick:  aos " << MsPerTick(aos_time, ticks) << " ms, soa " << MsPerTick(soa_time, ticks)
+              << " ms\n";
+}
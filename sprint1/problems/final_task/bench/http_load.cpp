@@ -0,0 +1,239 @@
+// bench/http_load.cpp
+// Нагрузочный HTTP-клиент: держит заданное число keep-alive соединений с сервером,
+// в течение заданного времени шлёт по ним GET-запросы и печатает пропускную способность
+// и перцентили задержки. С --pipeline=N запросы отправляются пачками по N без ожидания ответов.
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace std::literals;
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = net::ip::tcp;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Params {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    std::string target = "/api/v1/maps";
+    unsigned connections = 64;
+    // Сколько запросов отправляется подряд, не дожидаясь ответов (HTTP/1.1 pipelining)
+    unsigned pipeline = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency() / 2);
+    std::chrono::seconds duration{10s};
+};
+
+// Статистика одного потока клиента. Объединяется после завершения замера
+struct Stats {
+    std::vector<Clock::duration> latencies;
+    std::size_t errors = 0;
+
+    void Merge(Stats&& other) {
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+        errors += other.errors;
+    }
+};
+
+// Формирует текст из pipeline одинаковых GET-запросов, идущих подряд
+std::string MakeRequestBatch(const Params& params) {
+    http::request<http::empty_body> request;
+    request.method(http::verb::get);
+    request.target(params.target);
+    request.version(11);
+    request.set(http::field::host, params.host);
+    request.keep_alive(true);
+    request.prepare_payload();
+
+    std::ostringstream one;
+    one << request;
+    std::string batch;
+    for (unsigned i = 0; i < params.pipeline; ++i) {
+        batch += one.str();
+    }
+    return batch;
+}
+
+// Одно keep-alive соединение: пачка запросов -> ответы на них -> следующая пачка,
+// пока не истечёт время
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(net::io_context& ioc, const std::string& batch, unsigned pipeline, Clock::time_point deadline,
+               Stats& stats)
+        : socket_(ioc)
+        , batch_(batch)
+        , pipeline_(pipeline)
+        , deadline_(deadline)
+        , stats_(stats) {
+    }
+
+    void Start(const tcp::resolver::results_type& endpoints) {
+        net::async_connect(socket_, endpoints,
+                           [self = shared_from_this()](beast::error_code ec, const tcp::endpoint&) {
+                               if (ec) {
+                                   ++self->stats_.errors;
+                                   return;
+                               }
+                               self->socket_.set_option(tcp::no_delay(true));
+                               self->DoWrite();
+                           });
+    }
+
+private:
+    void DoWrite() {
+        if (Clock::now() >= deadline_) {
+            beast::error_code ec;
+            socket_.shutdown(tcp::socket::shutdown_both, ec);
+            return;
+        }
+        sent_at_ = Clock::now();
+        pending_ = pipeline_;
+        net::async_write(socket_, net::buffer(batch_), [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                ++self->stats_.errors;
+                return;
+            }
+            self->DoRead();
+        });
+    }
+
+    void DoRead() {
+        response_ = {};
+        http::async_read(socket_, buffer_, response_, [self = shared_from_this()](beast::error_code ec, std::size_t) {
+            if (ec) {
+                ++self->stats_.errors;
+                return;
+            }
+            self->stats_.latencies.push_back(Clock::now() - self->sent_at_);
+            if (self->response_.need_eof()) {
+                ++self->stats_.errors;
+                return;
+            }
+            if (--self->pending_ > 0) {
+                return self->DoRead();
+            }
+            self->DoWrite();
+        });
+    }
+
+    tcp::socket socket_;
+    beast::flat_buffer buffer_;
+    const std::string& batch_;
+    unsigned pipeline_;
+    unsigned pending_ = 0;
+    http::response<http::string_body> response_;
+    Clock::time_point sent_at_;
+    Clock::time_point deadline_;
+    Stats& stats_;
+};
+
+std::optional<Params> ParseCommandLine(int argc, const char* const argv[]) {
+    Params params;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto value_of = [arg](std::string_view name) -> std::optional<std::string_view> {
+            if (arg.starts_with(name) && arg.size() > name.size() && arg[name.size()] == '=') {
+                return arg.substr(name.size() + 1);
+            }
+            return std::nullopt;
+        };
+        if (auto v = value_of("--host"sv)) {
+            params.host = *v;
+        } else if (auto v = value_of("--port"sv)) {
+            params.port = *v;
+        } else if (auto v = value_of("--target"sv)) {
+            params.target = *v;
+        } else if (auto v = value_of("--connections"sv)) {
+            params.connections = std::max(1, std::atoi(std::string(*v).c_str()));
+        } else if (auto v = value_of("--pipeline"sv)) {
+            params.pipeline = std::max(1, std::atoi(std::string(*v).c_str()));
+        } else if (auto v = value_of("--threads"sv)) {
+            params.threads = std::max(1, std::atoi(std::string(*v).c_str()));
+        } else if (auto v = value_of("--duration"sv)) {
+            params.duration = std::chrono::seconds{std::max(1, std::atoi(std::string(*v).c_str()))};
+        } else {
+            return std::nullopt;
+        }
+    }
+    return params;
+}
+
+double ToMicroseconds(Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    auto params = ParseCommandLine(argc, argv);
+    if (!params) {
+        std::cerr << "Usage: http_load [--host=H] [--port=P] [--target=T] [--connections=N] [--threads=N] "
+                     "[--pipeline=N] [--duration=SECONDS]"sv
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const std::string batch = MakeRequestBatch(*params);
+    const auto started_at = Clock::now();
+    const auto deadline = started_at + params->duration;
+
+    std::vector<Stats> stats(params->threads);
+    std::vector<std::jthread> workers;
+    workers.reserve(params->threads);
+    for (unsigned t = 0; t < params->threads; ++t) {
+        workers.emplace_back([&params, &batch, &stats, deadline, t] {
+            net::io_context ioc(1);
+            tcp::resolver resolver(ioc);
+            auto endpoints = resolver.resolve(params->host, params->port);
+            // Соединения распределяются между потоками поровну
+            for (unsigned c = t; c < params->connections; c += params->threads) {
+                std::make_shared<Connection>(ioc, batch, params->pipeline, deadline, stats[t])->Start(endpoints);
+            }
+            ioc.run();
+        });
+    }
+    workers.clear();
+    const auto elapsed = Clock::now() - started_at;
+
+    Stats total;
+    for (auto& s : stats) {
+        total.Merge(std::move(s));
+    }
+    auto& latencies = total.latencies;
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double p) {
+        if (latencies.empty()) {
+            return 0.0;
+        }
+        auto index = static_cast<std::size_t>(p * static_cast<double>(latencies.size() - 1));
+        return ToMicroseconds(latencies[index]);
+    };
+
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << "target:      " << params->target << '\n'
+              << "connections: " << params->connections << '\n'
+              << "pipeline:    " << params->pipeline << '\n'
+              << "requests:    " << latencies.size() << '\n'
+              << "errors:      " << total.errors << '\n'
+              << "rps:         " << static_cast<std::size_t>(static_cast<double>(latencies.size()) / seconds) << '\n'
+              << "p50, us:     " << percentile(0.50) << '\n'
+              << "p99, us:     " << percentile(0.99) << '\n'
+              << "max, us:     " << percentile(1.0) << std::endl;
+}
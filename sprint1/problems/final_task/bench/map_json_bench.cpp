@@ -0,0 +1,190 @@
+// bench/map_json_bench.cpp
+// Сериализация большой карты (по умолчанию 100 000 дорог) в JSON тремя способами:
+//   dom    — прежняя схема: дерево boost::json::object, json::serialize и копия строки в тело ответа;
+//   writer — JsonWriter дописывает JSON прямо в строку тела (WriteMap);
+//   stream — MapJsonStream отдаёт JSON частями по 16 КБ, как при отправке с Transfer-Encoding: chunked.
+// Для каждого способа печатает время и число выделений памяти на одну сериализацию,
+// для stream — ещё и время до первой части. Проверяет, что все способы дают одинаковые байты.
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "alloc_counter.h"
+#include "map_json.h"
+
+using namespace std::literals;
+namespace json = boost::json;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double ToMs(Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+model::Map MakeMap(std::size_t roads) {
+    model::Map map{model::Map::Id{"big"}, "Big map"};
+    for (std::size_t i = 0; i < roads; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        if (i % 2 == 0) {
+            map.AddRoad({model::Road::HORIZONTAL, {c, c + 1}, c + 40});
+        } else {
+            map.AddRoad({model::Road::VERTICAL, {c, c + 1}, c + 30});
+        }
+    }
+    for (std::size_t i = 0; i < roads / 10; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        map.AddBuilding(model::Building{{{c, c}, {30, 20}}});
+    }
+    for (std::size_t i = 0; i < roads / 100; ++i) {
+        const auto c = static_cast<model::Coord>(i);
+        map.AddOffice({model::Office::Id{"o" + std::to_string(i)}, {c, c}, {5, 0}});
+    }
+    return map;
+}
+
+// Прежнее построение ответа на /api/v1/maps/:id
+json::object MapToJson(const model::Map& map) {
+    json::object map_obj;
+    map_obj["id"] = *map.GetId();
+    map_obj["name"] = map.GetName();
+    json::array roads_json;
+    for (const auto& road : map.GetRoads()) {
+        json::object road_obj;
+        road_obj["x0"] = road.GetStart().x;
+        road_obj["y0"] = road.GetStart().y;
+        if (road.IsHorizontal()) {
+            road_obj["x1"] = road.GetEnd().x;
+        } else {
+            road_obj["y1"] = road.GetEnd().y;
+        }
+        roads_json.push_back(std::move(road_obj));
+    }
+    map_obj["roads"] = std::move(roads_json);
+    json::array buildings_json;
+    for (const auto& building : map.GetBuildings()) {
+        const auto& bounds = building.GetBounds();
+        json::object building_obj;
+        building_obj["x"] = bounds.position.x;
+        building_obj["y"] = bounds.position.y;
+        building_obj["w"] = bounds.size.width;
+        building_obj["h"] = bounds.size.height;
+        buildings_json.push_back(std::move(building_obj));
+    }
+    map_obj["buildings"] = std::move(buildings_json);
+    json::array offices_json;
+    for (const auto& office : map.GetOffices()) {
+        json::object office_obj;
+        office_obj["id"] = *office.GetId();
+        office_obj["x"] = office.GetPosition().x;
+        office_obj["y"] = office.GetPosition().y;
+        office_obj["offsetX"] = office.GetOffset().dx;
+        office_obj["offsetY"] = office.GetOffset().dy;
+        offices_json.push_back(std::move(office_obj));
+    }
+    map_obj["offices"] = std::move(offices_json);
+    return map_obj;
+}
+
+struct Result {
+    double ms = 0;
+    double allocations = 0;
+    // Только для stream: время до первой части
+    double first_chunk_ms = 0;
+    std::string output;
+};
+
+template <typename Fn>
+Result Measure(std::size_t iterations, Fn&& fn) {
+    Result result;
+    const auto allocations_before = alloc_counter::GetThreadAllocations();
+    const auto start = Clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+        fn(result);
+    }
+    result.ms = ToMs(Clock::now() - start) / static_cast<double>(iterations);
+    result.first_chunk_ms /= static_cast<double>(iterations);
+    result.allocations = static_cast<double>(alloc_counter::GetThreadAllocations() - allocations_before)
+                         / static_cast<double>(iterations);
+    return result;
+}
+
+void Print(std::string_view name, const Result& result) {
+    std::cout << name << result.ms << " ms, allocations: " << result.allocations;
+    if (result.first_chunk_ms > 0) {
+        std::cout << ", first chunk after " << result.first_chunk_ms << " ms";
+    }
+    std::cout << '\n';
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t roads = 100'000;
+    std::size_t iterations = 10;
+    if (argc > 3) {
+        std::cerr << "Usage: map_json_bench [roads] [iterations]"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (argc >= 2) {
+        roads = std::max(1, std::atoi(argv[1]));
+    }
+    if (argc == 3) {
+        iterations = std::max(1, std::atoi(argv[2]));
+    }
+    const auto map = MakeMap(roads);
+
+    const auto dom = Measure(iterations, [&](Result& result) {
+        const auto serialized = json::serialize(MapToJson(map));
+        // Как и прежде, сериализованная строка копируется в тело ответа
+        result.output.assign(serialized.data(), serialized.size());
+    });
+
+    const auto writer = Measure(iterations, [&](Result& result) {
+        std::string body;
+        json_writer::JsonWriter json_writer{body};
+        http_handler::WriteMap(json_writer, map);
+        result.output = std::move(body);
+    });
+
+    // Части отдаются через один буфер, как в StreamBody: здесь они были бы отправлены в сокет
+    auto stream_map = [&](auto&& on_chunk) {
+        http_handler::MapJsonStream map_stream{map};
+        std::string chunk;
+        bool more = true;
+        while (more) {
+            chunk.clear();
+            more = map_stream.Next(chunk);
+            on_chunk(chunk);
+        }
+    };
+    const auto stream = Measure(iterations, [&](Result& result) {
+        const auto start = Clock::now();
+        bool first = true;
+        stream_map([&](const std::string&) {
+            if (first) {
+                result.first_chunk_ms += ToMs(Clock::now() - start);
+                first = false;
+            }
+        });
+    });
+    std::string streamed;
+    stream_map([&](const std::string& chunk) {
+        streamed += chunk;
+    });
+
+    std::cout << "roads: " << map.GetRoads().size() << ", buildings: " << map.GetBuildings().size()
+              << ", offices: " << map.GetOffices().size() << ", JSON size: " << writer.output.size() << " bytes\n";
+    Print("dom    (boost::json): "sv, dom);
+    Print("writer (JsonWriter):  "sv, writer);
+    Print("stream (16 KB parts): "sv, stream);
+
+    if (dom.output != writer.output || writer.output != streamed) {
+        std::cerr << "Outputs differ"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,143 @@
+// bench/player_action_bench.cpp
+// Микробенчмарк запроса действия игрока без сети: маршрутизация POST /api/v1/game/player/action
+// и разбор тела вроде {"move":"L"}. Сравнивает:
+//   dom  — маршрутизатор и boost::json::parse в дерево с памятью из кучи;
+//   fast — маршрутизатор и ParsePlayerAction: каноническая форма разбирается на месте,
+//          остальные тела — деревом в буфере на стеке.
+// Для каждого способа печатает число выделений памяти, время на запрос и запросы в секунду
+// на одном ядре. Проверяет, что оба способа одинаково принимают и отвергают все тела.
+#include <boost/json.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "player_action.h"
+#include "router.h"
+
+using namespace std::literals;
+namespace http = boost::beast::http;
+namespace json = boost::json;
+
+namespace {
+
+struct Result {
+    double allocations_per_request;
+    double ns_per_request;
+};
+
+template <typename Handle>
+Result Measure(std::size_t requests, const std::vector<std::string>& bodies, Handle&& handle) {
+    const auto allocations_before = alloc_counter::GetThreadAllocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < requests; ++i) {
+        handle(bodies[i % bodies.size()]);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocations = alloc_counter::GetThreadAllocations() - allocations_before;
+    return {
+        static_cast<double>(allocations) / static_cast<double>(requests),
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+            / static_cast<double>(requests),
+    };
+}
+
+void Print(std::string_view name, const Result& result) {
+    std::cout << name << "allocations/request: " << result.allocations_per_request
+              << ", ns/request: " << result.ns_per_request
+              << ", Mrequests/s: " << 1000.0 / result.ns_per_request << '\n';
+}
+
+// Прежний разбор: дерево boost::json в куче
+std::optional<http_handler::PlayerAction> ParseWithDom(std::string_view body) {
+    json::error_code ec;
+    const auto value = json::parse(json::string_view{body.data(), body.size()}, ec);
+    if (ec || !value.is_object()) {
+        return std::nullopt;
+    }
+    const auto* move = value.get_object().if_contains("move");
+    if (!move || !move->is_string()) {
+        return std::nullopt;
+    }
+    const auto& text = move->get_string();
+    const auto direction = http_handler::ParseMoveDirection(std::string_view(text.data(), text.size()));
+    if (!direction) {
+        return std::nullopt;
+    }
+    return http_handler::PlayerAction{.move = *direction};
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t requests = 10'000'000;
+    if (argc > 2) {
+        std::cerr << "Usage: player_action_bench [requests]"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (argc == 2) {
+        requests = std::max(1, std::atoi(argv[1]));
+    }
+
+    // Таблица маршрутов сервера и маршрут действия игрока
+    http_server::Router<int> router;
+    router.Add("/api/v1/maps", {http::verb::get}, 0);
+    router.Add("/api/v1/maps/:id", {http::verb::get}, 1);
+    router.Add("/api/v1/game/state", {http::verb::get}, 2);
+    router.Add("/api/v1/game/player/action", {http::verb::post}, 3);
+    constexpr auto TARGET = "/api/v1/game/player/action"sv;
+
+    // В основном тела, которые отправляет клиент, и немного необычных
+    const std::vector<std::string> bodies = {
+        R"({"move":"L"})",  R"({"move":"R"})",  R"({"move":"U"})",        R"({"move":"D"})",
+        R"({"move":""})",   R"({"move": "L"})", R"({ "move" : "R" })",    R"({"move":"U"})",
+        R"({"move":"D"})",  R"({"move":"L"})",  R"({"move":"R"})",        R"({"move":"U"})",
+        R"({"move":"D"})",  R"({"move":""})",   R"({"move":"X"})",        R"({"move":"L"})",
+    };
+    const std::vector<std::string> edge_cases = {
+        R"({"move":"L","extra":1})", R"({"extra":[1,2],"move":"R"})", R"({"move":"X","move":"L"})",
+        R"({"move":"\u004c"})",      R"({"move":"\"L"})",              R"({"move":1})",
+        R"({"move":"LL"})",          R"({"move":"L"}{})",              R"({"move":)",
+        R"([])",                     R"()",
+    };
+    for (const auto* set : {&bodies, &edge_cases}) {
+        for (const auto& body : *set) {
+            const auto fast = http_handler::ParsePlayerAction(body);
+            const auto dom = ParseWithDom(body);
+            if (fast.has_value() != dom.has_value() || (fast && fast->move != dom->move)) {
+                std::cerr << "Parsers disagree on "sv << body << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+    }
+
+    std::size_t dom_checksum = 0;
+    const auto dom = Measure(requests, bodies, [&](std::string_view body) {
+        const auto match = router.Find(http::verb::post, TARGET);
+        if (match.route) {
+            if (auto action = ParseWithDom(body)) {
+                dom_checksum += static_cast<std::size_t>(action->move) + match.route->value;
+            }
+        }
+    });
+
+    std::size_t fast_checksum = 0;
+    const auto fast = Measure(requests, bodies, [&](std::string_view body) {
+        const auto match = router.Find(http::verb::post, TARGET);
+        if (match.route) {
+            if (auto action = http_handler::ParsePlayerAction(body)) {
+                fast_checksum += static_cast<std::size_t>(action->move) + match.route->value;
+            }
+        }
+    });
+
+    std::cout << "requests: " << requests << '\n';
+    Print("dom  (boost::json::parse): "sv, dom);
+    Print("fast (ParsePlayerAction):  "sv, fast);
+    // Контрольные суммы не дают компилятору выбросить разбор
+    return dom_checksum == fast_checksum ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,240 @@
+// bench/road_index_bench.cpp
+// Поиск дорог по точке на синтетическом городе (по умолчанию около 100 000 дорог): решётка кварталов,
+// каждая дорога — отрезок улицы между соседними перекрёстками, и сквозные проспекты поверх каждой
+// 16-й улицы, накладывающиеся на её отрезки. Запросы — точки на дорогах (со сдвигом в пределах
+// ширины дороги) и немного точек вне дорог. Сравнивает:
+//   scan  — прежний способ: перебор всех дорог карты на каждый запрос;
+//   index — model::RoadIndex.
+// Для каждого способа печатает время запроса "какие дороги покрывают точку" и "докуда можно дойти
+// в направлении", для индекса — ещё и время построения. Проверяет, что ответы совпадают.
+// Печатает также время построения графа дорог (model::RoadGraph) и его размер.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+#include "road_graph.h"
+#include "road_index.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr double HALF_WIDTH = model::RoadIndex::ROAD_HALF_WIDTH;
+constexpr model::Coord BLOCK = 10;
+constexpr std::size_t AVENUE_STEP = 16;
+
+std::vector<model::Road> MakeCity(std::size_t target_roads) {
+    // Решётка n x n перекрёстков даёт 2 * n * (n - 1) отрезков улиц
+    std::size_t n = 2;
+    while (2 * (n + 1) * n <= target_roads) {
+        ++n;
+    }
+    std::vector<model::Road> roads;
+    const auto size = static_cast<model::Coord>(n - 1) * BLOCK;
+    for (std::size_t i = 0; i < n; ++i) {
+        const auto line = static_cast<model::Coord>(i) * BLOCK;
+        for (std::size_t j = 0; j + 1 < n; ++j) {
+            const auto from = static_cast<model::Coord>(j) * BLOCK;
+            roads.emplace_back(model::Road::HORIZONTAL, model::Point{from, line}, from + BLOCK);
+            roads.emplace_back(model::Road::VERTICAL, model::Point{line, from + BLOCK}, from);
+        }
+        if (i % AVENUE_STEP == 0) {
+            roads.emplace_back(model::Road::HORIZONTAL, model::Point{size, line}, 0);
+            roads.emplace_back(model::Road::VERTICAL, model::Point{line, 0}, size);
+        }
+    }
+    return roads;
+}
+
+struct Query {
+    model::Position position;
+    model::Direction direction;
+};
+
+std::vector<Query> MakeQueries(const std::vector<model::Road>& roads, std::size_t count) {
+    std::mt19937_64 random{42};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::uniform_real_distribution<double> jitter{-HALF_WIDTH, HALF_WIDTH};
+    std::uniform_int_distribution<std::size_t> road_index{0, roads.size() - 1};
+    std::uniform_int_distribution<int> direction{0, 3};
+    double max_coord = 0;
+    for (const auto& road : roads) {
+        max_coord = std::max({max_coord, double(road.GetEnd().x), double(road.GetEnd().y)});
+    }
+    std::vector<Query> queries;
+    queries.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        model::Position position;
+        if (i % 10 == 9) {
+            // Произвольная точка города, чаще всего внутри квартала
+            position = {unit(random) * max_coord, unit(random) * max_coord};
+        } else {
+            const auto& road = roads[road_index(random)];
+            const auto start = road.GetStart();
+            const auto end = road.GetEnd();
+            const double t = unit(random);
+            position = {start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t};
+            (road.IsHorizontal() ? position.y : position.x) += jitter(random);
+        }
+        queries.push_back({position, static_cast<model::Direction>(direction(random))});
+    }
+    return queries;
+}
+
+// Перебор всех дорог: покрывает ли дорога точку
+bool Covers(const model::Road& road, model::Position position) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    return position.x >= std::min(start.x, end.x) - HALF_WIDTH && position.x <= std::max(start.x, end.x) + HALF_WIDTH
+        && position.y >= std::min(start.y, end.y) - HALF_WIDTH && position.y <= std::max(start.y, end.y) + HALF_WIDTH;
+}
+
+// Перебор всех дорог: участки линии движения, покрытые дорогами, и продвижение по ним, пока
+// текущая граница лежит внутри какого-нибудь участка
+model::Position ScanFarthestPoint(const std::vector<model::Road>& roads, model::Position from,
+                                  model::Direction direction, std::vector<std::pair<double, double>>& intervals) {
+    const bool horizontal = direction == model::Direction::WEST || direction == model::Direction::EAST;
+    const bool forward = direction == model::Direction::EAST || direction == model::Direction::SOUTH;
+    const double along = horizontal ? from.x : from.y;
+    const double across = horizontal ? from.y : from.x;
+    intervals.clear();
+    for (const auto& road : roads) {
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        const double along_min = horizontal ? std::min(start.x, end.x) : std::min(start.y, end.y);
+        const double along_max = horizontal ? std::max(start.x, end.x) : std::max(start.y, end.y);
+        const double across_min = horizontal ? std::min(start.y, end.y) : std::min(start.x, end.x);
+        const double across_max = horizontal ? std::max(start.y, end.y) : std::max(start.x, end.x);
+        if (across >= across_min - HALF_WIDTH && across <= across_max + HALF_WIDTH) {
+            intervals.emplace_back(along_min - HALF_WIDTH, along_max + HALF_WIDTH);
+        }
+    }
+    double reach = along;
+    bool on_road = false;
+    for (bool moved = true; moved;) {
+        moved = false;
+        for (const auto& [low, high] : intervals) {
+            if (low <= reach && reach <= high) {
+                on_road = true;
+                const double edge = forward ? high : low;
+                if (forward ? edge > reach : edge < reach) {
+                    reach = edge;
+                    moved = true;
+                }
+            }
+        }
+    }
+    if (!on_road) {
+        return from;
+    }
+    return horizontal ? model::Position{reach, from.y} : model::Position{from.x, reach};
+}
+
+double NsPerQuery(Clock::duration elapsed, std::size_t queries) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(queries);
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t target_roads = 100'000;
+    std::size_t queries_count = 1'000'000;
+    std::size_t scan_queries_count = 2'000;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--roads="sv)) {
+            target_roads = std::max(4, std::atoi(argv[i] + "--roads="sv.size()));
+        } else if (arg.starts_with("--queries="sv)) {
+            queries_count = std::max(1, std::atoi(argv[i] + "--queries="sv.size()));
+        } else if (arg.starts_with("--scan-queries="sv)) {
+            scan_queries_count = std::max(1, std::atoi(argv[i] + "--scan-queries="sv.size()));
+        } else {
+            std::cerr << "Usage: road_index_bench [--roads=N] [--queries=N] [--scan-queries=N]"sv << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    const auto roads = MakeCity(target_roads);
+    const auto queries = MakeQueries(roads, queries_count);
+    scan_queries_count = std::min(scan_queries_count, queries.size());
+
+    const auto build_start = Clock::now();
+    const model::RoadIndex index{roads};
+    const auto build_time = Clock::now() - build_start;
+    const auto graph_start = Clock::now();
+    const model::RoadGraph graph{roads};
+    const auto graph_time = Clock::now() - graph_start;
+
+    // Ответы индекса и перебора сверяются на запросах, которые выполняет перебор
+    std::vector<std::size_t> found;
+    std::vector<std::size_t> expected;
+    std::vector<std::pair<double, double>> intervals;
+    std::size_t scan_checksum = 0;
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < scan_queries_count; ++i) {
+        for (const auto& road : roads) {
+            scan_checksum += Covers(road, queries[i].position) ? 1 : 0;
+        }
+    }
+    const auto scan_lookup = Clock::now() - start;
+    start = Clock::now();
+    for (std::size_t i = 0; i < scan_queries_count; ++i) {
+        const auto reach = ScanFarthestPoint(roads, queries[i].position, queries[i].direction, intervals);
+        scan_checksum += static_cast<std::size_t>(reach.x + reach.y);
+    }
+    const auto scan_reach = Clock::now() - start;
+
+    for (std::size_t i = 0; i < scan_queries_count; ++i) {
+        const auto& query = queries[i];
+        found.clear();
+        expected.clear();
+        index.ForEachRoadAt(query.position, [&found](std::size_t road) {
+            found.push_back(road);
+        });
+        for (std::size_t road = 0; road < roads.size(); ++road) {
+            if (Covers(roads[road], query.position)) {
+                expected.push_back(road);
+            }
+        }
+        std::sort(found.begin(), found.end());
+        const auto reach = index.GetFarthestPoint(query.position, query.direction);
+        const auto expected_reach = ScanFarthestPoint(roads, query.position, query.direction, intervals);
+        if (found != expected || reach.x != expected_reach.x || reach.y != expected_reach.y) {
+            std::cerr << "Index and scan disagree at ("sv << query.position.x << ", "sv << query.position.y << ')'
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::size_t index_checksum = 0;
+    start = Clock::now();
+    for (const auto& query : queries) {
+        index.ForEachRoadAt(query.position, [&index_checksum](std::size_t road) {
+            index_checksum += road;
+        });
+    }
+    const auto index_lookup = Clock::now() - start;
+    start = Clock::now();
+    for (const auto& query : queries) {
+        const auto reach = index.GetFarthestPoint(query.position, query.direction);
+        index_checksum += static_cast<std::size_t>(reach.x + reach.y);
+    }
+    const auto index_reach = Clock::now() - start;
+
+    std::cout << "roads: " << roads.size() << ", queries: " << queries.size() << " (scan: " << scan_queries_count
+              << ")\n";
+    std::cout << "index build: " << std::chrono::duration<double, std::milli>(build_time).count() << " ms\n";
+    std::cout << "graph build: " << std::chrono::duration<double, std::milli>(graph_time).count() << " ms, "
+              << graph.GetNodeCount() << " nodes, " << graph.GetEdgeCount() << " edges\n";
+    std::cout << "roads at point:  scan " << NsPerQuery(scan_lookup, scan_queries_count) << " ns/query, index "
+              << NsPerQuery(index_lookup, queries.size()) << " ns/query\n";
+    std::cout << "farthest point:  scan " << NsPerQuery(scan_reach, scan_queries_count) << " ns/query, index "
+              << NsPerQuery(index_reach, queries.size()) << " ns/query\n";
+    // Контрольные суммы не дают компилятору выбросить запросы
+    return scan_checksum != 0 && index_checksum != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
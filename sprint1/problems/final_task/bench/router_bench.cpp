@@ -0,0 +1,116 @@
+// bench/router_bench.cpp
+// Микробенчмарк маршрутизации по большой таблице маршрутов, без сети и обработчиков.
+// Таблица из N ресурсов, у каждого три маршрута: /api/v1/res<i>, /api/v1/res<i>/:id
+// и /api/v1/res<i>/:id/items/:item. Сравнивает:
+//   chain  — прежнюю схему: копия target для нормализации и цепочка проверок
+//            == / starts_with по маршрутам в порядке их добавления;
+//   router — http_server::Router: префиксное дерево по сегментам.
+// Для каждой схемы печатает число выделений памяти и время в расчёте на один запрос.
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "alloc_counter.h"
+#include "router.h"
+
+using namespace std::literals;
+namespace http = boost::beast::http;
+
+namespace {
+
+struct Result {
+    double allocations_per_request;
+    double ns_per_request;
+};
+
+template <typename Route>
+Result Measure(std::size_t requests, const std::vector<std::string>& targets, Route&& route) {
+    const auto allocations_before = alloc_counter::GetThreadAllocations();
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < requests; ++i) {
+        route(targets[i % targets.size()]);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto allocations = alloc_counter::GetThreadAllocations() - allocations_before;
+    return {
+        static_cast<double>(allocations) / static_cast<double>(requests),
+        static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())
+            / static_cast<double>(requests),
+    };
+}
+
+void Print(std::string_view name, const Result& result) {
+    std::cout << name << "allocations/request: " << result.allocations_per_request
+              << ", ns/request: " << result.ns_per_request << '\n';
+}
+
+// Маршрут прежней схемы: точное совпадение или префикс, за которым идёт параметр
+struct ChainRoute {
+    std::string path;
+    bool prefix;
+    std::size_t id;
+};
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t resources = 1000;
+    std::size_t requests = 1'000'000;
+    if (argc > 3) {
+        std::cerr << "Usage: router_bench [resources] [requests]"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (argc >= 2) {
+        resources = std::max(1, std::atoi(argv[1]));
+    }
+    if (argc == 3) {
+        requests = std::max(1, std::atoi(argv[2]));
+    }
+
+    http_server::Router<std::size_t> router;
+    std::vector<ChainRoute> chain;
+    std::vector<std::string> targets;
+    for (std::size_t i = 0; i < resources; ++i) {
+        const auto base = "/api/v1/res" + std::to_string(i);
+        router.Add(base, {http::verb::get}, chain.size());
+        chain.push_back({base, false, chain.size()});
+        router.Add(base + "/:id", {http::verb::get, http::verb::delete_}, chain.size());
+        chain.push_back({base + "/", true, chain.size()});
+        // В цепочке вложенный маршрут распознавал бы обработчик префикса
+        router.Add(base + "/:id/items/:item", {http::verb::get}, chain.size());
+        targets.push_back(base);
+        targets.push_back(base + "/object" + std::to_string(i));
+        targets.push_back(base + "/object" + std::to_string(i) + "/items/7");
+    }
+    targets.push_back("/api/v1/unknown");
+
+    // Прежняя схема
+    std::size_t chain_checksum = 0;
+    const auto before = Measure(requests, targets, [&](std::string_view target) {
+        std::string normalized_target{target};
+        for (const auto& route : chain) {
+            if (route.prefix ? normalized_target.starts_with(route.path) : normalized_target == route.path) {
+                chain_checksum += route.id + normalized_target.size() - route.path.size();
+                return;
+            }
+        }
+    });
+
+    // Префиксное дерево
+    std::size_t router_checksum = 0;
+    const auto after = Measure(requests, targets, [&](std::string_view target) {
+        const auto match = router.Find(http::verb::get, target);
+        if (match.route) {
+            router_checksum += match.route->value + match.params[0].size();
+        }
+    });
+
+    std::cout << "routes: " << router.GetRoutes().size() << ", requests: " << requests << '\n';
+    Print("chain  (starts_with): "sv, before);
+    Print("router (trie):        "sv, after);
+    // Контрольные суммы не дают компилятору выбросить поиск
+    return chain_checksum != 0 && router_checksum != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
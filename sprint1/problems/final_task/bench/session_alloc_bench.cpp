@@ -0,0 +1,190 @@
+// bench/session_alloc_bench.cpp
+// Считает выделения динамической памяти и процессорное время сервера в расчёте на один запрос.
+// Сервер с настоящим RequestHandler работает в отдельном потоке на однопоточном io_context,
+// клиент в основном потоке последовательно шлёт keep-alive запросы. Учитываются только
+// выделения и время потока сервера, так что работа клиента на результат не влияет.
+// --session=callbacks|coroutines выбирает реализацию сессии: так их можно сравнить
+// на одном и том же обработчике.
+// С --requests-per-connection=N клиент переподключается каждые N запросов: так видна цена
+// установки соединения и эффект пула сессий (--session-pool=N, 0 — без пула).
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <future>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "alloc_counter.h"
+#include "json_loader.h"
+#include "request_handler.h"
+
+using namespace std::literals;
+namespace net = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = net::ip::tcp;
+
+namespace {
+
+struct Params {
+    std::string config_file;
+    std::string target = "/api/v1/maps";
+    net::ip::port_type port = 18080;
+    std::size_t warmup = 1000;
+    std::size_t requests = 10000;
+    // 0 — все запросы в одном соединении
+    std::size_t requests_per_connection = 0;
+    std::size_t session_pool_size = http_server::ListenerOptions{}.session_pool_size;
+    http_server::SessionStyle session_style = http_server::SessionStyle::CALLBACKS;
+};
+
+std::optional<Params> ParseCommandLine(int argc, const char* const argv[]) {
+    if (argc < 2) {
+        return std::nullopt;
+    }
+    Params params;
+    params.config_file = argv[1];
+    for (int i = 2; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--target="sv)) {
+            params.target = arg.substr("--target="sv.size());
+        } else if (arg.starts_with("--port="sv)) {
+            params.port = static_cast<net::ip::port_type>(std::atoi(argv[i] + "--port="sv.size()));
+        } else if (arg.starts_with("--requests="sv)) {
+            params.requests = std::max(1, std::atoi(argv[i] + "--requests="sv.size()));
+        } else if (arg.starts_with("--requests-per-connection="sv)) {
+            params.requests_per_connection = std::max(0, std::atoi(argv[i] + "--requests-per-connection="sv.size()));
+        } else if (arg.starts_with("--session-pool="sv)) {
+            params.session_pool_size = std::max(0, std::atoi(argv[i] + "--session-pool="sv.size()));
+        } else if (arg == "--session=callbacks"sv) {
+            params.session_style = http_server::SessionStyle::CALLBACKS;
+        } else if (arg == "--session=coroutines"sv) {
+            params.session_style = http_server::SessionStyle::COROUTINES;
+        } else {
+            return std::nullopt;
+        }
+    }
+    return params;
+}
+
+// Процессорное время, затраченное текущим потоком
+std::chrono::nanoseconds GetThreadCpuTime() {
+    timespec ts{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec};
+}
+
+// Выполняет fn в потоке сервера и возвращает результат
+template <typename Fn>
+auto RunOnServer(net::io_context& ioc, Fn&& fn) {
+    std::packaged_task<decltype(fn())()> task(std::forward<Fn>(fn));
+    auto result = task.get_future();
+    net::post(ioc, [&task] {
+        task();
+    });
+    return result.get();
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    auto params = ParseCommandLine(argc, argv);
+    if (!params) {
+        std::cerr << "Usage: session_alloc_bench <game-config-json> [--target=T] [--port=P] [--requests=N]"
+                     " [--requests-per-connection=N] [--session-pool=N] [--session=callbacks|coroutines]"sv
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    model::Game game = json_loader::LoadGame(params->config_file);
+    http_handler::RequestHandler handler{game};
+
+    net::io_context server_ioc(1);
+    const tcp::endpoint endpoint{net::ip::make_address("127.0.0.1"), params->port};
+    http_server::ListenerOptions options;
+    options.session_pool_size = params->session_pool_size;
+    options.session_pool_stats = std::make_shared<http_server::SessionPoolStats>();
+    options.session_style = params->session_style;
+    http_server::ServeHttp(
+        server_ioc, endpoint,
+        [&handler](auto&& req, auto&& send, auto&& hold) {
+            handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send),
+                    std::forward<decltype(hold)>(hold));
+        },
+        options);
+    auto work = net::make_work_guard(server_ioc);
+    std::jthread server_thread([&server_ioc] {
+        server_ioc.run();
+    });
+
+    net::io_context client_ioc;
+    tcp::socket socket(client_ioc);
+    socket.connect(endpoint);
+    beast::flat_buffer buffer;
+
+    http::request<http::empty_body> req{http::verb::get, params->target, 11};
+    req.set(http::field::host, "127.0.0.1");
+    req.keep_alive(true);
+
+    std::size_t connections = 1;
+    auto do_requests = [&](std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (params->requests_per_connection != 0 && i != 0 && i % params->requests_per_connection == 0) {
+                // Закрываем соединение и дожидаемся, пока сервер его закроет: сессия к этому
+                // моменту завершится, и следующее соединение сможет взять её из пула
+                socket.shutdown(tcp::socket::shutdown_send);
+                beast::error_code ec;
+                http::response<http::string_body> eof;
+                http::read(socket, buffer, eof, ec);
+                socket.close();
+                buffer.clear();
+                socket.connect(endpoint);
+                ++connections;
+            }
+            http::write(socket, req);
+            http::response<http::string_body> res;
+            http::read(socket, buffer, res);
+        }
+    };
+
+    // Прогрев: арена сессии, буферы и пулы Asio достигают установившегося размера
+    do_requests(params->warmup);
+    connections = 1;
+
+    const auto [before, cpu_before] = RunOnServer(server_ioc, [] {
+        return std::pair{alloc_counter::GetThreadAllocations(), GetThreadCpuTime()};
+    });
+    do_requests(params->requests);
+    const auto [after, cpu_after] = RunOnServer(server_ioc, [] {
+        return std::pair{alloc_counter::GetThreadAllocations(), GetThreadCpuTime()};
+    });
+
+    std::cout << "session:                 "
+              << (params->session_style == http_server::SessionStyle::COROUTINES ? "coroutines" : "callbacks") << '\n'
+              << "target:                  " << params->target << '\n'
+              << "requests:                " << params->requests << '\n'
+              << "server heap allocations: " << after - before << '\n'
+              << "allocations per request: "
+              << static_cast<double>(after - before) / static_cast<double>(params->requests) << '\n'
+              << "server CPU per request:  "
+              << std::chrono::duration<double, std::nano>(cpu_after - cpu_before).count()
+                     / static_cast<double>(params->requests)
+              << " ns\n"
+              << "connections:             " << connections << '\n'
+              << "allocations per conn:    "
+              << static_cast<double>(after - before) / static_cast<double>(connections) << '\n'
+              << "session pool hit rate:   " << options.session_pool_stats->GetHitRate() * 100 << "%" << std::endl;
+
+    beast::error_code ec;
+    socket.shutdown(tcp::socket::shutdown_both, ec);
+    work.reset();
+    server_ioc.stop();
+}
@@ -0,0 +1,201 @@
+// bench/state_snapshot_bench.cpp
+// Публикация состояния игры при частом опросе: писатель раз в период тика заполняет состояние
+// из N собак и публикует его, а R потоков-читателей без перерыва читают опубликованное состояние
+// и обходят всех собак (как при сериализации ответа). Сравнивает:
+//   mutex    — прежний способ: состояние под мьютексом, читатель копирует его под блокировкой,
+//              писатель меняет буферы местами под той же блокировкой;
+//   snapshot — util::SnapshotChannel: читатели берут текущий снимок без блокировок.
+// Печатает, сколько писатель ждал при публикации и читатели — перед чтением, и сколько чтений
+// успели сделать. Проверяет, что читатели не видят тик наполовину записанным: у всех собак
+// прочитанного состояния координата x равна номеру тика.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "game_session.h"
+#include "snapshot.h"
+
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+void Fill(model::GameState& state, std::uint64_t tick, std::size_t dogs) {
+    state.tick = tick;
+    state.sessions.resize(1);
+    auto& states = state.sessions.front().dogs;
+    states.resize(dogs);
+    for (auto& dog : states) {
+        dog = {{static_cast<double>(tick), 1.0}, {1.0, 0.0}, model::Direction::EAST};
+    }
+}
+
+// Обходит собак состояния. false, если состояние записано не одним тиком
+bool Check(const model::GameState& state, double& checksum) {
+    bool consistent = true;
+    for (const auto& dog : state.sessions.front().dogs) {
+        checksum += dog.position.y;
+        consistent &= dog.position.x == static_cast<double>(state.tick);
+    }
+    return consistent;
+}
+
+class MutexState {
+public:
+    model::GameState& GetNextBuffer() {
+        return pending_;
+    }
+
+    void Publish() {
+        std::lock_guard lock{mutex_};
+        std::swap(published_, pending_);
+    }
+
+    template <typename Fn>
+    void Read(Fn&& fn) const {
+        model::GameState copy;
+        {
+            std::lock_guard lock{mutex_};
+            copy = published_;
+        }
+        fn(copy);
+    }
+
+private:
+    mutable std::mutex mutex_;
+    model::GameState pending_;
+    model::GameState published_;
+};
+
+class SnapshotState {
+public:
+    model::GameState& GetNextBuffer() {
+        return channel_.GetNextBuffer();
+    }
+
+    void Publish() {
+        channel_.Publish();
+    }
+
+    template <typename Fn>
+    void Read(Fn&& fn) const {
+        const auto snapshot = channel_.Read();
+        fn(*snapshot);
+    }
+
+private:
+    util::SnapshotChannel<model::GameState> channel_;
+};
+
+struct WaitStats {
+    std::uint64_t count = 0;
+    Clock::duration total{};
+    Clock::duration max{};
+
+    void Record(Clock::duration wait) {
+        ++count;
+        total += wait;
+        max = std::max(max, wait);
+    }
+
+    double GetAverageUs() const {
+        return count != 0 ? std::chrono::duration<double, std::micro>(total).count() / count : 0.0;
+    }
+
+    double GetMaxUs() const {
+        return std::chrono::duration<double, std::micro>(max).count();
+    }
+};
+
+template <typename State>
+bool Run(std::string_view name, std::size_t dogs, unsigned readers, Clock::duration period, Clock::duration duration) {
+    State state;
+    Fill(state.GetNextBuffer(), 0, dogs);
+    state.Publish();
+
+    std::atomic<bool> stop{false};
+    std::atomic<bool> torn{false};
+    std::vector<WaitStats> reader_stats(readers);
+    std::vector<std::jthread> reader_threads;
+    for (unsigned i = 0; i < readers; ++i) {
+        reader_threads.emplace_back([&, i] {
+            double checksum = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const auto start = Clock::now();
+                state.Read([&](const model::GameState& snapshot) {
+                    reader_stats[i].Record(Clock::now() - start);
+                    if (!Check(snapshot, checksum)) {
+                        torn = true;
+                    }
+                });
+            }
+        });
+    }
+
+    WaitStats publish_stats;
+    const auto end = Clock::now() + duration;
+    auto deadline = Clock::now();
+    for (std::uint64_t tick = 1; Clock::now() < end; ++tick) {
+        Fill(state.GetNextBuffer(), tick, dogs);
+        const auto start = Clock::now();
+        state.Publish();
+        publish_stats.Record(Clock::now() - start);
+        deadline += period;
+        std::this_thread::sleep_until(deadline);
+    }
+    stop = true;
+    reader_threads.clear();
+
+    WaitStats reads;
+    for (const auto& stats : reader_stats) {
+        reads.count += stats.count;
+        reads.total += stats.total;
+        reads.max = std::max(reads.max, stats.max);
+    }
+    std::cout << name << ": ticks " << publish_stats.count << ", publish wait average " << publish_stats.GetAverageUs()
+              << " us, max " << publish_stats.GetMaxUs() << " us; reads " << reads.count << ", read wait average "
+              << reads.GetAverageUs() << " us, max " << reads.GetMaxUs() << " us\n";
+    return !torn;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t dogs = 100'000;
+    unsigned readers = 4;
+    int period_ms = 20;
+    int seconds = 3;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--dogs="sv)) {
+            dogs = std::max(1, std::atoi(argv[i] + "--dogs="sv.size()));
+        } else if (arg.starts_with("--readers="sv)) {
+            readers = std::max(1, std::atoi(argv[i] + "--readers="sv.size()));
+        } else if (arg.starts_with("--period-ms="sv)) {
+            period_ms = std::max(1, std::atoi(argv[i] + "--period-ms="sv.size()));
+        } else if (arg.starts_with("--seconds="sv)) {
+            seconds = std::max(1, std::atoi(argv[i] + "--seconds="sv.size()));
+        } else {
+            std::cerr << "Usage: state_snapshot_bench [--dogs=N] [--readers=N] [--period-ms=N] [--seconds=N]"sv
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "dogs: " << dogs << ", readers: " << readers << ", period: " << period_ms << " ms\n";
+    const auto period = std::chrono::milliseconds{period_ms};
+    const auto duration = std::chrono::seconds{seconds};
+    const bool consistent = Run<MutexState>("mutex", dogs, readers, period, duration)
+                         && Run<SnapshotState>("snapshot", dogs, readers, period, duration);
+    if (!consistent) {
+        std::cerr << "A reader saw a partially written state"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+}
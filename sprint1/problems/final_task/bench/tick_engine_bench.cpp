@@ -0,0 +1,109 @@
+// bench/tick_engine_bench.cpp
+// Тики model::TickEngine на нескольких картах: у каждой карты свой сеанс с собаками, которые
+// ходят по синтетическому городу. Размеры сеансов разные (от dogs/2 до dogs собак), как у карт
+// с разной популярностью. Для каждого числа потоков от 1 до --threads движок работает заданное
+// время с периодом --period-ms и печатает среднее и наибольшее время тика, число тиков,
+// не уложившихся в период, и ускорение относительно одного потока.
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "game_session.h"
+#include "tick_engine.h"
+
+using namespace std::literals;
+
+namespace {
+
+constexpr model::Coord BLOCK = 10;
+constexpr std::size_t CITY_SIZE = 40;
+
+model::Map MakeCityMap(std::size_t number) {
+    model::Map map{model::Map::Id{"city" + std::to_string(number)}, "City " + std::to_string(number)};
+    for (std::size_t i = 0; i < CITY_SIZE; ++i) {
+        const auto line = static_cast<model::Coord>(i) * BLOCK;
+        for (std::size_t j = 0; j + 1 < CITY_SIZE; ++j) {
+            const auto from = static_cast<model::Coord>(j) * BLOCK;
+            map.AddRoad({model::Road::HORIZONTAL, model::Point{from, line}, from + BLOCK});
+            map.AddRoad({model::Road::VERTICAL, model::Point{line, from + BLOCK}, from});
+        }
+    }
+    map.Compile();
+    return map;
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    std::size_t maps_count = 48;
+    std::size_t dogs = 20'000;
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    int period_ms = 50;
+    int seconds = 3;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with("--maps="sv)) {
+            maps_count = std::max(1, std::atoi(argv[i] + "--maps="sv.size()));
+        } else if (arg.starts_with("--dogs="sv)) {
+            dogs = std::max(2, std::atoi(argv[i] + "--dogs="sv.size()));
+        } else if (arg.starts_with("--threads="sv)) {
+            max_threads = std::max(1, std::atoi(argv[i] + "--threads="sv.size()));
+        } else if (arg.starts_with("--period-ms="sv)) {
+            period_ms = std::max(1, std::atoi(argv[i] + "--period-ms="sv.size()));
+        } else if (arg.starts_with("--seconds="sv)) {
+            seconds = std::max(1, std::atoi(argv[i] + "--seconds="sv.size()));
+        } else {
+            std::cerr << "Usage: tick_engine_bench [--maps=N] [--dogs=N] [--threads=N] [--period-ms=N] [--seconds=N]"sv
+                      << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<model::Map> maps;
+    maps.reserve(maps_count);
+    for (std::size_t i = 0; i < maps_count; ++i) {
+        maps.push_back(MakeCityMap(i));
+    }
+
+    std::cout << "maps: " << maps_count << ", dogs per map: " << dogs / 2 << ".." << dogs << ", period: " << period_ms
+              << " ms, hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    double single_thread_ms = 0;
+    for (unsigned threads = 1; threads <= max_threads; ++threads) {
+        std::mt19937_64 random{42};
+        std::vector<std::unique_ptr<model::GameSession>> sessions;
+        std::vector<model::GameSession*> session_ptrs;
+        for (std::size_t i = 0; i < maps_count; ++i) {
+            auto& session = *sessions.emplace_back(std::make_unique<model::GameSession>(maps[i]));
+            session.SpawnDogs(dogs / 2 + dogs / 2 * i / std::max<std::size_t>(1, maps_count - 1), random);
+            session_ptrs.push_back(&session);
+        }
+
+        model::TickEngineOptions options;
+        options.period = std::chrono::milliseconds{period_ms};
+        options.threads = threads;
+        model::TickEngine engine{std::move(session_ptrs), std::move(options)};
+        engine.Start();
+        std::this_thread::sleep_for(std::chrono::seconds{seconds});
+        engine.Stop();
+
+        const auto& stats = engine.GetStats();
+        const double average_ms = stats.duration.GetAverageMs();
+        if (threads == 1) {
+            single_thread_ms = average_ms;
+        }
+        std::cout << "threads " << threads << ": ticks " << stats.duration.ticks << ", average " << average_ms
+                  << " ms, max " << stats.duration.GetMaxMs() << " ms, overruns " << stats.overruns << ", skipped "
+                  << stats.skipped << ", speedup " << (average_ms != 0 ? single_thread_ms / average_ms : 0) << "x\n";
+        if (engine.GetStates().Read()->tick == 0) {
+            std::cerr << "No tick was published"sv << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+}
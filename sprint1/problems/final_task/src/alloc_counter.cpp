@@ -0,0 +1,114 @@
+// src/alloc_counter.cpp
+#include "alloc_counter.h"
+
+#ifdef GAME_SERVER_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local std::size_t thread_allocations = 0;
+std::atomic<std::size_t> total_allocations{0};
+
+void* CountedAlloc(std::size_t size, std::size_t alignment) {
+    ++thread_allocations;
+    total_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = alignment > alignof(std::max_align_t)
+                  ? std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment)
+                  : std::malloc(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    return CountedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new[](std::size_t size) {
+    return CountedAlloc(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return CountedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return CountedAlloc(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+namespace alloc_counter {
+
+bool IsEnabled() noexcept {
+    return true;
+}
+
+std::size_t GetThreadAllocations() noexcept {
+    return thread_allocations;
+}
+
+std::size_t GetTotalAllocations() noexcept {
+    return total_allocations.load(std::memory_order_relaxed);
+}
+
+}  // namespace alloc_counter
+
+#else
+
+namespace alloc_counter {
+
+bool IsEnabled() noexcept {
+    return false;
+}
+
+std::size_t GetThreadAllocations() noexcept {
+    return 0;
+}
+
+std::size_t GetTotalAllocations() noexcept {
+    return 0;
+}
+
+}  // namespace alloc_counter
+
+#endif
@@ -0,0 +1,20 @@
+// src/alloc_counter.h
+#pragma once
+#include <cstddef>
+
+// Счётчик выделений динамической памяти.
+// Глобальные operator new/delete подменяются, только если alloc_counter.cpp собран
+// с определённым GAME_SERVER_COUNT_ALLOCATIONS (опция CMake GAME_SERVER_COUNT_ALLOCATIONS
+// или бенчмарки). Иначе счётчики всегда равны нулю.
+namespace alloc_counter {
+
+// Включён ли подсчёт выделений в этой сборке
+bool IsEnabled() noexcept;
+
+// Число вызовов operator new в текущем потоке с момента его запуска
+std::size_t GetThreadAllocations() noexcept;
+
+// Число вызовов operator new во всех потоках с момента запуска программы
+std::size_t GetTotalAllocations() noexcept;
+
+}  // namespace alloc_counter
@@ -0,0 +1,162 @@
+// src/arena.h
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace http_server {
+
+// Монотонный распределитель памяти ("арена").
+// Память выделяется последовательно из заранее полученных блоков, освобождение отдельных
+// объектов ничего не делает. Rewind() разом возвращает всю память арене, сохраняя блоки,
+// поэтому в установившемся режиме арена не обращается к куче.
+// Арена не потокобезопасна: ею пользуется одна сессия в своём strand.
+class Arena {
+public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 8 * 1024;
+    static constexpr std::size_t DEFAULT_MAX_BLOCKS = 8;
+
+    // max_blocks ограничивает рост арены. Когда блоки исчерпаны, память берётся из кучи,
+    // пока арену не перемотают
+    explicit Arena(std::size_t block_size = DEFAULT_BLOCK_SIZE, std::size_t max_blocks = DEFAULT_MAX_BLOCKS)
+        : block_size_(block_size)
+        , max_blocks_(std::max<std::size_t>(1, max_blocks)) {
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* Allocate(std::size_t size, std::size_t alignment) {
+        while (current_ < blocks_.size() || AddBlock(size + alignment)) {
+            Block& block = blocks_[current_];
+            const auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            const auto aligned = (base + offset_ + alignment - 1) & ~(std::uintptr_t{alignment} - 1);
+            if (aligned + size <= base + block.size) {
+                offset_ = aligned + size - base;
+                return reinterpret_cast<void*>(aligned);
+            }
+            // Блок исчерпан, переходим к следующему
+            ++current_;
+            offset_ = 0;
+        }
+        ++heap_allocations_;
+        return ::operator new(size, std::align_val_t{alignment});
+    }
+
+    void Deallocate(void* p, std::size_t alignment) noexcept {
+        // Память арены освобождается только целиком в Rewind
+        if (!Owns(p)) {
+            ::operator delete(p, std::align_val_t{alignment});
+        }
+    }
+
+    // Делает всю выделенную память снова доступной. Вызывать, только когда
+    // ни один объект, размещённый в арене, больше не используется
+    void Rewind() noexcept {
+        current_ = 0;
+        offset_ = 0;
+    }
+
+    // Перематывает арену и освобождает блоки сверх первых keep_blocks.
+    // Вызывать при тех же условиях, что и Rewind
+    void Trim(std::size_t keep_blocks) noexcept {
+        Rewind();
+        if (blocks_.size() > keep_blocks) {
+            blocks_.erase(blocks_.begin() + static_cast<std::ptrdiff_t>(keep_blocks), blocks_.end());
+        }
+    }
+
+    // Сколько раз арене не хватило собственных блоков и пришлось обратиться к куче
+    std::size_t GetHeapAllocations() const noexcept {
+        return heap_allocations_;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    bool AddBlock(std::size_t min_size) {
+        if (blocks_.size() >= max_blocks_) {
+            return false;
+        }
+        const std::size_t size = std::max(block_size_, min_size);
+        blocks_.push_back(Block{std::make_unique<std::byte[]>(size), size});
+        current_ = blocks_.size() - 1;
+        offset_ = 0;
+        return true;
+    }
+
+    bool Owns(const void* p) const noexcept {
+        const auto addr = reinterpret_cast<std::uintptr_t>(p);
+        return std::any_of(blocks_.begin(), blocks_.end(), [addr](const Block& block) {
+            const auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+            return addr >= base && addr < base + block.size;
+        });
+    }
+
+    std::size_t block_size_;
+    std::size_t max_blocks_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t heap_allocations_ = 0;
+};
+
+// Аллокатор в стиле STL поверх Arena. Аллокатор без арены (созданный по умолчанию)
+// работает с кучей, так что сообщения с такими полями можно создавать и вне сессии
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    // Присваивание контейнера переносит и арену, иначе контейнер, созданный вне сессии,
+    // продолжил бы работать с кучей после присваивания ему сообщения из арены
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() noexcept = default;
+
+    explicit ArenaAllocator(Arena& arena) noexcept
+        : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+        : arena_(other.GetArena()) {
+    }
+
+    T* allocate(std::size_t n) {
+        if (arena_) {
+            return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (arena_) {
+            arena_->Deallocate(p, alignof(T));
+        } else {
+            std::allocator<T>{}.deallocate(p, n);
+        }
+    }
+
+    Arena* GetArena() const noexcept {
+        return arena_;
+    }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept {
+        return arena_ == other.GetArena();
+    }
+
+private:
+    Arena* arena_ = nullptr;
+};
+
+}  // namespace http_server
@@ -0,0 +1,38 @@
+// src/broadcast_channel.cpp
+#include "broadcast_channel.h"
+
+#include <algorithm>
+
+namespace http_server {
+
+void BroadcastChannel::Subscribe(std::weak_ptr<BroadcastSubscriber> subscriber) {
+    std::lock_guard lock{mutex_};
+    subscribers_.push_back(std::move(subscriber));
+}
+
+void BroadcastChannel::Publish(SharedBuffer frame) {
+    std::vector<std::shared_ptr<BroadcastSubscriber>> receivers;
+    {
+        std::lock_guard lock{mutex_};
+        receivers.reserve(subscribers_.size());
+        std::erase_if(subscribers_, [&receivers](const std::weak_ptr<BroadcastSubscriber>& weak) {
+            auto subscriber = weak.lock();
+            if (!subscriber) {
+                return true;
+            }
+            receivers.push_back(std::move(subscriber));
+            return false;
+        });
+    }
+    // Подписчики вызываются вне блокировки, чтобы они могли подписывать других
+    for (const auto& receiver : receivers) {
+        receiver->OnFrame(frame);
+    }
+}
+
+std::size_t BroadcastChannel::GetSubscriberCount() const {
+    std::lock_guard lock{mutex_};
+    return subscribers_.size();
+}
+
+}  // namespace http_server
@@ -0,0 +1,43 @@
+// src/broadcast_channel.h
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "shared_body.h"
+
+namespace http_server {
+
+// Получатель кадров BroadcastChannel
+class BroadcastSubscriber {
+public:
+    // Вызывается для каждого опубликованного кадра из потока, публикующего кадр
+    virtual void OnFrame(const SharedBuffer& frame) = 0;
+
+protected:
+    ~BroadcastSubscriber() = default;
+};
+
+// Канал рассылки: каждый опубликованный кадр доставляется всем подписчикам.
+// Кадр сериализуется один раз, подписчики получают один и тот же разделяемый буфер.
+// Канал хранит слабые ссылки на подписчиков, завершившиеся подписчики удаляются при публикации
+class BroadcastChannel {
+public:
+    BroadcastChannel() = default;
+    BroadcastChannel(const BroadcastChannel&) = delete;
+    BroadcastChannel& operator=(const BroadcastChannel&) = delete;
+
+    void Subscribe(std::weak_ptr<BroadcastSubscriber> subscriber);
+
+    // Рассылает кадр всем подписчикам. Можно вызывать из любого потока
+    void Publish(SharedBuffer frame);
+
+    std::size_t GetSubscriberCount() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::weak_ptr<BroadcastSubscriber>> subscribers_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,79 @@
+// src/content_coding.h
+#pragma once
+#include <cctype>
+#include <string_view>
+
+namespace http_server {
+
+// Принимает ли клиент кодирование coding (например, "gzip") по заголовку Accept-Encoding
+// (RFC 9110, 12.5.3). Кодирование подходит, если оно или "*" перечислено с ненулевым q;
+// явно указанное кодирование важнее "*". Без заголовка сжатые ответы не отправляются
+inline bool AcceptsEncoding(std::string_view header, std::string_view coding) noexcept {
+    auto is_space = [](char c) {
+        return c == ' ' || c == '\t';
+    };
+    auto trim = [&](std::string_view text) {
+        while (!text.empty() && is_space(text.front())) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && is_space(text.back())) {
+            text.remove_suffix(1);
+        }
+        return text;
+    };
+    auto equals_ignore_case = [](std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+        return true;
+    };
+    // q=0, q=0.0, q=0.00 и q=0.000 запрещают кодирование, любое другое значение разрешает
+    auto is_zero_weight = [&](std::string_view params) {
+        while (!params.empty()) {
+            const auto semicolon = params.find(';');
+            auto param = trim(params.substr(0, semicolon));
+            params.remove_prefix(semicolon == std::string_view::npos ? params.size() : semicolon + 1);
+            if (param.empty() || (param[0] != 'q' && param[0] != 'Q')) {
+                continue;
+            }
+            param = trim(param.substr(1));
+            if (!param.starts_with('=')) {
+                continue;
+            }
+            param = trim(param.substr(1));
+            if (param.empty() || param.front() != '0') {
+                return false;
+            }
+            param.remove_prefix(1);
+            if (param.starts_with('.')) {
+                param.remove_prefix(1);
+            }
+            return param.find_first_not_of('0') == std::string_view::npos;
+        }
+        return false;
+    };
+
+    int wildcard = -1;
+    while (!header.empty()) {
+        const auto comma = header.find(',');
+        const auto item = header.substr(0, comma);
+        header.remove_prefix(comma == std::string_view::npos ? header.size() : comma + 1);
+        const auto semicolon = item.find(';');
+        const auto name = trim(item.substr(0, semicolon));
+        const auto params = semicolon == std::string_view::npos ? std::string_view{} : item.substr(semicolon + 1);
+        if (equals_ignore_case(name, coding)) {
+            return !is_zero_weight(params);
+        }
+        if (name == "*") {
+            wildcard = is_zero_weight(params) ? 0 : 1;
+        }
+    }
+    return wildcard == 1;
+}
+
+}  // namespace http_server
@@ -0,0 +1,55 @@
+// src/content_type.h
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <string_view>
+
+namespace http_server {
+
+// Тип содержимого файла по его расширению (без учёта регистра).
+// Используется и при отдаче файлов с диска, и при встраивании файлов в программу
+inline std::string_view GetContentType(std::string_view path) {
+    using namespace std::literals;
+    struct Type {
+        std::string_view extension;
+        std::string_view content_type;
+    };
+    static constexpr std::array TYPES = {
+        Type{"htm"sv, "text/html"sv},           Type{"html"sv, "text/html"sv},
+        Type{"css"sv, "text/css"sv},            Type{"txt"sv, "text/plain"sv},
+        Type{"js"sv, "text/javascript"sv},      Type{"json"sv, "application/json"sv},
+        Type{"xml"sv, "application/xml"sv},     Type{"png"sv, "image/png"sv},
+        Type{"jpg"sv, "image/jpeg"sv},          Type{"jpe"sv, "image/jpeg"sv},
+        Type{"jpeg"sv, "image/jpeg"sv},         Type{"gif"sv, "image/gif"sv},
+        Type{"bmp"sv, "image/bmp"sv},           Type{"ico"sv, "image/vnd.microsoft.icon"sv},
+        Type{"tiff"sv, "image/tiff"sv},         Type{"tif"sv, "image/tiff"sv},
+        Type{"svg"sv, "image/svg+xml"sv},       Type{"svgz"sv, "image/svg+xml"sv},
+        Type{"mp3"sv, "audio/mpeg"sv},
+    };
+    const auto dot = path.rfind('.');
+    const auto slash = path.rfind('/');
+    if (dot == std::string_view::npos || (slash != std::string_view::npos && dot < slash)) {
+        return "application/octet-stream"sv;
+    }
+    const auto extension = path.substr(dot + 1);
+    for (const auto& type : TYPES) {
+        if (std::equal(extension.begin(), extension.end(), type.extension.begin(), type.extension.end(),
+                       [](char a, char b) {
+                           return std::tolower(static_cast<unsigned char>(a)) == b;
+                       })) {
+            return type.content_type;
+        }
+    }
+    return "application/octet-stream"sv;
+}
+
+// Стоит ли сжимать содержимое этого типа: текст, JSON, XML и SVG сжимаются в несколько раз,
+// а картинки, звук и архивы уже сжаты
+inline bool IsCompressibleContentType(std::string_view content_type) noexcept {
+    using namespace std::literals;
+    return content_type.starts_with("text/"sv) || content_type == "application/json"sv
+           || content_type == "application/xml"sv || content_type == "image/svg+xml"sv;
+}
+
+}  // namespace http_server
@@ -0,0 +1,257 @@
+// src/coroutine_session.cpp
+#include "http_server.h"
+
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+#include <iostream>
+#include <boost/json.hpp> // Для сериализации тел ошибок в JSON
+
+namespace http_server {
+
+namespace {
+
+// Операции сопрограммы сессии возобновляют её в strand сессии
+constexpr net::use_awaitable_t<SessionStrand> use_awaitable;
+
+// Маркер завершения операций сокета: ошибка возвращается в ec, а не исключением,
+// состояние операции размещается в памяти сессии
+auto Completion(HandlerMemory& memory, beast::error_code& ec) {
+    return UseMemory(memory, net::redirect_error(use_awaitable, ec));
+}
+
+StringResponse MakeInternalError(const Request& req, unsigned http_version, bool keep_alive,
+                                 std::string_view message) {
+    auto res = MakeStringResponse(req, http::status::internal_server_error);
+    res.version(http_version);
+    res.set(http::field::content_type, "application/json");
+    res.keep_alive(keep_alive);
+    boost::json::object error_body;
+    error_body["code"] = "internalError";
+    error_body["message"] = message;
+    res.body() = boost::json::serialize(error_body);
+    res.prepare_payload();
+    return res;
+}
+
+}  // namespace
+
+CoroutineSessionBase::CoroutineSessionBase(SessionSocket&& socket, SessionLimiter::Permit&& permit,
+                                           SessionTimeouts timeouts)
+    : socket_(std::move(socket))
+    , permit_(std::move(permit))
+    , timeouts_(std::move(timeouts)) {
+}
+
+CoroutineSessionBase::~CoroutineSessionBase() {
+    if (timeouts_.wheel) {
+        timeouts_.wheel->Cancel(*this);
+    }
+}
+
+void CoroutineSessionBase::Run() {
+    net::co_spawn(socket_.get_executor(), Serve(shared_from_this()), net::detached);
+}
+
+CoroutineSessionBase::Awaitable<void> CoroutineSessionBase::Serve(std::shared_ptr<CoroutineSessionBase> self) {
+    // Кадр сопрограммы владеет сессией до конца соединения
+    co_await self->Loop();
+}
+
+CoroutineSessionBase::Awaitable<void> CoroutineSessionBase::Loop() {
+    beast::error_code ec;
+    for (;;) {
+        req_ = {};
+        arena_request_ = arena_holds_.load(std::memory_order_acquire) == 0;
+        if (arena_request_) {
+            // Прежний запрос и ответ на него уже не используются, арену можно перемотать
+            arena_.Rewind();
+            req_ = Request{std::piecewise_construct, std::make_tuple(ArenaAllocator<char>{arena_}),
+                           std::make_tuple(ArenaAllocator<char>{arena_})};
+        }
+        // Иначе прежний запрос ещё удерживает обработчик, и следующий размещается в куче
+
+        if (buffer_.size() == 0) {
+            // Ждём начала следующего запроса, не занимая буферов и операции чтения
+            SetDeadline(timeouts_.idle, {});
+            co_await socket_.async_wait(tcp::socket::wait_read, Completion(handler_memory_, ec));
+            if (ec) {
+                break;
+            }
+        }
+
+        SetDeadline(timeouts_.read, "Read timeout");
+        co_await http::async_read(socket_, buffer_, req_, Completion(handler_memory_, ec));
+        if (ec) {
+            if (ec != http::error::end_of_stream && !timed_out_) {
+                std::cerr << "Read error: " << ec.message() << std::endl;
+            }
+            break;
+        }
+        // Пока запрос обрабатывается, клиент вправе молчать
+        SetDeadline(Clock::duration::zero(), {});
+        // После ответа на этот запрос соединение будет закрыто или перейдёт на другой протокол
+        const bool last_request = !req_.keep_alive() || beast::websocket::is_upgrade(req_);
+
+        DispatchRequest(++seq_);
+        if (!response_) {
+            // Обработчик ответит позже, возможно из другого потока. OnResponse возобновит сопрограмму
+            co_await net::async_initiate<decltype(use_awaitable), void()>(
+                [this](auto handler) {
+                    response_waiter_ = [handler = std::move(handler)]() mutable {
+                        net::dispatch(std::move(handler));
+                    };
+                },
+                use_awaitable);
+        }
+        Response res = std::move(*response_);
+        response_.reset();
+
+        if (auto* upgrade = std::get_if<WebSocketUpgrade>(&res)) {
+            // Ответы на предыдущие запросы уже отправлены, соединение переходит к WebSocket-сессии
+            deadline_ = Clock::time_point::max();
+            if (timeouts_.wheel) {
+                timeouts_.wheel->Cancel(*this);
+            }
+            upgrade->buffered = beast::buffers_to_string(buffer_.data());
+            buffer_.clear();
+            StartWebSocketSession(std::move(socket_), std::move(permit_), std::move(*upgrade));
+            co_return;
+        }
+
+        SetDeadline(timeouts_.write, "Write timeout");
+        bool need_eof = false;
+        if (auto* cached = std::get_if<CachedResponse>(&res)) {
+            // Подготовленный ответ пишется в сокет как есть, без сериализации и копирования
+            need_eof = cached->need_eof();
+            co_await net::async_write(socket_, cached->GetBuffers(), Completion(handler_memory_, ec));
+        } else if (auto* string_res = std::get_if<StringResponse>(&res)) {
+            need_eof = string_res->need_eof();
+            co_await http::async_write(socket_, *string_res, Completion(handler_memory_, ec));
+        } else if (auto* shared_res = std::get_if<SharedResponse>(&res)) {
+            need_eof = shared_res->need_eof();
+            co_await http::async_write(socket_, *shared_res, Completion(handler_memory_, ec));
+        } else if (auto* span_res = std::get_if<SpanResponse>(&res)) {
+            need_eof = span_res->need_eof();
+            co_await http::async_write(socket_, *span_res, Completion(handler_memory_, ec));
+        } else if (auto* stream_res = std::get_if<StreamResponse>(&res)) {
+            need_eof = stream_res->need_eof();
+            co_await http::async_write(socket_, *stream_res, Completion(handler_memory_, ec));
+        } else if (auto* file_res = std::get_if<FileResponse>(&res)) {
+            need_eof = file_res->need_eof();
+            // Срок записи отсчитывается от последней отправленной части файла, а не от начала ответа
+            co_await AsyncWriteFile(
+                socket_, *file_res,
+                [this] {
+                    SetDeadline(timeouts_.write, "Write timeout");
+                },
+                Completion(handler_memory_, ec));
+        }
+        if (ec) {
+            if (!timed_out_) {
+                std::cerr << "Write error: " << ec.message() << std::endl;
+            }
+            break;
+        }
+        if (need_eof || last_request) {
+            break;
+        }
+    }
+
+    SetDeadline(Clock::duration::zero(), {});
+    socket_.shutdown(tcp::socket::shutdown_both, ec);
+    // Не логируем ошибку shutdown, т.к. это часто происходит, если клиент уже закрыл соединение
+}
+
+void CoroutineSessionBase::DispatchRequest(std::uint64_t seq) {
+    const unsigned http_version = req_.version();
+    const bool keep_alive = req_.keep_alive();
+    try {
+        HandleRequest(std::move(req_), ResponseSender{shared_from_this(), seq}, HoldRequest());
+    } catch (const std::exception& e) {
+        std::cerr << "RequestHandler exception: " << e.what() << std::endl;
+        OnResponse(seq, MakeInternalError(req_, http_version, keep_alive, "An internal server error occurred."));
+    } catch (...) {
+        std::cerr << "Unknown exception in RequestHandler." << std::endl;
+        OnResponse(seq,
+                   MakeInternalError(req_, http_version, keep_alive, "An unknown internal server error occurred."));
+    }
+}
+
+void CoroutineSessionBase::SendResponse(std::uint64_t seq, Response&& res) {
+    if (socket_.get_executor().running_in_this_thread()) {
+        // Обработчик ответил сразу, из сопрограммы сессии
+        return OnResponse(seq, std::move(res));
+    }
+    net::dispatch(socket_.get_executor(), [self = shared_from_this(), seq, res = std::move(res)]() mutable {
+        self->OnResponse(seq, std::move(res));
+    });
+}
+
+RequestHold CoroutineSessionBase::HoldRequest() {
+    if (!arena_request_) {
+        // Запрос в куче не мешает перематывать арену
+        return {};
+    }
+    arena_holds_.fetch_add(1, std::memory_order_relaxed);
+    return {shared_from_this(), &arena_holds_};
+}
+
+void CoroutineSessionBase::OnResponse(std::uint64_t seq, Response&& res) {
+    // Ответ на запрос, после которого соединение уже закрылось, или повторный ответ не нужен
+    if (seq != seq_ || response_) {
+        return;
+    }
+    response_ = std::move(res);
+    if (response_waiter_) {
+        auto waiter = std::move(response_waiter_);
+        waiter();
+    }
+}
+
+void CoroutineSessionBase::SetDeadline(Clock::duration timeout, std::string_view timeout_message) {
+    deadline_ = timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max();
+    timeout_message_ = timeout_message;
+    ScheduleDeadline();
+}
+
+void CoroutineSessionBase::ScheduleDeadline() {
+    // Как и SessionBase, сессия переставляется в колесе, только если срок стал ближе
+    if (!timeouts_.wheel || deadline_ >= wheel_deadline_) {
+        return;
+    }
+    wheel_deadline_ = deadline_;
+    timeouts_.wheel->Schedule(*this, deadline_ - Clock::now());
+}
+
+void CoroutineSessionBase::OnTimeout() noexcept {
+    // Вызывается под блокировкой колеса в его потоке, сессия уже может уничтожаться
+    if (auto self = weak_from_this().lock()) {
+        net::post(socket_.get_executor(), [self = std::move(self)] {
+            self->OnDeadline();
+        });
+    }
+}
+
+void CoroutineSessionBase::OnDeadline() {
+    wheel_deadline_ = Clock::time_point::max();
+    if (deadline_ > Clock::now()) {
+        // Срок перенесён, пока сессия стояла в колесе
+        return ScheduleDeadline();
+    }
+    if (!timeout_message_.empty()) {
+        std::cerr << timeout_message_ << std::endl;
+    }
+    timed_out_ = true;
+    deadline_ = Clock::time_point::max();
+    // Закрытие сокета прерывает операцию, которую ждёт сопрограмма, и она завершит сессию
+    beast::error_code ec;
+    socket_.close(ec);
+}
+
+}  // namespace http_server
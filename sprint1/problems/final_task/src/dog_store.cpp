@@ -0,0 +1,145 @@
+// src/dog_store.cpp
+#include "dog_store.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "road_index.h"
+
+namespace model {
+
+namespace {
+
+bool IsHorizontal(Direction direction) noexcept {
+    return direction == Direction::WEST || direction == Direction::EAST;
+}
+
+}  // namespace
+
+void DogStore::Reserve(std::size_t capacity) {
+    for (auto* values : {&xs_, &ys_, &vxs_, &vys_, &times_left_, &limits_}) {
+        values->reserve(capacity);
+    }
+    directions_.reserve(capacity);
+    slot_of_.reserve(capacity);
+    slots_.reserve(capacity);
+}
+
+DogStore::Handle DogStore::Add(Position position) {
+    const auto index = static_cast<std::uint32_t>(xs_.size());
+    std::uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[slot].index = index;
+    } else {
+        slot = static_cast<std::uint32_t>(slots_.size());
+        slots_.push_back({index, 0});
+    }
+    xs_.push_back(position.x);
+    ys_.push_back(position.y);
+    vxs_.push_back(0.0);
+    vys_.push_back(0.0);
+    times_left_.push_back(0.0);
+    directions_.push_back(Direction::NORTH);
+    limits_.push_back(position.y);
+    slot_of_.push_back(slot);
+    return {slot, slots_[slot].generation};
+}
+
+bool DogStore::Remove(Handle handle) {
+    // Иначе удалилась бы собака, занявшая слот после удаления, или сломался бы список свободных слотов
+    if (!Contains(handle)) {
+        return false;
+    }
+    auto& removed = slots_[handle.slot];
+    const auto index = removed.index;
+    const auto last = static_cast<std::uint32_t>(xs_.size() - 1);
+    if (index != last) {
+        xs_[index] = xs_[last];
+        ys_[index] = ys_[last];
+        vxs_[index] = vxs_[last];
+        vys_[index] = vys_[last];
+        times_left_[index] = times_left_[last];
+        directions_[index] = directions_[last];
+        limits_[index] = limits_[last];
+        slot_of_[index] = slot_of_[last];
+        slots_[slot_of_[index]].index = index;
+    }
+    for (auto* values : {&xs_, &ys_, &vxs_, &vys_, &times_left_, &limits_}) {
+        values->pop_back();
+    }
+    directions_.pop_back();
+    slot_of_.pop_back();
+    ++removed.generation;
+    free_slots_.push_back(handle.slot);
+    return true;
+}
+
+Position DogStore::GetClampedPosition(std::uint32_t index) const noexcept {
+    Position position{xs_[index], ys_[index]};
+    const auto direction = directions_[index];
+    double& along = IsHorizontal(direction) ? position.x : position.y;
+    along = direction == Direction::EAST || direction == Direction::SOUTH ? std::min(along, limits_[index])
+                                                                          : std::max(along, limits_[index]);
+    return position;
+}
+
+Position DogStore::GetPosition(Handle handle) const noexcept {
+    return GetClampedPosition(IndexOf(handle));
+}
+
+Speed DogStore::GetSpeed(Handle handle) const noexcept {
+    const auto index = IndexOf(handle);
+    if (times_left_[index] <= 0.0) {
+        return {0.0, 0.0};
+    }
+    return {vxs_[index], vys_[index]};
+}
+
+void DogStore::CopyStates(std::vector<DogState>& states) const {
+    states.resize(xs_.size());
+    for (std::uint32_t i = 0; i < xs_.size(); ++i) {
+        const bool moving = times_left_[i] > 0.0;
+        states[i] = {GetClampedPosition(i), {moving ? vxs_[i] : 0.0, moving ? vys_[i] : 0.0}, directions_[i]};
+    }
+}
+
+void DogStore::SetMovement(Handle handle, Direction direction, double speed) noexcept {
+    const auto index = IndexOf(handle);
+    // Собака продолжает путь из той точки, где остановилась, а не из точки за краем дороги
+    const auto position = GetClampedPosition(index);
+    xs_[index] = position.x;
+    ys_[index] = position.y;
+    directions_[index] = direction;
+
+    const auto target = roads_.GetFarthestPoint(position, direction);
+    const bool horizontal = IsHorizontal(direction);
+    limits_[index] = horizontal ? target.x : target.y;
+    const double distance = horizontal ? std::abs(target.x - position.x) : std::abs(target.y - position.y);
+    const double sign = direction == Direction::EAST || direction == Direction::SOUTH ? 1.0 : -1.0;
+    vxs_[index] = horizontal ? sign * speed : 0.0;
+    vys_[index] = horizontal ? 0.0 : sign * speed;
+    times_left_[index] = speed > 0.0 ? distance / speed : 0.0;
+}
+
+void DogStore::Advance(double dt) noexcept {
+    // Отдельные указатели с __restrict: компилятор знает, что массивы не пересекаются,
+    // и векторизует цикл без проверок во время выполнения
+    double* __restrict xs = xs_.data();
+    double* __restrict ys = ys_.data();
+    const double* __restrict vxs = vxs_.data();
+    const double* __restrict vys = vys_.data();
+    double* __restrict times_left = times_left_.data();
+    const std::size_t count = xs_.size();
+    for (std::size_t i = 0; i < count; ++i) {
+        // Собака, которой осталось идти меньше dt, доходит до края дороги и стоит.
+        // У стоящей собаки время вышло, и шаг нулевой: ветвлений в цикле нет
+        const double step = std::max(std::min(dt, times_left[i]), 0.0);
+        xs[i] += vxs[i] * step;
+        ys[i] += vys[i] * step;
+        times_left[i] -= step;
+    }
+}
+
+}  // namespace model
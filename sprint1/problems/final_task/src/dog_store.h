@@ -0,0 +1,157 @@
+// src/dog_store.h
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "model.h"
+
+namespace model {
+
+class Dog;
+
+// Собака в снимке состояния
+struct DogState {
+    Position position;
+    Speed speed;
+    Direction direction;
+};
+
+// Собаки одного игрового сеанса, разложенные по полям (structure of arrays): координаты, скорости
+// и остаток времени движения лежат в отдельных плотных массивах, и тик проходит по ним подряд,
+// без перехода по указателям. Ядро Advance векторизуется компилятором.
+// Собака адресуется дескриптором (Handle): он остаётся действительным, пока собаку не удалили,
+// хотя при удалении других собак её место в массивах меняется. Методы, читающие и меняющие
+// собаку, принимают только действительный дескриптор (см. Contains), это проверяет assert.
+// Движение ограничено дорогами: при смене направления RoadIndex находит, докуда собака может
+// дойти, и сохраняется время до этой точки. Дойдя до неё, собака останавливается.
+// Не потокобезопасен
+class DogStore {
+public:
+    struct Handle {
+        std::uint32_t slot;
+        std::uint32_t generation;
+
+        bool operator==(const Handle&) const = default;
+    };
+
+    // Индекс дорог карты сеанса должен жить дольше хранилища
+    explicit DogStore(const RoadIndex& roads) noexcept
+        : roads_(roads) {
+    }
+
+    DogStore(const DogStore&) = delete;
+    DogStore& operator=(const DogStore&) = delete;
+
+    void Reserve(std::size_t capacity);
+
+    // Добавляет неподвижную собаку, смотрящую на север
+    Handle Add(Position position);
+    // Удаляет собаку. Её место в массивах занимает последняя собака.
+    // Дескриптор уже удалённой собаки ничего не удаляет: возвращается false
+    bool Remove(Handle handle);
+
+    bool Contains(Handle handle) const noexcept {
+        return handle.slot < slots_.size() && slots_[handle.slot].generation == handle.generation;
+    }
+
+    std::size_t GetSize() const noexcept {
+        return xs_.size();
+    }
+
+    Dog Get(Handle handle) noexcept;
+
+    Position GetPosition(Handle handle) const noexcept;
+    // Нулевая, если собака стоит или уже упёрлась в край дороги
+    Speed GetSpeed(Handle handle) const noexcept;
+    Direction GetDirection(Handle handle) const noexcept {
+        return directions_[IndexOf(handle)];
+    }
+
+    // Записывает в states состояния всех собак в порядке массивов
+    void CopyStates(std::vector<DogState>& states) const;
+
+    // Собака поворачивает в direction и идёт со скоростью speed, пока не дойдёт до края дороги.
+    // speed == 0 — собака стоит, повернувшись в direction
+    void SetMovement(Handle handle, Direction direction, double speed) noexcept;
+
+    // Продвигает всех собак на dt секунд: position += speed * dt, но не дальше края дороги.
+    // Время движения каждой собаки уменьшается на dt
+    void Advance(double dt) noexcept;
+
+private:
+    struct Slot {
+        // Место собаки в массивах
+        std::uint32_t index;
+        // Растёт при каждом удалении собаки: дескрипторы удалённых собак перестают действовать
+        std::uint32_t generation;
+    };
+
+    // Место собаки в массивах
+    std::uint32_t IndexOf(Handle handle) const noexcept {
+        assert(Contains(handle));
+        return slots_[handle.slot].index;
+    }
+
+    // Положение, не выходящее за край дороги, до которого собака идёт: к концу движения
+    // накопленная ошибка округления может вывести координату за край на несколько ulp
+    Position GetClampedPosition(std::uint32_t index) const noexcept;
+
+    const RoadIndex& roads_;
+    // Массивы, которые читает и пишет Advance
+    std::vector<double> xs_;
+    std::vector<double> ys_;
+    std::vector<double> vxs_;
+    std::vector<double> vys_;
+    // Сколько секунд собака ещё может идти до края дороги
+    std::vector<double> times_left_;
+    // Массивы, которые Advance не трогает
+    std::vector<Direction> directions_;
+    // Координата края дороги, к которому идёт собака, вдоль направления движения
+    std::vector<double> limits_;
+    // Слоты собак в порядке массивов
+    std::vector<std::uint32_t> slot_of_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint32_t> free_slots_;
+};
+
+// Представление одной собаки в DogStore. Действует, пока собака не удалена, а хранилище живо.
+// Дёшево копируется
+class Dog {
+public:
+    Dog(DogStore& store, DogStore::Handle handle) noexcept
+        : store_(&store)
+        , handle_(handle) {
+    }
+
+    DogStore::Handle GetHandle() const noexcept {
+        return handle_;
+    }
+
+    Position GetPosition() const noexcept {
+        return store_->GetPosition(handle_);
+    }
+
+    Speed GetSpeed() const noexcept {
+        return store_->GetSpeed(handle_);
+    }
+
+    Direction GetDirection() const noexcept {
+        return store_->GetDirection(handle_);
+    }
+
+    void SetMovement(Direction direction, double speed) noexcept {
+        store_->SetMovement(handle_, direction, speed);
+    }
+
+private:
+    DogStore* store_;
+    DogStore::Handle handle_;
+};
+
+inline Dog DogStore::Get(Handle handle) noexcept {
+    return Dog{*this, handle};
+}
+
+}  // namespace model
@@ -0,0 +1,53 @@
+// src/dynamic_compression.cpp
+#include "dynamic_compression.h"
+
+namespace http_server {
+
+CompressionBudget::Permit& CompressionBudget::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        if (budget_) {
+            budget_->Release();
+        }
+        budget_ = std::move(other.budget_);
+    }
+    return *this;
+}
+
+CompressionBudget::Permit::~Permit() {
+    if (budget_) {
+        budget_->Release();
+    }
+}
+
+std::optional<CompressionBudget::Permit> CompressionBudget::TryAcquire() noexcept {
+    if (max_streams_ == 0) {
+        return std::nullopt;
+    }
+    auto active = active_.load(std::memory_order_relaxed);
+    do {
+        if (active >= max_streams_) {
+            skipped_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+    } while (!active_.compare_exchange_weak(active, active + 1, std::memory_order_acquire,
+                                            std::memory_order_relaxed));
+    granted_.fetch_add(1, std::memory_order_relaxed);
+    return Permit{shared_from_this()};
+}
+
+void CompressionBudget::Release() noexcept {
+    active_.fetch_sub(1, std::memory_order_release);
+}
+
+bool GzipBodyStream::Next(std::string& buffer) {
+    if (done_) {
+        return false;
+    }
+    part_.clear();
+    const bool more = source_->Next(part_);
+    encoder_.Write(part_, buffer, !more);
+    done_ = !more;
+    return more;
+}
+
+}  // namespace http_server
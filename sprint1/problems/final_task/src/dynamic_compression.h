@@ -0,0 +1,102 @@
+// src/dynamic_compression.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gzip.h"
+#include "shared_body.h"
+
+namespace http_server {
+
+// Сжатие ответов, которые формируются при каждом запросе
+struct DynamicCompressionOptions {
+    // Сколько ответов могут сжиматься одновременно (см. CompressionBudget). 0 — не сжимать
+    std::size_t max_streams = 2;
+    // Степень сжатия gzip. Невысокая: сжатие идёт во время отправки, на каждый запрос заново
+    int level = 4;
+    // Ответы короче этого размера отправляются несжатыми: выигрыш меньше одного TCP-сегмента
+    std::uint64_t min_size = 1400;
+};
+
+// Бюджет процессорного времени на сжатие ответов "на лету": не больше max_streams ответов
+// сжимаются одновременно. Заранее сжатые варианты (каталог карт, статические файлы) бюджет
+// не расходуют. Когда бюджет исчерпан, ответ отправляется несжатым: под нагрузкой рабочие
+// потоки заняты запросами, а не сжатием. Можно использовать из нескольких потоков
+class CompressionBudget : public std::enable_shared_from_this<CompressionBudget> {
+public:
+    class Permit {
+    public:
+        Permit(Permit&& other) noexcept = default;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        ~Permit();
+
+    private:
+        friend class CompressionBudget;
+        explicit Permit(std::shared_ptr<CompressionBudget> budget) noexcept
+            : budget_(std::move(budget)) {
+        }
+
+        std::shared_ptr<CompressionBudget> budget_;
+    };
+
+    // max_streams == 0 — ответы на лету не сжимаются
+    explicit CompressionBudget(std::size_t max_streams) noexcept
+        : max_streams_(max_streams) {
+    }
+
+    CompressionBudget(const CompressionBudget&) = delete;
+    CompressionBudget& operator=(const CompressionBudget&) = delete;
+
+    // Разрешение сжать один ответ, действует до уничтожения. nullopt, если бюджет исчерпан
+    std::optional<Permit> TryAcquire() noexcept;
+
+    std::size_t GetMaxStreams() const noexcept {
+        return max_streams_;
+    }
+
+    // Сколько разрешений выдано и сколько раз в них отказано из-за исчерпанного бюджета
+    std::uint64_t GetGrantedCount() const noexcept {
+        return granted_.load(std::memory_order_relaxed);
+    }
+    std::uint64_t GetSkippedCount() const noexcept {
+        return skipped_.load(std::memory_order_relaxed);
+    }
+
+private:
+    void Release() noexcept;
+
+    const std::size_t max_streams_;
+    std::atomic<std::size_t> active_{0};
+    std::atomic<std::uint64_t> granted_{0};
+    std::atomic<std::uint64_t> skipped_{0};
+};
+
+// Сжимает gzip тело, которое формирует другой поток, по мере отправки. Как и у исходного потока,
+// в памяти находится только текущая часть, а кодировщику нужно около 256 КБ на всё время отправки.
+// Удерживает разрешение бюджета, пока ответ не отправлен или не брошен
+class GzipBodyStream final : public BodyStream {
+public:
+    GzipBodyStream(std::unique_ptr<BodyStream> source, int level, CompressionBudget::Permit permit)
+        : source_(std::move(source))
+        , encoder_(level)
+        , permit_(std::move(permit)) {
+    }
+
+    bool Next(std::string& buffer) override;
+
+private:
+    std::unique_ptr<BodyStream> source_;
+    GzipEncoder encoder_;
+    CompressionBudget::Permit permit_;
+    // Несжатая часть, полученная от source_
+    std::string part_;
+    bool done_ = false;
+};
+
+}  // namespace http_server
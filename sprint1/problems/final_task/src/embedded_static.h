@@ -0,0 +1,42 @@
+// src/embedded_static.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace http_handler {
+
+// Статический файл, встроенный в программу при сборке (см. tools/embed_static.cpp).
+// Тип содержимого, ETag и сжатый вариант вычислены заранее
+struct EmbeddedFile {
+    // Путь относительно корня статических файлов, без ведущего '/'
+    std::string_view path;
+    std::string_view content_type;
+    std::string_view etag;
+    std::string_view data;
+    // Вариант для Content-Encoding: gzip и его ETag. Пусто, если сжатие почти не уменьшает файл
+    std::string_view gzip;
+    std::string_view gzip_etag;
+};
+
+// Хеш пути для совершенной хеш-таблицы встроенных файлов: FNV-1a с затравкой и перемешиванием.
+// Одна и та же функция используется генератором и при поиске
+constexpr std::uint32_t EmbeddedHash(std::string_view path, std::uint32_t seed) noexcept {
+    std::uint32_t hash = (2166136261u ^ seed) * 16777619u;
+    for (char c : path) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    hash ^= hash >> 15;
+    hash *= 0x2c1b3c6du;
+    hash ^= hash >> 12;
+    return hash;
+}
+
+// Ищет встроенный файл по пути (без ведущего '/'): два вычисления хеша и одно сравнение строк,
+// без выделения памяти и системных вызовов. Возвращает nullptr, если такого файла нет
+const EmbeddedFile* FindEmbeddedFile(std::string_view path) noexcept;
+
+// Число встроенных файлов. 0, если программа собрана без каталога статических файлов
+std::size_t GetEmbeddedFileCount() noexcept;
+
+}  // namespace http_handler
@@ -0,0 +1,104 @@
+// src/etag.h
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http_server {
+
+// Строит сильный ETag (в кавычках, как он передаётся в заголовке) по байтам представления:
+// длина и 64-битный хеш FNV-1a. Байты можно передавать частями, по мере сериализации.
+// Одинаковые байты всегда дают один и тот же ETag, в том числе после перезапуска сервера
+class ETagBuilder {
+public:
+    void Append(std::string_view bytes) noexcept {
+        for (unsigned char c : bytes) {
+            hash_ = (hash_ ^ c) * 1099511628211ull;
+        }
+        size_ += bytes.size();
+    }
+
+    std::uint64_t GetSize() const noexcept {
+        return size_;
+    }
+
+    std::string GetETag() const {
+        std::string etag;
+        etag.reserve(36);
+        etag += '"';
+        AppendHex(etag, size_);
+        etag += '-';
+        AppendHex(etag, hash_);
+        etag += '"';
+        return etag;
+    }
+
+private:
+    static void AppendHex(std::string& out, std::uint64_t value) {
+        constexpr std::string_view DIGITS = "0123456789abcdef";
+        char buf[16];
+        std::size_t size = 0;
+        do {
+            buf[size++] = DIGITS[value & 0xf];
+            value >>= 4;
+        } while (value != 0);
+        while (size != 0) {
+            out += buf[--size];
+        }
+    }
+
+    std::uint64_t hash_ = 14695981039346656037ull;
+    std::uint64_t size_ = 0;
+};
+
+// Сильный ETag представления, все байты которого уже есть в памяти
+inline std::string MakeStrongETag(std::string_view bytes) {
+    ETagBuilder builder;
+    builder.Append(bytes);
+    return builder.GetETag();
+}
+
+// Совпадает ли etag с одним из тегов заголовка If-None-Match (RFC 9110, 13.1.2).
+// Для If-None-Match используется слабое сравнение: префикс "W/" не учитывается.
+// "*" совпадает с любым существующим представлением
+inline bool MatchesIfNoneMatch(std::string_view header, std::string_view etag) noexcept {
+    auto is_space = [](char c) {
+        return c == ' ' || c == '\t';
+    };
+    auto skip_spaces = [&] {
+        while (!header.empty() && is_space(header.front())) {
+            header.remove_prefix(1);
+        }
+    };
+
+    skip_spaces();
+    if (header == "*") {
+        return true;
+    }
+    while (!header.empty()) {
+        skip_spaces();
+        if (header.starts_with("W/")) {
+            header.remove_prefix(2);
+        }
+        // Тег в кавычках; запятая внутри кавычек не разделяет теги
+        std::size_t end = 0;
+        if (header.starts_with('"')) {
+            end = header.find('"', 1);
+            end = end == std::string_view::npos ? header.size() : end + 1;
+        }
+        end = std::min(header.find(',', end), header.size());
+        auto tag = header.substr(0, end);
+        while (!tag.empty() && is_space(tag.back())) {
+            tag.remove_suffix(1);
+        }
+        if (!tag.empty() && tag == etag) {
+            return true;
+        }
+        header.remove_prefix(std::min(end + 1, header.size()));
+    }
+    return false;
+}
+
+}  // namespace http_server
@@ -0,0 +1,189 @@
+// src/file_response.h
+#pragma once
+#include "sdk.h"
+//
+#include <boost/asio/compose.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace http_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+// Дескриптор открытого файла. Закрывается, когда его перестают использовать все ответы
+class FileHandle {
+public:
+    explicit FileHandle(int fd) noexcept
+        : fd_(fd) {
+    }
+
+    FileHandle(const FileHandle&) = delete;
+    FileHandle& operator=(const FileHandle&) = delete;
+
+    ~FileHandle() {
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    int Get() const noexcept {
+        return fd_;
+    }
+
+private:
+    int fd_;
+};
+
+// Ответ, тело которого — участок файла. Заголовок (включая Content-Length) формирует тот,
+// кто создаёт ответ; prepare_payload для него не вызывается. Тело передаётся из файла в сокет
+// вызовом sendfile(2), без копирования через память процесса (см. AsyncWriteFile)
+struct FileResponse {
+    http::response<http::empty_body> header;
+    std::shared_ptr<const FileHandle> file;
+    // Участок файла, который нужно отправить. Для ответа на HEAD size == 0
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+
+    bool need_eof() const noexcept {
+        return header.need_eof();
+    }
+};
+
+namespace detail {
+
+// Колбэк прогресса по умолчанию: отправкой никто не интересуется
+struct IgnoreProgress {
+    void operator()() const noexcept {
+    }
+};
+
+// Отправляет заголовок ответа, затем участок файла частями: sendfile, пока сокет принимает данные,
+// и ожидание готовности сокета к записи, когда его буфер заполнен. После каждой части операция
+// уступает поток другим обработчикам io_context: быстрый клиент, скачивающий большой файл,
+// не занимает поток до конца отправки. После заголовка и каждой отправленной части вызывается
+// on_progress — в том же executor, что и сама операция
+template <typename Socket, typename OnProgress = IgnoreProgress>
+class WriteFileOp {
+public:
+    // Сколько байт отправлять одним вызовом sendfile, прежде чем уступить поток
+    static constexpr std::uint64_t MAX_SENDFILE_SIZE = 1024 * 1024;
+
+    WriteFileOp(Socket& socket, FileResponse& res, OnProgress on_progress = {}) noexcept
+        : socket_(socket)
+        , res_(res)
+        , on_progress_(std::move(on_progress))
+        , offset_(res.offset)
+        , remaining_(res.size) {
+    }
+
+    template <typename Self>
+    void operator()(Self& self, beast::error_code ec = {}, std::size_t bytes_transferred = 0) {
+        if (ec) {
+            return self.complete(ec, total_);
+        }
+        if (state_ == State::START) {
+            state_ = State::HEADER;
+            return http::async_write(socket_, res_.header, std::move(self));
+        }
+        if (state_ == State::HEADER) {
+            state_ = State::BODY;
+            total_ += bytes_transferred;
+            on_progress_();
+            if (remaining_ != 0 && !socket_.native_non_blocking()) {
+                socket_.native_non_blocking(true, ec);
+                if (ec) {
+                    return self.complete(ec, total_);
+                }
+            }
+        }
+        while (remaining_ != 0) {
+            const auto written = SendFile();
+            if (written > 0) {
+                offset_ += static_cast<std::uint64_t>(written);
+                remaining_ -= static_cast<std::uint64_t>(written);
+                total_ += static_cast<std::size_t>(written);
+                on_progress_();
+                if (remaining_ != 0) {
+                    // Следующая часть — после обработчиков, которые ждут своей очереди в io_context
+                    return net::post(socket_.get_executor(), std::move(self));
+                }
+            } else if (written < 0 && errno == EINTR) {
+                continue;
+            } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                // Буфер сокета заполнен: продолжим, когда в него можно будет писать
+                return socket_.async_wait(Socket::wait_write, std::move(self));
+            } else {
+                // written == 0: файл стал короче, чем было обещано в Content-Length
+                ec = written == 0 ? beast::error_code{net::error::eof}
+                                  : beast::error_code{errno, boost::system::system_category()};
+                return self.complete(ec, total_);
+            }
+        }
+        self.complete(ec, total_);
+    }
+
+private:
+    enum class State {
+        START,
+        HEADER,
+        BODY,
+    };
+
+    ssize_t SendFile() noexcept {
+        const auto count = static_cast<std::size_t>(std::min(remaining_, MAX_SENDFILE_SIZE));
+#ifdef __linux__
+        auto offset = static_cast<off_t>(offset_);
+        return ::sendfile(socket_.native_handle(), res_.file->Get(), &offset, count);
+#else
+        // Без sendfile участок файла копируется через небольшой буфер
+        char buf[64 * 1024];
+        const auto read = ::pread(res_.file->Get(), buf, std::min(count, sizeof(buf)), static_cast<off_t>(offset_));
+        return read <= 0 ? read : ::write(socket_.native_handle(), buf, static_cast<std::size_t>(read));
+#endif
+    }
+
+    Socket& socket_;
+    FileResponse& res_;
+    OnProgress on_progress_;
+    State state_ = State::START;
+    std::uint64_t offset_;
+    std::uint64_t remaining_;
+    std::size_t total_ = 0;
+};
+
+}  // namespace detail
+
+// Асинхронно отправляет FileResponse. Сигнатура завершения та же, что у http::async_write:
+// void(beast::error_code, std::size_t). Ответ и сокет должны жить до завершения операции
+template <typename Socket, typename CompletionToken>
+auto AsyncWriteFile(Socket& socket, FileResponse& res, CompletionToken&& token) {
+    return net::async_compose<CompletionToken, void(beast::error_code, std::size_t)>(
+        detail::WriteFileOp<Socket>{socket, res}, token, socket);
+}
+
+// То же, но после заголовка и каждой отправленной части вызывает on_progress() без аргументов.
+// Отправка большого файла медленному клиенту идёт долго: по прогрессу сессия продлевает срок записи,
+// чтобы он ограничивал простой, а не всю отправку
+template <typename Socket, typename OnProgress, typename CompletionToken>
+auto AsyncWriteFile(Socket& socket, FileResponse& res, OnProgress on_progress, CompletionToken&& token) {
+    return net::async_compose<CompletionToken, void(beast::error_code, std::size_t)>(
+        detail::WriteFileOp<Socket, OnProgress>{socket, res, std::move(on_progress)}, token, socket);
+}
+
+}  // namespace http_server
@@ -0,0 +1,41 @@
+// src/game_session.cpp
+#include "game_session.h"
+
+namespace model {
+
+GameSession::GameSession(const Map& map)
+    : map_(map)
+    , dogs_(map.GetRoadIndex()) {
+}
+
+void GameSession::SpawnDogs(std::size_t count, std::mt19937_64& random) {
+    const auto& roads = map_.GetRoads();
+    if (roads.empty()) {
+        return;
+    }
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::uniform_real_distribution<double> speed{0.5, 5.0};
+    std::uniform_int_distribution<std::size_t> road_index{0, roads.size() - 1};
+    std::uniform_int_distribution<int> direction{0, 3};
+    dogs_.Reserve(dogs_.GetSize() + count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& road = roads[road_index(random)];
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        const double t = unit(random);
+        auto dog = dogs_.Get(dogs_.Add({start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t}));
+        dog.SetMovement(static_cast<Direction>(direction(random)), speed(random));
+    }
+}
+
+void GameSession::Tick(double dt, SessionState& state) {
+    dogs_.Advance(dt);
+    CopyState(state);
+}
+
+void GameSession::CopyState(SessionState& state) const {
+    state.map = &map_;
+    dogs_.CopyStates(state.dogs);
+}
+
+}  // namespace model
@@ -0,0 +1,59 @@
+// src/game_session.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "dog_store.h"
+#include "model.h"
+
+namespace model {
+
+// Состояние сеанса после тика. Собаки перечислены в порядке хранилища
+struct SessionState {
+    const Map* map = nullptr;
+    std::vector<DogState> dogs;
+};
+
+// Состояние всех сеансов после тика
+struct GameState {
+    // Номер тика. 0 — до первого тика
+    std::uint64_t tick = 0;
+    std::vector<SessionState> sessions;
+};
+
+// Игровой сеанс на одной карте: собаки и их движение.
+// Время в сеансе идёт тиками (Tick), которые вызывает TickEngine.
+// Собак можно менять (GetDogs) только между тиками: пока TickEngine запущен, ими владеет он
+class GameSession {
+public:
+    explicit GameSession(const Map& map);
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+
+    const Map& GetMap() const noexcept {
+        return map_;
+    }
+
+    DogStore& GetDogs() noexcept {
+        return dogs_;
+    }
+
+    // Добавляет count собак в случайных точках дорог карты и пускает их в случайных направлениях
+    // со скоростью от 0.5 до 5. На карте без дорог собак не добавляет
+    void SpawnDogs(std::size_t count, std::mt19937_64& random);
+
+    // Продвигает собак на dt секунд и записывает новое состояние сеанса в state
+    void Tick(double dt, SessionState& state);
+
+    // Записывает текущее состояние сеанса в state
+    void CopyState(SessionState& state) const;
+
+private:
+    const Map& map_;
+    DogStore dogs_;
+};
+
+}  // namespace model
@@ -0,0 +1,60 @@
+// src/game_state_json.cpp
+#include "game_state_json.h"
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace http_handler {
+
+namespace {
+
+std::string_view GetDirectionName(model::Direction direction) noexcept {
+    switch (direction) {
+        case model::Direction::NORTH:
+            return "U";
+        case model::Direction::SOUTH:
+            return "D";
+        case model::Direction::WEST:
+            return "L";
+        case model::Direction::EAST:
+            return "R";
+    }
+    return "U";
+}
+
+void WriteDog(json_writer::JsonWriter& writer, const model::DogState& dog) {
+    writer.BeginObject();
+    writer.Key("pos").BeginArray().Double(dog.position.x).Double(dog.position.y).EndArray();
+    writer.Key("speed").BeginArray().Double(dog.speed.vx).Double(dog.speed.vy).EndArray();
+    writer.Field("dir", GetDirectionName(dog.direction));
+    writer.EndObject();
+}
+
+}  // namespace
+
+void WriteGameState(json_writer::JsonWriter& writer, const model::GameState& state) {
+    writer.BeginObject().Field("tick", static_cast<std::int64_t>(state.tick));
+    writer.Key("maps").BeginArray();
+    for (const auto& session : state.sessions) {
+        writer.BeginObject().Field("id", *session.map->GetId());
+        writer.Key("dogs").BeginArray();
+        for (const auto& dog : session.dogs) {
+            WriteDog(writer, dog);
+        }
+        writer.EndArray().EndObject();
+    }
+    writer.EndArray().EndObject();
+}
+
+void PublishGameState(http_server::BroadcastChannel& channel, const model::GameState& state) {
+    if (channel.GetSubscriberCount() == 0) {
+        return;
+    }
+    std::string frame;
+    json_writer::JsonWriter writer{frame};
+    WriteGameState(writer, state);
+    channel.Publish(http_server::MakeSharedBuffer(std::move(frame)));
+}
+
+}  // namespace http_handler
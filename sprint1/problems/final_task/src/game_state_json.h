@@ -0,0 +1,18 @@
+// src/game_state_json.h
+#pragma once
+#include "broadcast_channel.h"
+#include "game_session.h"
+#include "json_writer.h"
+
+namespace http_handler {
+
+// Состояние игры для /api/v1/game/state:
+// {"tick": N, "maps": [{"id": ..., "dogs": [{"pos": [x, y], "speed": [vx, vy], "dir": "U"}, ...]}, ...]}.
+// Направления: U — север, D — юг, L — запад, R — восток
+void WriteGameState(json_writer::JsonWriter& writer, const model::GameState& state);
+
+// Рассылает состояние игры подписчикам WebSocket на /api/v1/game/state. Состояние сериализуется
+// один раз, все подписчики получают один и тот же буфер. Без подписчиков не сериализуется
+void PublishGameState(http_server::BroadcastChannel& channel, const model::GameState& state);
+
+}  // namespace http_handler
@@ -0,0 +1,120 @@
+// src/gzip.h
+#pragma once
+#include <boost/beast/zlib/deflate_stream.hpp>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http_server {
+
+namespace detail {
+
+inline constexpr std::array<std::uint32_t, 256> MakeCrc32Table() noexcept {
+    std::array<std::uint32_t, 256> table{};
+    for (std::uint32_t i = 0; i < 256; ++i) {
+        std::uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        }
+        table[i] = c;
+    }
+    return table;
+}
+
+inline constexpr auto CRC32_TABLE = MakeCrc32Table();
+
+}  // namespace detail
+
+// CRC-32 (ISO 3309), которым gzip проверяет распакованные данные
+inline std::uint32_t Crc32(std::string_view data, std::uint32_t crc = 0) noexcept {
+    crc = ~crc;
+    for (unsigned char c : data) {
+        crc = detail::CRC32_TABLE[(crc ^ c) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+// Пошаговое сжатие в формат gzip (RFC 1952) для Content-Encoding: gzip: данные подаются частями,
+// сжатый результат дописывается в строку по мере готовности. Память не зависит от размера данных.
+// level — от 1 (быстрее) до 9 (меньше результат). Используется zlib из состава Beast,
+// поэтому внешняя библиотека не нужна
+class GzipEncoder {
+public:
+    explicit GzipEncoder(int level = 6) noexcept
+        : level_(level) {
+        // deflate_stream Beast выдаёт "сырой" deflate без обёртки zlib: заголовок и хвост gzip
+        // дописываются здесь
+        deflate_.reset(level, 15, 8, boost::beast::zlib::Strategy::normal);
+    }
+
+    // Сжимает очередную часть data и дописывает в out то, что уже готово. Часть сжатых данных
+    // может задержаться внутри кодировщика до следующих вызовов. finish — последняя часть:
+    // после неё в out дописываются остаток и хвост gzip, и кодировщик больше не используется
+    void Write(std::string_view data, std::string& out, bool finish) {
+        namespace zlib = boost::beast::zlib;
+        if (!header_written_) {
+            // Заголовок gzip: сигнатура, метод deflate, без флагов и времени, ОС — Unix
+            const unsigned char header[] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00,
+                                            static_cast<unsigned char>(level_ >= 9 ? 0x02 : 0x00), 0x03};
+            out.append(reinterpret_cast<const char*>(header), sizeof(header));
+            header_written_ = true;
+        }
+        crc_ = Crc32(data, crc_);
+        size_ += data.size();
+
+        zlib::z_params params;
+        params.next_in = data.data();
+        params.avail_in = data.size();
+        for (;;) {
+            // Обычно места хватает за один проход: upper_bound — размер сжатых данных
+            // в худшем случае, когда они несжимаемы
+            const auto used = out.size();
+            out.resize(used + std::max<std::size_t>(deflate_.upper_bound(params.avail_in), 4096));
+            params.next_out = out.data() + used;
+            params.avail_out = out.size() - used;
+            boost::beast::error_code ec;
+            deflate_.write(params, finish ? zlib::Flush::finish : zlib::Flush::none, ec);
+            out.resize(out.size() - params.avail_out);
+            if (ec == zlib::error::end_of_stream || (!finish && params.avail_in == 0 && params.avail_out != 0)
+                || (ec && ec != zlib::error::need_buffers)) {
+                break;
+            }
+        }
+        if (finish) {
+            // Хвост: CRC-32 и размер исходных данных по модулю 2^32, little-endian
+            AppendLe32(out, crc_);
+            AppendLe32(out, static_cast<std::uint32_t>(size_));
+        }
+    }
+
+private:
+    static void AppendLe32(std::string& out, std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out += static_cast<char>((value >> (8 * i)) & 0xff);
+        }
+    }
+
+    boost::beast::zlib::deflate_stream deflate_;
+    int level_;
+    std::uint32_t crc_ = 0;
+    std::uint64_t size_ = 0;
+    bool header_written_ = false;
+};
+
+// Сжимает data в формат gzip целиком
+inline std::string GzipCompress(std::string_view data, int level = 9) {
+    std::string out;
+    GzipEncoder encoder{level};
+    encoder.Write(data, out, true);
+    return out;
+}
+
+// Стоит ли хранить и отправлять сжатый вариант: он должен быть хотя бы на 10% меньше исходного.
+// Картинки и архивы уже сжаты, и для них gzip только тратит время клиента
+inline bool IsWorthCompressing(std::size_t original_size, std::size_t compressed_size) noexcept {
+    return compressed_size < original_size - original_size / 10;
+}
+
+}  // namespace http_server
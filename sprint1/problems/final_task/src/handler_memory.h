@@ -0,0 +1,174 @@
+// src/handler_memory.h
+#pragma once
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace http_server {
+
+// Память для состояния асинхронных операций одной сессии (по мотивам примера allocation из Asio).
+// Операции чтения и записи сессии и их промежуточные данные (например, парсер Beast)
+// размещаются в нескольких фиксированных слотах, а не в куче. Слоты занимаются и
+// освобождаются атомарно: операция может завершиться в другом потоке, пока strand
+// сессии запускает следующую.
+class HandlerMemory {
+public:
+    static constexpr std::size_t SLOT_SIZE = 1024;
+    static constexpr std::size_t SLOT_COUNT = 4;
+
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* Allocate(std::size_t size) {
+        if (size <= SLOT_SIZE) {
+            for (std::size_t i = 0; i < SLOT_COUNT; ++i) {
+                bool expected = false;
+                if (in_use_[i].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                    return &storage_[i];
+                }
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void Deallocate(void* p) noexcept {
+        for (std::size_t i = 0; i < SLOT_COUNT; ++i) {
+            if (p == &storage_[i]) {
+                in_use_[i].store(false, std::memory_order_release);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+
+private:
+    struct alignas(std::max_align_t) Slot {
+        std::byte data[SLOT_SIZE];
+    };
+
+    Slot storage_[SLOT_COUNT];
+    std::atomic<bool> in_use_[SLOT_COUNT] = {};
+};
+
+template <typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept
+        : memory_(&memory) {
+    }
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept
+        : memory_(other.GetMemory()) {
+    }
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        memory_->Deallocate(p);
+    }
+
+    HandlerMemory* GetMemory() const noexcept {
+        return memory_;
+    }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept {
+        return memory_ == other.GetMemory();
+    }
+
+private:
+    HandlerMemory* memory_;
+};
+
+// Обработчик завершения, у которого связанный аллокатор (associated allocator) берёт память из HandlerMemory
+template <typename Handler>
+class MemoryBoundHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    MemoryBoundHandler(HandlerMemory& memory, Handler handler)
+        : memory_(memory)
+        , handler_(std::move(handler)) {
+    }
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(memory_);
+    }
+
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+    const Handler& GetHandler() const noexcept {
+        return handler_;
+    }
+
+private:
+    HandlerMemory& memory_;
+    Handler handler_;
+};
+
+template <typename Handler>
+MemoryBoundHandler<std::decay_t<Handler>> BindMemory(HandlerMemory& memory, Handler&& handler) {
+    return {memory, std::forward<Handler>(handler)};
+}
+
+// Маркер завершения (completion token), обработчики которого размещают состояние операции
+// в HandlerMemory. Нужен там, где обработчик создаёт сам Asio, например для net::use_awaitable
+template <typename Token>
+struct MemoryBoundToken {
+    HandlerMemory& memory;
+    Token token;
+};
+
+template <typename Token>
+MemoryBoundToken<std::decay_t<Token>> UseMemory(HandlerMemory& memory, Token&& token) {
+    return {memory, std::forward<Token>(token)};
+}
+
+}  // namespace http_server
+
+namespace boost::asio {
+
+// Обработчик, привязанный к памяти, выполняется там же, где выполнялся бы исходный
+template <typename Handler, typename Executor>
+struct associated_executor<http_server::MemoryBoundHandler<Handler>, Executor> {
+    using type = associated_executor_t<Handler, Executor>;
+
+    static type get(const http_server::MemoryBoundHandler<Handler>& handler, const Executor& ex = Executor()) noexcept {
+        return associated_executor<Handler, Executor>::get(handler.GetHandler(), ex);
+    }
+};
+
+// Операция с MemoryBoundToken запускается с исходным маркером, а созданный по нему
+// обработчик оборачивается в MemoryBoundHandler
+template <typename Token, typename Signature>
+class async_result<http_server::MemoryBoundToken<Token>, Signature> {
+public:
+    using return_type = typename async_result<Token, Signature>::return_type;
+
+    template <typename Initiation, typename... Args>
+    static return_type initiate(Initiation&& initiation, http_server::MemoryBoundToken<Token> token, Args&&... args) {
+        return async_initiate<Token, Signature>(
+            [initiation = std::forward<Initiation>(initiation), &memory = token.memory](
+                auto&& handler, auto&&... init_args) mutable {
+                std::move(initiation)(http_server::BindMemory(memory, std::forward<decltype(handler)>(handler)),
+                                      std::forward<decltype(init_args)>(init_args)...);
+            },
+            token.token, std::forward<Args>(args)...);
+    }
+};
+
+}  // namespace boost::asio
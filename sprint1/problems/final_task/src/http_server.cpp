@@ -1,157 +1,490 @@
 // src/http_server.cpp
 #include "http_server.h"
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/websocket/rfc6455.hpp>
+#include <algorithm>
 #include <iostream>
-#include <boost/json.hpp> // Для сериализации тел ошибок в JSON в Session::OnRead
+#include <boost/json.hpp> // Для сериализации тел ошибок в JSON в SessionBase::OnRead
 
 namespace http_server {
 
-Listener::Listener(net::io_context& ioc, tcp::endpoint endpoint, RequestHandler&& handler)
-    : ioc_(ioc)
-    , acceptor_(ioc)
-    , handler_(std::move(handler)) { // Listener хранит свой экземпляр RequestHandler
+namespace {
+
+#ifdef SO_REUSEPORT
+// В Asio нет готовой опции для SO_REUSEPORT, поэтому описываем её сами
+using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+// Нужно ли закрыть соединение после отправки ответа
+bool NeedEof(const Response& res) {
+    return std::visit([](const auto& r) { return r.need_eof(); }, res);
+}
+
+}  // namespace
+
+StringResponse MakeStringResponse(const Request& req, http::status status) {
+    StringResponse res{std::piecewise_construct, std::make_tuple(req.body().get_allocator()),
+                       std::make_tuple(req.get_allocator())};
+    res.result(status);
+    res.version(req.version());
+    return res;
+}
+
+WebSocketUpgrade MakeWebSocketUpgrade(const Request& req, std::shared_ptr<BroadcastChannel> channel) {
+    WebSocketUpgrade upgrade{
+        .request = {req.method(), req.target(), req.version()},
+        .channel = std::move(channel),
+        .buffered = {},
+    };
+    for (const auto& field : req) {
+        upgrade.request.insert(field.name(), field.name_string(), field.value());
+    }
+    return upgrade;
+}
+
+tcp::acceptor MakeAcceptor(net::io_context& ioc, const tcp::endpoint& endpoint, const ListenerOptions& options) {
+    tcp::acceptor acceptor(ioc);
     beast::error_code ec;
 
-    acceptor_.open(endpoint.protocol(), ec);
+    acceptor.open(endpoint.protocol(), ec);
     if (ec) {
         throw std::runtime_error("Failed to open acceptor: " + ec.message());
     }
 
-    acceptor_.set_option(net::socket_base::reuse_address(true), ec);
+    acceptor.set_option(net::socket_base::reuse_address(true), ec);
     if (ec) {
         throw std::runtime_error("Failed to set reuse address: " + ec.message());
     }
 
-    acceptor_.bind(endpoint, ec);
+    if (options.reuse_port) {
+#ifdef SO_REUSEPORT
+        acceptor.set_option(reuse_port(true), ec);
+        if (ec) {
+            throw std::runtime_error("Failed to set reuse port: " + ec.message());
+        }
+#else
+        throw std::runtime_error("SO_REUSEPORT is not supported on this platform");
+#endif
+    }
+
+    acceptor.bind(endpoint, ec);
     if (ec) {
         throw std::runtime_error("Failed to bind: " + ec.message());
     }
 
-    acceptor_.listen(net::socket_base::max_listen_connections, ec);
+    acceptor.listen(net::socket_base::max_listen_connections, ec);
     if (ec) {
         throw std::runtime_error("Failed to start listening: " + ec.message());
     }
+    return acceptor;
 }
 
-void Listener::Run() {
-    DoAccept();
+void PrepareSessionSocket(SessionSocket& socket) {
+    // Ответы на конвейерные запросы уходят несколькими мелкими записями подряд,
+    // алгоритм Нейгла задерживал бы каждую следующую до подтверждения предыдущей
+    beast::error_code ec;
+    socket.set_option(tcp::no_delay(true), ec);
 }
 
-void Listener::DoAccept() {
-    acceptor_.async_accept(
-        [self = shared_from_this()](beast::error_code ec, tcp::socket socket) {
-            self->OnAccept(ec, std::move(socket));
-        });
+SessionTimeouts MakeSessionTimeouts(net::io_context& ioc, const ListenerOptions& options) {
+    SessionTimeouts timeouts{
+        .idle = options.idle_timeout,
+        .read = options.read_timeout,
+        .write = options.write_timeout,
+        .wheel = nullptr,
+    };
+    const auto max_timeout = std::max({options.idle_timeout, options.read_timeout, options.write_timeout});
+    if (max_timeout.count() > 0) {
+        // Тик в секунду: таймаутам соединений не нужна большая точность
+        constexpr auto tick = std::chrono::seconds{1};
+        timeouts.wheel = std::make_shared<TimerWheel>(ioc, tick, max_timeout / tick + 2);
+        timeouts.wheel->Start();
+    }
+    return timeouts;
 }
 
-void Listener::OnAccept(beast::error_code ec, tcp::socket socket) {
-    if (ec) {
-        std::cerr << "Accept error: " << ec.message() << std::endl;
-    } else {
-        // Создаём сессию и запускаем её.
-        // handler_ (lvalue, член Listener) будет скопирован в параметр конструктора Session,
-        // т.к. конструктор Session теперь принимает RequestHandler по значению.
-        // Затем этот параметр будет перемещён в член handler_ сессии.
-        std::make_shared<Session>(std::move(socket), handler_)->Run();
+void ResponseSender::operator()(Response&& res) const {
+    session_->SendResponse(seq_, std::move(res));
+}
+
+SessionBase::SessionBase(SessionSocket&& socket, SessionLimiter::Permit&& permit, std::size_t pipeline_limit,
+                         SessionTimeouts timeouts)
+    : socket_(std::move(socket))
+    , permit_(std::move(permit))
+    , timeouts_(std::move(timeouts))
+    , responses_(std::max<std::size_t>(1, pipeline_limit))
+    , response_arenas_(responses_.size()) {
+}
+
+SessionBase::~SessionBase() {
+    if (timeouts_.wheel) {
+        timeouts_.wheel->Cancel(*this);
+    }
+}
+
+SessionLimiter::Permit SessionBase::Recycle() noexcept {
+    // Ссылок на сессию нет, значит, операций и обработчиков запросов, ожидающих её, тоже нет.
+    // Осталось только колесо, которое может держать запись сессии
+    if (timeouts_.wheel) {
+        timeouts_.wheel->Cancel(*this);
+    }
+    beast::error_code ec;
+    socket_.close(ec);
+
+    // Объекты из арен больше не используются, арены можно перемотать
+    req_ = {};
+    for (auto& response : responses_) {
+        response.reset();
     }
+    for (auto& arena : arenas_) {
+        arena.Trim(POOLED_ARENA_BLOCKS);
+    }
+    std::fill(std::begin(arena_users_), std::end(arena_users_), 0);
+    current_arena_ = HEAP_ARENA;
 
-    // Принимаем следующее соединение
-    DoAccept();
+    buffer_.clear();
+    if (buffer_.capacity() > MAX_POOLED_BUFFER_SIZE) {
+        buffer_.shrink_to_fit();
+    }
+
+    first_seq_ = 0;
+    pending_ = 0;
+    reading_ = waiting_readable_ = writing_ = false;
+    read_deadline_ = write_deadline_ = wheel_deadline_ = Clock::time_point::max();
+    timed_out_ = read_closed_ = false;
+    return std::move(permit_);
 }
 
-// Конструктор Session принимает RequestHandler по значению
-Session::Session(tcp::socket&& socket, RequestHandler handler) // handler здесь - копия или перемещенный объект
-    : socket_(std::move(socket))
-    , handler_(std::move(handler)) { // Перемещаем из параметра в член класса
+void SessionBase::Reopen(SessionSocket&& socket, SessionLimiter::Permit&& permit) {
+    socket_ = std::move(socket);
+    permit_ = std::move(permit);
 }
 
-void Session::Run() {
-    DoRead();
+void SessionBase::Run() {
+    // Запускаем чтение в strand сессии
+    net::dispatch(socket_.get_executor(), [self = shared_from_this()] {
+        self->DoRead();
+    });
 }
 
-void Session::DoRead() {
-    req_ = {}; // Очищаем запрос перед чтением
+void SessionBase::DoRead() {
+    if (reading_ || read_closed_ || pending_ >= responses_.size()) {
+        // Чтение уже идёт, запросов больше не будет или очередь ответов заполнена.
+        // В последнем случае чтение возобновится после отправки очередного ответа
+        return;
+    }
+    reading_ = true;
+    ResetRequest(); // Очищаем запрос перед чтением
+    if (buffer_.size() != 0) {
+        // Начало следующего запроса уже прочитано вместе с предыдущим
+        return StartRead();
+    }
+    // Ждём начала следующего запроса, не занимая буферов и операции чтения
+    waiting_readable_ = true;
+    SetIdleDeadline();
+    socket_.async_wait(tcp::socket::wait_read,
+        BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec) {
+            self->OnReadable(ec);
+        }));
+}
+
+void SessionBase::OnReadable(beast::error_code ec) {
+    waiting_readable_ = false;
+    if (ec || read_closed_) {
+        // Соединение закрыто по таймауту или из-за ошибки
+        reading_ = false;
+        read_closed_ = true;
+        read_deadline_ = Clock::time_point::max();
+        return DoWrite();
+    }
+    StartRead();
+}
+
+void SessionBase::StartRead() {
+    // Запрос начал поступать: он должен быть прочитан целиком за read_timeout
+    read_deadline_ = DeadlineAfter(timeouts_.read);
+    UpdateDeadline();
     http::async_read(socket_, buffer_, req_,
-        [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
+        BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
             self->OnRead(ec, bytes_transferred);
-        });
+        }));
 }
 
-void Session::OnRead(beast::error_code ec, std::size_t bytes_transferred) {
+void SessionBase::OnRead(beast::error_code ec, std::size_t bytes_transferred) {
     boost::ignore_unused(bytes_transferred);
-
-    if (ec == http::error::end_of_stream)
-        return DoClose();
+    reading_ = false;
+    read_deadline_ = Clock::time_point::max();
 
     if (ec) {
-        std::cerr << "Read error: " << ec.message() << std::endl;
-        return DoClose(); // Закрываем соединение при ошибке чтения
-    }
-
-    // Лямбда для отправки ответа, захватывает self
-    auto send_cb = [self = shared_from_this()](http::response<http::string_body>&& res) {
-        self->res_ = std::move(res);
-        http::async_write(
-            self->socket_,
-            self->res_,
-            // ИЗМЕНЕНО: Лямбда для async_write теперь корректно принимает bytes_transferred
-            [self](beast::error_code write_ec, std::size_t written_bytes) { // Используем другое имя для параметра
-                // ИЗМЕНЕНО: Передаём written_bytes (переименованный bytes_transferred) в OnWrite
-                self->OnWrite(write_ec, written_bytes, self->res_.need_eof());
-            });
-    };
-    
+        if (ec != http::error::end_of_stream && !timed_out_) {
+            std::cerr << "Read error: " << ec.message() << std::endl;
+        }
+        // Дописываем ответы на уже прочитанные запросы и закрываем соединение
+        read_closed_ = true;
+        return DoWrite();
+    }
+
+    // Резервируем место под ответ: он будет отправлен после ответов на предыдущие запросы
+    const std::uint64_t seq = first_seq_ + pending_;
+    ++pending_;
+    response_arenas_[seq % responses_.size()] = static_cast<std::uint8_t>(current_arena_);
+    ++arena_users_[current_arena_];
+
+    const unsigned http_version = req_.version();
+    const bool keep_alive = req_.keep_alive();
+    if (!keep_alive || beast::websocket::is_upgrade(req_)) {
+        // После ответа на этот запрос соединение будет закрыто или перейдёт на другой протокол
+        read_closed_ = true;
+    }
+
     try {
-        // Передаём управление обработчику запросов
-        handler_(std::move(req_), std::move(send_cb));
+        // Передаём управление обработчику запросов.
+        // Обработчик может отправить ответ позже и из любого потока
+        HandleRequest(std::move(req_), ResponseSender{shared_from_this(), seq}, HoldRequest(seq));
     } catch (const std::exception& e) {
         std::cerr << "RequestHandler exception: " << e.what() << std::endl;
         // Формируем и отправляем ответ 500 Internal Server Error
-        http::response<http::string_body> res{http::status::internal_server_error, req_.version()};
+        auto res = MakeStringResponse(req_, http::status::internal_server_error);
+        res.version(http_version);
         res.set(http::field::content_type, "application/json");
-        res.keep_alive(req_.keep_alive()); // Используем req_ из сессии, он еще действителен
+        res.keep_alive(keep_alive);
         boost::json::object error_body;
         error_body["code"] = "internalError";
         error_body["message"] = "An internal server error occurred.";
         res.body() = boost::json::serialize(error_body);
         res.prepare_payload();
-        send_cb(std::move(res)); // Отправляем через наш колбэк
+        OnResponse(seq, std::move(res));
     } catch (...) {
         std::cerr << "Unknown exception in RequestHandler." << std::endl;
-        http::response<http::string_body> res{http::status::internal_server_error, req_.version()};
+        auto res = MakeStringResponse(req_, http::status::internal_server_error);
+        res.version(http_version);
         res.set(http::field::content_type, "application/json");
-        res.keep_alive(req_.keep_alive());
+        res.keep_alive(keep_alive);
         boost::json::object error_body;
         error_body["code"] = "internalError";
         error_body["message"] = "An unknown internal server error occurred.";
         res.body() = boost::json::serialize(error_body);
         res.prepare_payload();
-        send_cb(std::move(res));
+        OnResponse(seq, std::move(res));
     }
+
+    // Не дожидаясь ответа, читаем следующий запрос, если клиент уже прислал его
+    DoRead();
 }
 
-void Session::OnWrite(beast::error_code ec, std::size_t bytes_transferred, bool close) {
-    boost::ignore_unused(bytes_transferred); // bytes_transferred теперь снова передается
+void SessionBase::SendResponse(std::uint64_t seq, Response&& res) {
+    // Если вызов уже в strand сессии, ответ обрабатывается сразу, иначе операция
+    // размещается в памяти сессии
+    net::dispatch(socket_.get_executor(),
+                  BindMemory(handler_memory_, [self = shared_from_this(), seq, res = std::move(res)]() mutable {
+                      self->OnResponse(seq, std::move(res));
+                  }));
+}
 
-    if (ec) {
-        std::cerr << "Write error: " << ec.message() << std::endl;
+RequestHold SessionBase::HoldRequest(std::uint64_t seq) {
+    const std::size_t arena = response_arenas_[seq % responses_.size()];
+    if (arena == HEAP_ARENA) {
+        // Запрос в куче не мешает перематывать арены
+        return {};
+    }
+    arena_holds_[arena].fetch_add(1, std::memory_order_relaxed);
+    return {shared_from_this(), &arena_holds_[arena]};
+}
+
+void SessionBase::OnResponse(std::uint64_t seq, Response&& res) {
+    // Ответы на запросы, пришедшие после закрытия соединения, не нужны
+    if (seq < first_seq_ || seq - first_seq_ >= pending_) {
         return;
     }
+    responses_[seq % responses_.size()] = std::move(res);
+    DoWrite();
+}
+
+void SessionBase::DoWrite() {
+    if (writing_) {
+        return;
+    }
+    if (pending_ == 0) {
+        if (read_closed_ && !reading_) {
+            DoClose();
+        }
+        return;
+    }
+    auto& front = responses_[first_seq_ % responses_.size()];
+    if (!front) {
+        // Ответ на самый ранний запрос ещё не готов, более поздние ждут его
+        return;
+    }
+    if (auto* upgrade = std::get_if<WebSocketUpgrade>(&*front)) {
+        WebSocketUpgrade extracted = std::move(*upgrade);
+        front.reset();
+        --arena_users_[response_arenas_[first_seq_ % responses_.size()]];
+        ++first_seq_;
+        --pending_;
+        return DoUpgrade(std::move(extracted));
+    }
+    writing_ = true;
+    write_deadline_ = DeadlineAfter(timeouts_.write);
+    UpdateDeadline();
+    auto on_write = BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
+        self->OnWrite(ec, bytes_transferred);
+    });
+    if (auto* cached = std::get_if<CachedResponse>(&*front)) {
+        // Подготовленный ответ пишется в сокет как есть, без сериализации и копирования
+        net::async_write(socket_, cached->GetBuffers(), std::move(on_write));
+    } else if (auto* file = std::get_if<FileResponse>(&*front)) {
+        // Файл отправляется частями, возможно долго: срок записи отсчитывается от последней части.
+        // Колесо переставит сессию само, когда сработает прежний, более ранний срок
+        AsyncWriteFile(
+            socket_, *file,
+            [this] {
+                write_deadline_ = DeadlineAfter(timeouts_.write);
+            },
+            std::move(on_write));
+    } else {
+        std::visit(
+            [this, &on_write](auto& res) {
+                using ResponseType = std::decay_t<decltype(res)>;
+                if constexpr (!std::is_same_v<ResponseType, CachedResponse>
+                              && !std::is_same_v<ResponseType, FileResponse>
+                              && !std::is_same_v<ResponseType, WebSocketUpgrade>) {
+                    http::async_write(socket_, res, std::move(on_write));
+                }
+            },
+            *front);
+    }
+}
+
+void SessionBase::OnWrite(beast::error_code ec, std::size_t bytes_transferred) {
+    boost::ignore_unused(bytes_transferred);
+    writing_ = false;
+    write_deadline_ = Clock::time_point::max();
+
+    if (ec) {
+        if (!timed_out_) {
+            std::cerr << "Write error: " << ec.message() << std::endl;
+        }
+        read_closed_ = true;
+        return DoClose();
+    }
+
+    const std::size_t index = first_seq_ % responses_.size();
+    auto& front = responses_[index];
+    const bool close = NeedEof(*front);
+    front.reset();
+    --arena_users_[response_arenas_[index]];
+    ++first_seq_;
+    --pending_;
 
     if (close) {
+        read_closed_ = true;
         return DoClose();
     }
 
-    DoRead(); // Читаем следующий запрос
+    // В очереди освободилось место - можно читать дальше
+    DoRead();
+    DoWrite();
+    // Если это был последний ответ, а следующий запрос не начал поступать, соединение простаивает
+    SetIdleDeadline();
+}
+
+SessionBase::Clock::time_point SessionBase::DeadlineAfter(Clock::duration timeout) {
+    return timeout.count() > 0 ? Clock::now() + timeout : Clock::time_point::max();
 }
 
-void Session::DoClose() {
+void SessionBase::SetIdleDeadline() {
+    if (!waiting_readable_) {
+        return;
+    }
+    if (pending_ != 0) {
+        read_deadline_ = Clock::time_point::max();
+    } else if (read_deadline_ == Clock::time_point::max()) {
+        read_deadline_ = DeadlineAfter(timeouts_.idle);
+        UpdateDeadline();
+    }
+}
+
+void SessionBase::UpdateDeadline() {
+    const auto deadline = std::min(read_deadline_, write_deadline_);
+    if (!timeouts_.wheel || deadline >= wheel_deadline_) {
+        return;
+    }
+    wheel_deadline_ = deadline;
+    timeouts_.wheel->Schedule(*this, deadline - Clock::now());
+}
+
+void SessionBase::OnTimeout() noexcept {
+    // Вызывается под блокировкой колеса в его потоке. Сессия уже может уничтожаться,
+    // тогда weak_from_this вернёт пустой указатель, а деструктор дождётся снятия с колеса
+    if (auto self = weak_from_this().lock()) {
+        net::post(socket_.get_executor(), BindMemory(handler_memory_, [self = std::move(self)] {
+            self->OnDeadline();
+        }));
+    }
+}
+
+void SessionBase::OnDeadline() {
+    // Колесо уже сняло сессию
+    wheel_deadline_ = Clock::time_point::max();
+    const auto now = Clock::now();
+    if (std::min(read_deadline_, write_deadline_) > now) {
+        // Сроки перенесены, пока сессия стояла в колесе
+        return UpdateDeadline();
+    }
+
+    if (now >= write_deadline_) {
+        std::cerr << "Write timeout" << std::endl;
+    } else if (!waiting_readable_) {
+        std::cerr << "Read timeout" << std::endl;
+    }
+    // Истечение срока простоя - штатная ситуация, её не логируем
+    timed_out_ = true;
+    read_closed_ = true;
+    read_deadline_ = write_deadline_ = Clock::time_point::max();
+    // Закрытие сокета прерывает незавершённые операции, их обработчики завершат сессию
     beast::error_code ec;
-    socket_.shutdown(tcp::socket::shutdown_both, ec);
-    // Не логируем ошибку shutdown, т.к. это часто происходит, если клиент уже закрыл соединение
+    socket_.close(ec);
 }
 
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler) {
-    std::make_shared<Listener>(ioc, endpoint, std::move(handler))->Run();
+void SessionBase::DoUpgrade(WebSocketUpgrade&& upgrade) {
+    // Запрос на переключение протокола был последним: после него сессия не читает запросов,
+    // а ответы на предыдущие уже отправлены. Сроки сессии больше не нужны
+    read_deadline_ = write_deadline_ = Clock::time_point::max();
+    if (timeouts_.wheel) {
+        timeouts_.wheel->Cancel(*this);
+    }
+    upgrade.buffered = beast::buffers_to_string(buffer_.data());
+    buffer_.clear();
+    StartWebSocketSession(std::move(socket_), std::move(permit_), std::move(upgrade));
+}
+
+void SessionBase::ResetRequest() {
+    // Прежний запрос уже передан обработчику, его память освобождается вместе с ареной
+    req_ = {};
+    current_arena_ = HEAP_ARENA;
+    for (std::size_t i = 0; i < ARENA_COUNT; ++i) {
+        if (arena_users_[i] == 0 && arena_holds_[i].load(std::memory_order_acquire) == 0) {
+            // Ни один объект из арены больше не используется
+            current_arena_ = i;
+            arenas_[i].Rewind();
+            break;
+        }
+    }
+    if (current_arena_ == HEAP_ARENA) {
+        // Обе арены заняты запросами, которые ещё обрабатываются или удерживаются, возможно в других потоках.
+        // Чтобы не делить с ними арену, этот запрос размещается в куче
+        return;
+    }
+    auto& arena = arenas_[current_arena_];
+    req_ = Request{std::piecewise_construct, std::make_tuple(ArenaAllocator<char>{arena}),
+                   std::make_tuple(ArenaAllocator<char>{arena})};
+}
+
+void SessionBase::DoClose() {
+    beast::error_code ec;
+    socket_.shutdown(tcp::socket::shutdown_both, ec);
+    // Не логируем ошибку shutdown, т.к. это часто происходит, если клиент уже закрыл соединение
 }
 
 }  // namespace http_server
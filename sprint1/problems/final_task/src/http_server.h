@@ -2,13 +2,32 @@
 #pragma once
 #include "sdk.h"
 //
+#include <boost/asio/awaitable.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
-#include <functional> // Убедимся, что std::function доступен
+#include <utility>
+#include <variant>
+#include <iostream>
+
+#include "arena.h"
+#include "file_response.h"
+#include "handler_memory.h"
+#include "session_limiter.h"
+#include "session_pool.h"
+#include "shared_body.h"
+#include "small_function.h"
+#include "timer_wheel.h"
 
 namespace http_server {
 
@@ -17,51 +36,534 @@ namespace http = beast::http;
 namespace net = boost::asio;
 using tcp = net::ip::tcp;
 
-// Функциональный объект для обработки HTTP-запросов
-using RequestHandler = std::function<void(http::request<http::string_body>&& req, 
-                                        std::function<void(http::response<http::string_body>&&)>&& send)>;
+// Strand сессии и привязанный к нему сокет. Конкретный тип исполнителя вместо any_io_executor
+// избавляет от выделения памяти при каждом копировании исполнителя внутри асинхронных операций
+using SessionStrand = net::strand<net::io_context::executor_type>;
+using SessionSocket = tcp::socket::rebind_executor<SessionStrand>::other;
+
+// Поля и тело сообщений сессии размещаются в её арене (см. Session)
+using ArenaFields = http::basic_fields<ArenaAllocator<char>>;
+using ArenaStringBody = http::basic_string_body<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+using Request = http::request<ArenaStringBody, ArenaFields>;
+using StringResponse = http::response<ArenaStringBody, ArenaFields>;
+
+// Создаёт пустой ответ, поля и тело которого размещаются в арене запроса req.
+// Ответ, созданный не из запроса сессии, размещается в куче
+StringResponse MakeStringResponse(const Request& req, http::status status);
+
+class BroadcastChannel;
+
+// "Ответ" на запрос переключения на WebSocket. Когда ответы на все предыдущие запросы отправлены,
+// сессия передаёт соединение WebSocket-сессии, которая завершает рукопожатие и подписывается на channel
+struct WebSocketUpgrade {
+    // Заголовки запроса на переключение протокола, нужны для рукопожатия
+    http::request<http::empty_body> request;
+    std::shared_ptr<BroadcastChannel> channel;
+    // Байты, которые клиент прислал вслед за запросом и HTTP-сессия уже прочитала в свой буфер.
+    // Это начало WebSocket-кадров, их получает WebSocket-сессия
+    std::string buffered;
+
+    bool need_eof() const noexcept {
+        return false;
+    }
+};
+
+// Создаёт WebSocketUpgrade для запроса, прошедшего проверку websocket::is_upgrade
+WebSocketUpgrade MakeWebSocketUpgrade(const Request& req, std::shared_ptr<BroadcastChannel> channel);
+
+// Ответ, который может отправить сессия: обычный, с разделяемым телом, заранее подготовленный,
+// из участка памяти, формируемый по частям во время отправки, из файла или переключение на WebSocket
+using Response = std::variant<StringResponse, SharedResponse, CachedResponse, SpanResponse, StreamResponse,
+                              FileResponse, WebSocketUpgrade>;
+
+// Как устроены сессии, которые создаёт Listener
+enum class SessionStyle {
+    // Цепочка колбэков (Session): конвейерная обработка и пул сессий
+    CALLBACKS,
+    // Сопрограмма (CoroutineSession): запросы обрабатываются по одному
+    COROUTINES,
+};
 
-// Принимает входящие соединения и запускает сессии
-class Listener : public std::enable_shared_from_this<Listener> {
+// Параметры прослушивающего сокета и создаваемых им сессий
+struct ListenerOptions {
+    // Включает SO_REUSEPORT: несколько акцепторов (по одному на io_context)
+    // могут слушать один и тот же порт, а ядро распределяет между ними соединения
+    bool reuse_port = false;
+    // Сколько запросов одного соединения может ожидать отправки ответа (HTTP/1.1 pipelining).
+    // Пока очередь ответов заполнена, сессия не читает следующие запросы
+    std::size_t pipeline_limit = 16;
+    // Сколько соединение может простаивать в ожидании следующего запроса, пока ответов
+    // к отправке нет. Для всех таймаутов нулевое значение означает отсутствие ограничения
+    std::chrono::seconds idle_timeout{60};
+    // Предельное время чтения запроса с момента получения первых его байтов
+    std::chrono::seconds read_timeout{15};
+    // Предельное время отправки одного ответа: защищает от клиентов, которые не читают ответы
+    std::chrono::seconds write_timeout{15};
+    // Ограничитель числа сессий, может быть общим для нескольких Listener.
+    // Когда мест нет, Listener перестаёт принимать соединения, и они ждут в очереди ядра.
+    // nullptr — без ограничения
+    std::shared_ptr<SessionLimiter> session_limiter;
+    // Сколько завершившихся сессий Listener хранит для новых соединений. Сессия из пула
+    // сохраняет разогретые буфер чтения, арены и очередь ответов. 0 — сессии не переиспользуются
+    std::size_t session_pool_size = 64;
+    // Счётчики пула сессий, могут быть общими для нескольких Listener. nullptr — у каждого свои
+    std::shared_ptr<SessionPoolStats> session_pool_stats;
+    SessionStyle session_style = SessionStyle::CALLBACKS;
+};
+
+// Таймауты сессии и общее для сессий Listener таймерное колесо, которое их отсчитывает
+struct SessionTimeouts {
+    std::chrono::steady_clock::duration idle{};
+    std::chrono::steady_clock::duration read{};
+    std::chrono::steady_clock::duration write{};
+    // nullptr, если ни один таймаут не задан
+    std::shared_ptr<TimerWheel> wheel;
+};
+
+// Не даёт сессии перемотать арену запроса, пока существует. Сессия передаёт удержание обработчику
+// вместе с запросом: обработчик, который хранит запрос дольше своего вызова (например, в задаче
+// другого потока), хранит и удержание и освобождает его после запроса. Иначе ответ мог бы быть
+// отправлен, а следующий запрос прочитан в ту же арену раньше, чем задача уничтожит свой запрос.
+// Запрос в куче не удерживает ничего. Удерживает сессию. Освободить можно в любом потоке
+class RequestHold {
 public:
-    Listener(net::io_context& ioc, tcp::endpoint endpoint, RequestHandler&& handler);
+    RequestHold() = default;
 
-    // Начать приём входящих соединений
-    void Run();
+    RequestHold(std::shared_ptr<void> session, std::atomic<std::uint32_t>* holds) noexcept
+        : session_(std::move(session))
+        , holds_(holds) {
+    }
+
+    RequestHold(RequestHold&& other) noexcept
+        : session_(std::move(other.session_))
+        , holds_(std::exchange(other.holds_, nullptr)) {
+    }
+
+    RequestHold& operator=(RequestHold&& other) noexcept {
+        if (this != &other) {
+            Release();
+            session_ = std::move(other.session_);
+            holds_ = std::exchange(other.holds_, nullptr);
+        }
+        return *this;
+    }
+
+    ~RequestHold() {
+        Release();
+    }
 
 private:
-    void DoAccept();
-    void OnAccept(beast::error_code ec, tcp::socket socket);
+    void Release() noexcept {
+        if (holds_) {
+            // Запрос уничтожен до освобождения: сессия, увидев ноль, может перематывать арену
+            holds_->fetch_sub(1, std::memory_order_release);
+            holds_ = nullptr;
+        }
+        session_.reset();
+    }
 
-    net::io_context& ioc_;
-    tcp::acceptor acceptor_;
-    RequestHandler handler_; // Хранит копию обработчика для всех сессий
+    std::shared_ptr<void> session_;
+    std::atomic<std::uint32_t>* holds_ = nullptr;
 };
 
-// Обрабатывает HTTP-соединение с сервером
-class Session : public std::enable_shared_from_this<Session> {
+// Сессия, принимающая ответы на свои запросы (см. ResponseSender)
+class ResponseSink {
 public:
-    // Принимает владение сокетом
-    // ИЗМЕНЕНО: Принимаем RequestHandler по значению для упрощения копирования/перемещения
-    explicit Session(tcp::socket&& socket, RequestHandler handler); 
+    // Передаёт в strand сессии ответ на запрос с номером seq
+    virtual void SendResponse(std::uint64_t seq, Response&& res) = 0;
+
+protected:
+    ~ResponseSink() = default;
+};
+
+// Отправляет ответ на один запрос сессии. Хранит только указатель на сессию и номер запроса,
+// поэтому создание и копирование не выделяют память. Можно вызывать из любого потока
+class ResponseSender {
+public:
+    ResponseSender(std::shared_ptr<ResponseSink> session, std::uint64_t seq) noexcept
+        : session_(std::move(session))
+        , seq_(seq) {
+    }
+
+    void operator()(Response&& res) const;
+
+private:
+    std::shared_ptr<ResponseSink> session_;
+    std::uint64_t seq_;
+};
+
+// Обрабатывает HTTP-соединение с сервером. Не зависит от типа обработчика запросов,
+// обработчик вызывается через HandleRequest производного класса Session.
+// Пока сессия ждёт начала следующего запроса, её сокет только ждёт готовности к чтению.
+// Сроки простоя, чтения начатого запроса и отправки ответа отсчитывает общее таймерное
+// колесо Listener: сессия стоит в нём одной записью на ближайший из сроков, отдельных
+// таймеров у сессий нет. Когда срок истекает, сокет закрывается.
+// Поддерживает конвейерную обработку (pipelining): следующий запрос читается и передаётся
+// обработчику, пока ответы на предыдущие ещё формируются или отправляются.
+// Ответы отправляются строго в порядке поступления запросов.
+// Сокет сессии должен быть привязан к strand: чтение и запись идут параллельно.
+// Поля и тела запросов и ответов размещаются в одной из двух арен сессии. Запрос читается
+// в арену, все запросы из которой уже получили отправленные ответы, и арена перед этим
+// перематывается. Если свободной арены нет, запрос размещается в куче.
+// Поэтому обработчик не должен хранить запрос или созданные из него ответы после вызова send,
+// если не хранит вместе с ними удержание арены, переданное с запросом (RequestHold).
+// Завершившуюся сессию можно подготовить к новому соединению (Recycle и Reopen), не теряя
+// выделенной ею памяти.
+class SessionBase : public ResponseSink, public std::enable_shared_from_this<SessionBase>, private TimerWheel::Entry {
+public:
+    SessionBase(const SessionBase&) = delete;
+    SessionBase& operator=(const SessionBase&) = delete;
 
     // Запустить асинхронную операцию
     void Run();
 
+    void SendResponse(std::uint64_t seq, Response&& res) override;
+
+    // Возвращает завершившуюся сессию в исходное состояние для повторного использования:
+    // закрывает сокет, сбрасывает состояние соединения и урезает память, выросшую сверх
+    // обычного. Вызывать, когда на сессию не осталось shared_ptr.
+    // Возвращает разрешение сессии, чтобы вызывающий сам решил, когда освободить место
+    SessionLimiter::Permit Recycle() noexcept;
+
+    // Привязывает сессию, подготовленную Recycle, к новому соединению
+    void Reopen(SessionSocket&& socket, SessionLimiter::Permit&& permit);
+
+protected:
+    // Принимает владение сокетом и разрешением на сессию
+    SessionBase(SessionSocket&& socket, SessionLimiter::Permit&& permit, std::size_t pipeline_limit,
+                SessionTimeouts timeouts);
+    virtual ~SessionBase();
+
+    // Передаёт запрос обработчику. Ответ отправляется вызовом send,
+    // hold удерживает арену запроса, пока обработчик его не освободит
+    virtual void HandleRequest(Request&& req, ResponseSender&& send, RequestHold&& hold) = 0;
+
 private:
+    // Удерживает арену запроса с номером seq. Вызывается в strand сессии
+    RequestHold HoldRequest(std::uint64_t seq);
     void DoRead();
+    // Следующий запрос ещё не начал поступать: сокет готов к чтению или произошла ошибка
+    void OnReadable(beast::error_code ec);
+    void StartRead();
     void OnRead(beast::error_code ec, std::size_t bytes_transferred);
-    void OnWrite(beast::error_code ec, std::size_t bytes_transferred, bool close);
+    // Сохраняет ответ на запрос с номером seq и, если его очередь подошла, отправляет
+    void OnResponse(std::uint64_t seq, Response&& res);
+    void DoWrite();
+    void OnWrite(beast::error_code ec, std::size_t bytes_transferred);
     void DoClose();
+    // Передаёт соединение WebSocket-сессии. Сама сессия после этого завершается
+    void DoUpgrade(WebSocketUpgrade&& upgrade);
+
+    using Clock = std::chrono::steady_clock;
+
+    // Сколько памяти сессия в пуле сохраняет в буфере чтения и в каждой арене
+    static constexpr std::size_t MAX_POOLED_BUFFER_SIZE = 16 * 1024;
+    static constexpr std::size_t POOLED_ARENA_BLOCKS = 1;
+
+    // Срок, отсчитываемый от текущего момента. Нулевой таймаут — срока нет
+    static Clock::time_point DeadlineAfter(Clock::duration timeout);
+    // Задаёт срок ожидания следующего запроса: таймаут простоя, если ответов к отправке нет.
+    // Пока ответы не отправлены, клиент вправе не присылать новых запросов
+    void SetIdleDeadline();
+    // Ставит сессию в таймерное колесо, если ближайший из сроков чтения и записи наступит
+    // раньше, чем колесо сработает для неё. Более поздние сроки не требуют перестановки:
+    // при срабатывании колеса OnDeadline сверит их с текущим временем
+    void UpdateDeadline();
+    // Вызывается таймерным колесом, когда подошло время проверить сроки
+    void OnTimeout() noexcept override;
+    void OnDeadline();
+
+    // Сбрасывает запрос перед чтением следующего и выбирает для него арену,
+    // перематывая её, если размещённые в ней запросы больше не используются
+    void ResetRequest();
+
+    SessionSocket socket_;
+    beast::flat_buffer buffer_;
+    SessionLimiter::Permit permit_;
+    SessionTimeouts timeouts_;
+    // Состояние текущих операций чтения и записи
+    HandlerMemory handler_memory_;
+    static constexpr std::size_t ARENA_COUNT = 2;
+    // Индекс "арены" для запросов, размещённых в куче
+    static constexpr std::size_t HEAP_ARENA = ARENA_COUNT;
+    Arena arenas_[ARENA_COUNT];
+    // Сколько запросов из каждой арены ещё ожидают отправки ответа. Последний элемент - для кучи
+    std::size_t arena_users_[ARENA_COUNT + 1] = {};
+    // Сколько запросов из каждой арены удерживают обработчики (RequestHold). Освобождаются
+    // в других потоках, поэтому отдельно от arena_users_
+    std::atomic<std::uint32_t> arena_holds_[ARENA_COUNT] = {};
+    // Арена, в которую читается текущий запрос
+    std::size_t current_arena_ = HEAP_ARENA;
+    Request req_;
+    // Кольцевая очередь ответов на прочитанные запросы в порядке их поступления.
+    // Ответ на запрос с номером seq хранится в элементе seq % размер. Пустой элемент - ответ ещё не готов
+    std::vector<std::optional<Response>> responses_;
+    // Арена, в которой размещён запрос, соответствующий элементу responses_
+    std::vector<std::uint8_t> response_arenas_;
+    // Порядковый номер запроса, ответ на который стоит в голове очереди
+    std::uint64_t first_seq_ = 0;
+    // Число запросов, ожидающих отправки ответа
+    std::size_t pending_ = 0;
+    bool reading_ = false;
+    // Сессия ждёт начала следующего запроса
+    bool waiting_readable_ = false;
+    bool writing_ = false;
+    // Сроки текущих чтения и записи, time_point::max() — срока нет
+    Clock::time_point read_deadline_ = Clock::time_point::max();
+    Clock::time_point write_deadline_ = Clock::time_point::max();
+    // Когда колесо сработает для сессии, time_point::max() — сессии нет в колесе
+    Clock::time_point wheel_deadline_ = Clock::time_point::max();
+    bool timed_out_ = false;
+    // Больше запросов не будет: клиент закрыл соединение, запрос был без keep-alive или произошла ошибка
+    bool read_closed_ = false;
+};
 
-    tcp::socket socket_;
+// Сессия с обработчиком запросов известного на этапе компиляции типа.
+// Обработчик вызывается как request_handler(Request&&, ResponseSender&&, RequestHold&&) без стирания типа
+template <typename RequestHandler>
+class Session : public SessionBase {
+public:
+    template <typename Handler>
+    Session(SessionSocket&& socket, SessionLimiter::Permit&& permit, Handler&& request_handler,
+            std::size_t pipeline_limit, SessionTimeouts timeouts)
+        : SessionBase(std::move(socket), std::move(permit), pipeline_limit, std::move(timeouts))
+        , request_handler_(std::forward<Handler>(request_handler)) {
+    }
+
+private:
+    void HandleRequest(Request&& req, ResponseSender&& send, RequestHold&& hold) override {
+        request_handler_(std::move(req), std::move(send), std::move(hold));
+    }
+
+    RequestHandler request_handler_;
+};
+
+// Сессия на сопрограмме C++20: альтернатива SessionBase для сравнения.
+// Весь цикл соединения (ожидание запроса, чтение, обработка, отправка ответа) — одна
+// сопрограмма net::awaitable, состояние между шагами живёт в её кадре и в самой сессии,
+// а не захватывается в каждый обработчик. Сопрограмма владеет сессией, поэтому счётчик
+// ссылок меняется только при передаче ResponseSender обработчику — раз на запрос.
+// Кадры сопрограмм Asio размещает в памяти, переиспользуемой в пределах потока,
+// а состояние операций сокета — в слотах памяти сессии, так что в установившемся режиме
+// куча не нужна.
+// Запросы обрабатываются строго по одному: следующий читается после отправки ответа
+// на предыдущий. Конвейерные запросы поддерживаются, но не обрабатываются параллельно.
+// Таймауты, арена запроса и переключение на WebSocket работают так же, как в SessionBase
+class CoroutineSessionBase : public ResponseSink,
+                             public std::enable_shared_from_this<CoroutineSessionBase>,
+                             private TimerWheel::Entry {
+public:
+    CoroutineSessionBase(const CoroutineSessionBase&) = delete;
+    CoroutineSessionBase& operator=(const CoroutineSessionBase&) = delete;
+
+    // Запускает сопрограмму сессии в её strand
+    void Run();
+
+    void SendResponse(std::uint64_t seq, Response&& res) override;
+
+protected:
+    CoroutineSessionBase(SessionSocket&& socket, SessionLimiter::Permit&& permit, SessionTimeouts timeouts);
+    virtual ~CoroutineSessionBase();
+
+    virtual void HandleRequest(Request&& req, ResponseSender&& send, RequestHold&& hold) = 0;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    // Сопрограммы сессии выполняются в её strand, конкретный тип исполнителя
+    // избавляет от any_io_executor
+    template <typename T>
+    using Awaitable = net::awaitable<T, SessionStrand>;
+
+    static Awaitable<void> Serve(std::shared_ptr<CoroutineSessionBase> self);
+    // Читает запросы и отвечает на них, пока соединение не закроется
+    Awaitable<void> Loop();
+    void OnResponse(std::uint64_t seq, Response&& res);
+    // Вызывает обработчик, превращая его исключения в ответ 500
+    void DispatchRequest(std::uint64_t seq);
+    // Удерживает арену текущего запроса
+    RequestHold HoldRequest();
+
+    // Срок текущего шага: ожидания запроса, чтения или отправки. Нулевой таймаут — срока нет.
+    // timeout_message выводится в лог, если срок истечёт, пустое — не выводится
+    void SetDeadline(Clock::duration timeout, std::string_view timeout_message);
+    void ScheduleDeadline();
+    void OnTimeout() noexcept override;
+    void OnDeadline();
+
+    SessionSocket socket_;
     beast::flat_buffer buffer_;
-    http::request<http::string_body> req_;
-    http::response<http::string_body> res_;
-    RequestHandler handler_; // Каждая сессия имеет свою копию (или перемещенный экземпляр) обработчика
+    SessionLimiter::Permit permit_;
+    SessionTimeouts timeouts_;
+    // Состояние текущей операции сокета
+    HandlerMemory handler_memory_;
+    // Запросы обрабатываются по одному, поэтому одной арены достаточно:
+    // она перематывается перед чтением каждого запроса, если прежний запрос не удерживается
+    // обработчиком. Иначе запрос размещается в куче
+    Arena arena_;
+    std::atomic<std::uint32_t> arena_holds_{0};
+    // Текущий запрос размещён в арене
+    bool arena_request_ = false;
+    Request req_;
+    // Номер текущего запроса и ответ на него
+    std::uint64_t seq_ = 0;
+    std::optional<Response> response_;
+    // Возобновляет сопрограмму, ждущую ответа
+    SmallFunction<void()> response_waiter_;
+    Clock::time_point deadline_ = Clock::time_point::max();
+    std::string_view timeout_message_;
+    // Когда колесо сработает для сессии, time_point::max() — сессии нет в колесе
+    Clock::time_point wheel_deadline_ = Clock::time_point::max();
+    bool timed_out_ = false;
+};
+
+// Сессия на сопрограмме с обработчиком запросов известного на этапе компиляции типа
+template <typename RequestHandler>
+class CoroutineSession : public CoroutineSessionBase {
+public:
+    template <typename Handler>
+    CoroutineSession(SessionSocket&& socket, SessionLimiter::Permit&& permit, Handler&& request_handler,
+                     SessionTimeouts timeouts)
+        : CoroutineSessionBase(std::move(socket), std::move(permit), std::move(timeouts))
+        , request_handler_(std::forward<Handler>(request_handler)) {
+    }
+
+private:
+    void HandleRequest(Request&& req, ResponseSender&& send, RequestHold&& hold) override {
+        request_handler_(std::move(req), std::move(send), std::move(hold));
+    }
+
+    RequestHandler request_handler_;
+};
+
+// Открывает акцептор на endpoint и начинает прослушивание.
+// При ошибке выбрасывает std::runtime_error
+tcp::acceptor MakeAcceptor(net::io_context& ioc, const tcp::endpoint& endpoint, const ListenerOptions& options);
+
+// Настраивает принятый сокет перед созданием сессии
+void PrepareSessionSocket(SessionSocket& socket);
+
+// Запускает WebSocket-сессию на соединении, которое передаёт ей HTTP-сессия (см. websocket_session.h)
+void StartWebSocketSession(SessionSocket&& socket, SessionLimiter::Permit&& permit, WebSocketUpgrade&& upgrade);
+
+// Создаёт и запускает таймерное колесо для таймаутов простоя сессий Listener
+SessionTimeouts MakeSessionTimeouts(net::io_context& ioc, const ListenerOptions& options);
+
+// Принимает входящие соединения и запускает сессии.
+// Перед приёмом каждого соединения получает разрешение у ограничителя сессий. Если мест нет,
+// приём приостанавливается до завершения какой-нибудь сессии.
+// Завершившиеся сессии возвращаются в пул Listener и достаются следующим соединениям.
+// В режиме sharded у каждого потока свой Listener, а значит, и свой пул
+template <typename RequestHandler>
+class Listener : public std::enable_shared_from_this<Listener<RequestHandler>> {
+    using SessionType = Session<RequestHandler>;
+    using SessionPool = ObjectPool<SessionType>;
+
+    // Удалитель shared_ptr сессии: вместо уничтожения возвращает сессию в пул
+    class SessionRecycler {
+    public:
+        explicit SessionRecycler(std::shared_ptr<SessionPool> pool) noexcept
+            : pool_(std::move(pool)) {
+        }
+
+        void operator()(SessionType* session) const noexcept {
+            std::unique_ptr<SessionType> owned{session};
+            // Место освобождается после возврата сессии в пул: принятое в ответ
+            // соединение уже сможет её получить
+            auto permit = owned->Recycle();
+            pool_->Put(std::move(owned));
+        }
+
+    private:
+        std::shared_ptr<SessionPool> pool_;
+    };
+
+public:
+    template <typename Handler>
+    Listener(net::io_context& ioc, const tcp::endpoint& endpoint, Handler&& request_handler,
+             const ListenerOptions& options = {})
+        : ioc_(ioc)
+        , acceptor_(MakeAcceptor(ioc, endpoint, options))
+        , request_handler_(std::forward<Handler>(request_handler))
+        , options_(options)
+        , limiter_(options.session_limiter ? options.session_limiter : std::make_shared<SessionLimiter>(0))
+        , timeouts_(MakeSessionTimeouts(ioc, options))
+        , pool_(std::make_shared<SessionPool>(options.session_pool_size, options.session_pool_stats)) {
+    }
+
+    // Начать приём входящих соединений
+    void Run() {
+        DoAccept();
+    }
+
+private:
+    void DoAccept() {
+        if (!permit_) {
+            permit_ = limiter_->TryAcquire([self = this->shared_from_this()] {
+                // Место освободилось в потоке завершившейся сессии, приём продолжаем в потоке Listener
+                net::post(self->ioc_, beast::bind_front_handler(&Listener::DoAccept, self));
+            });
+            if (!permit_) {
+                // Новые соединения подождут в очереди ядра
+                return;
+            }
+        }
+        // Каждая сессия получает свой strand: её чтение и запись могут выполняться одновременно
+        acceptor_.async_accept(net::make_strand(ioc_),
+                               beast::bind_front_handler(&Listener::OnAccept, this->shared_from_this()));
+    }
+
+    void OnAccept(beast::error_code ec, SessionSocket socket) {
+        if (ec) {
+            std::cerr << "Accept error: " << ec.message() << std::endl;
+        } else {
+            PrepareSessionSocket(socket);
+            if (options_.session_style == SessionStyle::COROUTINES) {
+                std::make_shared<CoroutineSession<RequestHandler>>(std::move(socket), std::move(*permit_),
+                                                                   request_handler_, timeouts_)
+                    ->Run();
+            } else {
+                MakeSession(std::move(socket))->Run();
+            }
+            permit_.reset();
+        }
+
+        // Принимаем следующее соединение
+        DoAccept();
+    }
+
+    std::shared_ptr<SessionType> MakeSession(SessionSocket&& socket) {
+        auto session = pool_->Take();
+        if (session) {
+            session->Reopen(std::move(socket), std::move(*permit_));
+        } else {
+            // Каждая сессия получает свою копию обработчика
+            session = std::make_unique<SessionType>(std::move(socket), std::move(*permit_), request_handler_,
+                                                    options_.pipeline_limit, timeouts_);
+        }
+        return {session.release(), SessionRecycler{pool_}};
+    }
+
+    net::io_context& ioc_;
+    tcp::acceptor acceptor_;
+    RequestHandler request_handler_;
+    ListenerOptions options_;
+    std::shared_ptr<SessionLimiter> limiter_;
+    SessionTimeouts timeouts_;
+    // Разрешение для следующего принимаемого соединения
+    std::optional<SessionLimiter::Permit> permit_;
+    std::shared_ptr<SessionPool> pool_;
 };
 
 // Запустить HTTP-сервер
-void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler);
+template <typename RequestHandler>
+void ServeHttp(net::io_context& ioc, const tcp::endpoint& endpoint, RequestHandler&& handler,
+               const ListenerOptions& options = {}) {
+    // При помощи decay_t исключим ссылки из типа RequestHandler,
+    // чтобы Listener хранил RequestHandler по значению
+    using MyListener = Listener<std::decay_t<RequestHandler>>;
+
+    std::make_shared<MyListener>(ioc, endpoint, std::forward<RequestHandler>(handler), options)->Run();
+}
 
 }  // namespace http_server
@@ -0,0 +1,161 @@
+// src/json_writer.h
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace json_writer {
+
+// Потоковая запись JSON: значения дописываются прямо в строку-приёмник, без промежуточного
+// дерева boost::json::value. Запятые и двоеточия расставляет сам писатель, вложенность
+// отслеживать не нужно. Корректность структуры (парность Begin/End, ключи только внутри
+// объектов) — ответственность вызывающего.
+// Приёмник можно сменить между вызовами (SetOutput), поэтому документ можно формировать
+// частями в разные буферы
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) noexcept
+        : out_(&out) {
+    }
+
+    void SetOutput(std::string& out) noexcept {
+        out_ = &out;
+    }
+
+    std::string& GetOutput() const noexcept {
+        return *out_;
+    }
+
+    JsonWriter& BeginObject() {
+        BeforeValue();
+        *out_ += '{';
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& EndObject() {
+        *out_ += '}';
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& BeginArray() {
+        BeforeValue();
+        *out_ += '[';
+        need_comma_ = false;
+        return *this;
+    }
+
+    JsonWriter& EndArray() {
+        *out_ += ']';
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& Key(std::string_view key) {
+        BeforeValue();
+        AppendString(key);
+        *out_ += ':';
+        after_key_ = true;
+        return *this;
+    }
+
+    JsonWriter& String(std::string_view value) {
+        BeforeValue();
+        AppendString(value);
+        need_comma_ = true;
+        return *this;
+    }
+
+    JsonWriter& Int(std::int64_t value) {
+        BeforeValue();
+        char buf[24];
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        out_->append(buf, end);
+        need_comma_ = true;
+        return *this;
+    }
+
+    // Кратчайшая запись, из которой читается то же число. Значение должно быть конечным
+    JsonWriter& Double(double value) {
+        BeforeValue();
+        char buf[32];
+        const auto [end, ec] = std::to_chars(buf, buf + sizeof(buf), value);
+        out_->append(buf, end);
+        need_comma_ = true;
+        return *this;
+    }
+
+    // Пара "ключ": значение внутри объекта
+    JsonWriter& Field(std::string_view key, std::string_view value) {
+        return Key(key).String(value);
+    }
+
+    JsonWriter& Field(std::string_view key, std::int64_t value) {
+        return Key(key).Int(value);
+    }
+
+private:
+    void BeforeValue() {
+        if (after_key_) {
+            after_key_ = false;
+        } else if (need_comma_) {
+            *out_ += ',';
+        }
+    }
+
+    // Строка в кавычках. Участки без спецсимволов дописываются целиком. Экранирование то же,
+    // что у boost::json::serialize: короткие последовательности для \b \f \n \r \t, \u00XX для прочих
+    // управляющих символов
+    void AppendString(std::string_view value) {
+        *out_ += '"';
+        std::size_t run_start = 0;
+        for (std::size_t i = 0; i < value.size(); ++i) {
+            const auto c = static_cast<unsigned char>(value[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') {
+                continue;
+            }
+            out_->append(value.data() + run_start, i - run_start);
+            run_start = i + 1;
+            switch (c) {
+                case '"':
+                    *out_ += "\\\"";
+                    break;
+                case '\\':
+                    *out_ += "\\\\";
+                    break;
+                case '\b':
+                    *out_ += "\\b";
+                    break;
+                case '\f':
+                    *out_ += "\\f";
+                    break;
+                case '\n':
+                    *out_ += "\\n";
+                    break;
+                case '\r':
+                    *out_ += "\\r";
+                    break;
+                case '\t':
+                    *out_ += "\\t";
+                    break;
+                default: {
+                    constexpr std::string_view DIGITS = "0123456789abcdef";
+                    const char escaped[] = {'\\', 'u', '0', '0', DIGITS[c >> 4], DIGITS[c & 0xf]};
+                    out_->append(escaped, sizeof(escaped));
+                }
+            }
+        }
+        out_->append(value.data() + run_start, value.size() - run_start);
+        *out_ += '"';
+    }
+
+    std::string* out_;
+    // Перед следующим значением или ключом нужна запятая
+    bool need_comma_ = false;
+    // Только что записан ключ: следующее значение идёт после двоеточия без запятой
+    bool after_key_ = false;
+};
+
+}  // namespace json_writer
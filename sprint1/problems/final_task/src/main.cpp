@@ -3,17 +3,232 @@
 //
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/signal_set.hpp>
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string_view>
 #include <thread>
+#include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "alloc_counter.h"
+#include "embedded_static.h"
+#include "game_state_json.h"
 #include "json_loader.h"
 #include "request_handler.h"
+#include "tick_engine.h"
 
 using namespace std::literals;
 namespace net = boost::asio;
 
 namespace {
 
+// Режим обслуживания входящих соединений
+enum class ServeMode {
+    // Один io_context на все рабочие потоки и один акцептор
+    SHARED,
+    // По io_context и акцептору (SO_REUSEPORT) на каждое ядро, сессии не мигрируют между потоками
+    SHARDED,
+};
+
+struct Args {
+    std::string config_file;
+    // Каталог статических файлов, пустой — статические файлы не отдаются
+    std::string www_root;
+    ServeMode serve_mode = ServeMode::SHARED;
+    std::size_t pipeline_limit = http_server::ListenerOptions{}.pipeline_limit;
+    std::chrono::seconds idle_timeout = http_server::ListenerOptions{}.idle_timeout;
+    // 0 - без ограничения
+    std::size_t max_sessions = 0;
+    std::size_t session_pool_size = http_server::ListenerOptions{}.session_pool_size;
+    http_server::SessionStyle session_style = http_server::SessionStyle::CALLBACKS;
+    std::size_t map_cache_limit = http_handler::RequestHandlerOptions{}.max_cached_map_size;
+    std::size_t gzip_streams = http_server::DynamicCompressionOptions{}.max_streams;
+    bool coalesce_requests = http_handler::RequestHandlerOptions{}.coalesce_requests;
+    // Обрабатывать запросы в пулах потоков по классам, а не в потоке io_context, прочитавшем запрос:
+    // наплыв запросов статических файлов не задерживает API игры. nullopt — по умолчанию: пулы
+    // в режиме shared, а в режиме sharded запрос обрабатывается на ядре своего шарда
+    std::optional<bool> priority_scheduling;
+    unsigned api_threads = http_server::RequestSchedulerOptions{}.game_api.threads;
+    unsigned static_threads = http_server::RequestSchedulerOptions{}.static_files.threads;
+    // Отклонять запросы ответом 503, когда очередь пула перегружена. Решение принимается по ожиданию
+    // в очереди пула, поэтому работает только с пулами. nullopt — по умолчанию: включено, если есть пулы
+    std::optional<bool> load_shedding;
+    // Период тиков игрового времени в миллисекундах, 0 — время само не идёт
+    std::size_t tick_period_ms = 0;
+    // Потоки движка тиков, 0 — по числу ядер
+    unsigned tick_threads = 0;
+    // Собак, расставляемых на каждой карте при запуске (см. GameSession::SpawnDogs)
+    std::size_t dogs_per_map = 0;
+};
+
+// Разбирает неотрицательное целое число, занимающее всю строку
+std::optional<std::size_t> ParseNumber(std::string_view value) {
+    std::size_t number = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), number);
+    if (ec != std::errc{} || ptr != value.data() + value.size()) {
+        return std::nullopt;
+    }
+    return number;
+}
+
+std::optional<Args> ParseCommandLine(int argc, const char* const argv[]) {
+    constexpr auto SERVE_MODE_OPTION = "--serve-mode="sv;
+    constexpr auto PIPELINE_LIMIT_OPTION = "--pipeline-limit="sv;
+    constexpr auto IDLE_TIMEOUT_OPTION = "--idle-timeout="sv;
+    constexpr auto MAX_SESSIONS_OPTION = "--max-sessions="sv;
+    constexpr auto SESSION_POOL_OPTION = "--session-pool="sv;
+    constexpr auto SESSION_OPTION = "--session="sv;
+    constexpr auto MAP_CACHE_LIMIT_OPTION = "--map-cache-limit="sv;
+    constexpr auto GZIP_STREAMS_OPTION = "--gzip-streams="sv;
+    constexpr auto COALESCE_OPTION = "--coalesce="sv;
+    constexpr auto SCHEDULING_OPTION = "--scheduling="sv;
+    constexpr auto API_THREADS_OPTION = "--api-threads="sv;
+    constexpr auto STATIC_THREADS_OPTION = "--static-threads="sv;
+    constexpr auto LOAD_SHEDDING_OPTION = "--load-shedding="sv;
+    constexpr auto TICK_PERIOD_OPTION = "--tick-period="sv;
+    constexpr auto TICK_THREADS_OPTION = "--tick-threads="sv;
+    constexpr auto DOGS_PER_MAP_OPTION = "--dogs-per-map="sv;
+
+    Args args;
+    bool has_config = false;
+    bool has_www_root = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg.starts_with(SERVE_MODE_OPTION)) {
+            auto mode = arg.substr(SERVE_MODE_OPTION.size());
+            if (mode == "shared"sv) {
+                args.serve_mode = ServeMode::SHARED;
+            } else if (mode == "sharded"sv) {
+                args.serve_mode = ServeMode::SHARDED;
+            } else {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(PIPELINE_LIMIT_OPTION)) {
+            auto limit = ParseNumber(arg.substr(PIPELINE_LIMIT_OPTION.size()));
+            if (!limit || *limit == 0) {
+                return std::nullopt;
+            }
+            args.pipeline_limit = *limit;
+        } else if (arg.starts_with(IDLE_TIMEOUT_OPTION)) {
+            auto seconds = ParseNumber(arg.substr(IDLE_TIMEOUT_OPTION.size()));
+            if (!seconds) {
+                return std::nullopt;
+            }
+            args.idle_timeout = std::chrono::seconds(*seconds);
+        } else if (arg.starts_with(MAX_SESSIONS_OPTION)) {
+            auto max_sessions = ParseNumber(arg.substr(MAX_SESSIONS_OPTION.size()));
+            if (!max_sessions) {
+                return std::nullopt;
+            }
+            args.max_sessions = *max_sessions;
+        } else if (arg.starts_with(SESSION_POOL_OPTION)) {
+            auto pool_size = ParseNumber(arg.substr(SESSION_POOL_OPTION.size()));
+            if (!pool_size) {
+                return std::nullopt;
+            }
+            args.session_pool_size = *pool_size;
+        } else if (arg.starts_with(SESSION_OPTION)) {
+            auto style = arg.substr(SESSION_OPTION.size());
+            if (style == "callbacks"sv) {
+                args.session_style = http_server::SessionStyle::CALLBACKS;
+            } else if (style == "coroutines"sv) {
+                args.session_style = http_server::SessionStyle::COROUTINES;
+            } else {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(MAP_CACHE_LIMIT_OPTION)) {
+            auto limit = ParseNumber(arg.substr(MAP_CACHE_LIMIT_OPTION.size()));
+            if (!limit) {
+                return std::nullopt;
+            }
+            args.map_cache_limit = *limit;
+        } else if (arg.starts_with(GZIP_STREAMS_OPTION)) {
+            auto streams = ParseNumber(arg.substr(GZIP_STREAMS_OPTION.size()));
+            if (!streams) {
+                return std::nullopt;
+            }
+            args.gzip_streams = *streams;
+        } else if (arg.starts_with(COALESCE_OPTION)) {
+            auto coalesce = arg.substr(COALESCE_OPTION.size());
+            if (coalesce == "on"sv) {
+                args.coalesce_requests = true;
+            } else if (coalesce == "off"sv) {
+                args.coalesce_requests = false;
+            } else {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(SCHEDULING_OPTION)) {
+            auto scheduling = arg.substr(SCHEDULING_OPTION.size());
+            if (scheduling == "priority"sv) {
+                args.priority_scheduling = true;
+            } else if (scheduling == "inline"sv) {
+                args.priority_scheduling = false;
+            } else {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(API_THREADS_OPTION)) {
+            auto threads = ParseNumber(arg.substr(API_THREADS_OPTION.size()));
+            if (!threads || *threads == 0) {
+                return std::nullopt;
+            }
+            args.api_threads = static_cast<unsigned>(*threads);
+        } else if (arg.starts_with(STATIC_THREADS_OPTION)) {
+            auto threads = ParseNumber(arg.substr(STATIC_THREADS_OPTION.size()));
+            if (!threads || *threads == 0) {
+                return std::nullopt;
+            }
+            args.static_threads = static_cast<unsigned>(*threads);
+        } else if (arg.starts_with(LOAD_SHEDDING_OPTION)) {
+            auto shedding = arg.substr(LOAD_SHEDDING_OPTION.size());
+            if (shedding == "on"sv) {
+                args.load_shedding = true;
+            } else if (shedding == "off"sv) {
+                args.load_shedding = false;
+            } else {
+                return std::nullopt;
+            }
+        } else if (arg.starts_with(TICK_PERIOD_OPTION)) {
+            auto period = ParseNumber(arg.substr(TICK_PERIOD_OPTION.size()));
+            if (!period) {
+                return std::nullopt;
+            }
+            args.tick_period_ms = *period;
+        } else if (arg.starts_with(TICK_THREADS_OPTION)) {
+            auto threads = ParseNumber(arg.substr(TICK_THREADS_OPTION.size()));
+            if (!threads || *threads == 0) {
+                return std::nullopt;
+            }
+            args.tick_threads = static_cast<unsigned>(*threads);
+        } else if (arg.starts_with(DOGS_PER_MAP_OPTION)) {
+            auto dogs = ParseNumber(arg.substr(DOGS_PER_MAP_OPTION.size()));
+            if (!dogs) {
+                return std::nullopt;
+            }
+            args.dogs_per_map = *dogs;
+        } else if (!has_config && !arg.starts_with("--"sv)) {
+            args.config_file = arg;
+            has_config = true;
+        } else if (!has_www_root && !arg.starts_with("--"sv)) {
+            args.www_root = arg;
+            has_www_root = true;
+        } else {
+            return std::nullopt;
+        }
+    }
+    if (!has_config) {
+        return std::nullopt;
+    }
+    return args;
+}
+
 // Запускает функцию fn на n потоках, включая текущий
 template <typename Fn>
 void RunWorkers(unsigned n, const Fn& fn) {
@@ -27,47 +242,233 @@ void RunWorkers(unsigned n, const Fn& fn) {
     fn();
 }
 
+// Привязывает текущий поток к ядру с номером core. Там, где это не поддерживается, ничего не делает
+void PinCurrentThreadToCore(unsigned core) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(core % CPU_SETSIZE, &cpu_set);
+    if (int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set); err != 0) {
+        std::cerr << "Failed to pin thread to core " << core << ": error " << err << std::endl;
+    }
+#else
+    boost::ignore_unused(core);
+#endif
+}
+
+// Запускает по потоку на каждый io_context, i-й поток привязывается к i-му ядру
+void RunShards(const std::vector<std::unique_ptr<net::io_context>>& shards) {
+    std::vector<std::jthread> workers;
+    workers.reserve(shards.size() - 1);
+    for (unsigned i = 1; i < shards.size(); ++i) {
+        workers.emplace_back([i, &ioc = *shards[i]] {
+            PinCurrentThreadToCore(i);
+            ioc.run();
+        });
+    }
+    PinCurrentThreadToCore(0);
+    shards.front()->run();
+}
+
 }  // namespace
 
 int main(int argc, const char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: game_server <game-config-json>"sv << std::endl;
+    auto args = ParseCommandLine(argc, argv);
+    if (!args) {
+        std::cerr << "Usage: game_server <game-config-json> [static-files-root] [--serve-mode=shared|sharded]"
+                     " [--pipeline-limit=N]"
+                     " [--idle-timeout=SECONDS] [--max-sessions=N] [--session-pool=N]"
+                     " [--session=callbacks|coroutines] [--map-cache-limit=BYTES] [--gzip-streams=N]"
+                     " [--coalesce=on|off] [--scheduling=priority|inline] [--api-threads=N] [--static-threads=N]"
+                     " [--load-shedding=on|off] [--tick-period=MILLISECONDS] [--tick-threads=N]"
+                     " [--dogs-per-map=N]"sv
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (!args->priority_scheduling) {
+        args->priority_scheduling = args->serve_mode != ServeMode::SHARDED;
+    }
+    if (args->load_shedding.value_or(false) && !*args->priority_scheduling) {
+        std::cerr << "--load-shedding=on requires --scheduling=priority: requests are shed by their wait"
+                     " in the pool queues"sv
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (args->dogs_per_map != 0 && args->tick_period_ms == 0) {
+        std::cerr << "--dogs-per-map requires --tick-period: without game time there are no game sessions"sv
+                  << std::endl;
         return EXIT_FAILURE;
     }
     try {
         // 1. Загружаем карту из файла и построить модель игры
-        model::Game game = json_loader::LoadGame(argv[1]);
+        model::Game game = json_loader::LoadGame(args->config_file);
 
-        // 2. Инициализируем io_context
-        const unsigned num_threads = std::thread::hardware_concurrency();
-        net::io_context ioc(num_threads);
+        // По игровому сеансу на карту. Если задан период тиков, время в сеансах идёт само
+        std::vector<std::unique_ptr<model::GameSession>> sessions;
+        // Состояние после каждого тика рассылается подписчикам WebSocket
+        auto state_channel = std::make_shared<http_server::BroadcastChannel>();
+        std::optional<model::TickEngine> tick_engine;
+        if (args->tick_period_ms != 0) {
+            std::vector<model::GameSession*> ticked_sessions;
+            // Игроков, которые добавляли бы собак в запущенные сеансы, пока нет: собаки расставляются
+            // до запуска движка, пока сеансами можно пользоваться
+            std::mt19937_64 random{std::random_device{}()};
+            for (const auto& map : game.GetMaps()) {
+                auto& session = *sessions.emplace_back(std::make_unique<model::GameSession>(map));
+                session.SpawnDogs(args->dogs_per_map, random);
+                ticked_sessions.push_back(&session);
+            }
+            model::TickEngineOptions tick_options;
+            tick_options.period = std::chrono::milliseconds(args->tick_period_ms);
+            tick_options.threads =
+                args->tick_threads != 0 ? args->tick_threads : std::max(1u, std::thread::hardware_concurrency());
+            tick_options.on_tick = [state_channel](const model::GameState& state) {
+                http_handler::PublishGameState(*state_channel, state);
+            };
+            tick_engine.emplace(std::move(ticked_sessions), tick_options);
+            tick_engine->Start();
+        }
 
-        // 3. Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
-        net::signal_set signals(ioc, SIGINT, SIGTERM);
-        signals.async_wait([&ioc](const boost::system::error_code& ec, int signal_number) {
-            if (!ec) {
-                ioc.stop();
+        // 2. Создаём обработчик HTTP-запросов и связываем его с моделью игры
+        http_handler::RequestHandlerOptions handler_options;
+        handler_options.max_cached_map_size = args->map_cache_limit;
+        handler_options.dynamic_compression.max_streams = args->gzip_streams;
+        handler_options.coalesce_requests = args->coalesce_requests;
+        // Шард объединяет только свои запросы и не делит блокировку таблицы с другими ядрами
+        handler_options.coalesce_per_thread = args->serve_mode == ServeMode::SHARDED;
+        if (tick_engine) {
+            handler_options.game_states = &tick_engine->GetStates();
+            handler_options.state_channel = state_channel;
+        }
+        if (*args->priority_scheduling) {
+            http_server::RequestSchedulerOptions scheduling;
+            scheduling.game_api.threads = args->api_threads;
+            scheduling.static_files.threads = args->static_threads;
+            if (!args->load_shedding.value_or(true)) {
+                scheduling.game_api.shedding_interval = {};
+                scheduling.static_files.shedding_interval = {};
             }
-        });
+            handler_options.scheduling = scheduling;
+        }
+        if (!args->www_root.empty()) {
+            // Каталог на диске заменяет встроенные файлы: удобно при разработке клиента
+            handler_options.static_files = http_handler::StaticFilesOptions{.root = args->www_root};
+        } else if (http_handler::GetEmbeddedFileCount() != 0) {
+            handler_options.static_files = http_handler::StaticFilesOptions{};
+        }
+        http_handler::RequestHandler handler{game, std::move(handler_options)};
+        auto handle_request = [&handler](auto&& req, auto&& send, auto&& hold) {
+            handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send),
+                    std::forward<decltype(hold)>(hold));
+        };
 
-        // 4. Создаём обработчик HTTP-запросов и связываем его с моделью игры
-        http_handler::RequestHandler handler{game};
+        http_server::ListenerOptions listener_options;
+        listener_options.pipeline_limit = args->pipeline_limit;
+        listener_options.idle_timeout = args->idle_timeout;
+        if (args->max_sessions != 0) {
+            // Ограничение общее для всех акцепторов, в том числе для всех шардов
+            listener_options.session_limiter = std::make_shared<http_server::SessionLimiter>(args->max_sessions);
+        }
+        // В режиме sharded пул у каждого шарда свой, а статистика общая
+        listener_options.session_pool_size = args->session_pool_size;
+        listener_options.session_pool_stats = std::make_shared<http_server::SessionPoolStats>();
+        listener_options.session_style = args->session_style;
 
-        // 5. Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
+        const unsigned num_threads = std::max(1u, std::thread::hardware_concurrency());
         const auto address = net::ip::make_address("0.0.0.0");
         constexpr net::ip::port_type port = 8080;
-        http_server::ServeHttp(ioc, {address, port}, [&handler](auto&& req, auto&& send) {
-            handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send));
-        });
 
-        // 6. Запускаем обработку асинхронных операций
-        // ИЗМЕНЕНО: Сообщение о старте сервера для тестов
-        std::cout << "Server has started..."sv << std::endl;
-        RunWorkers(num_threads, [&ioc] {
-            ioc.run();
-        });
+        if (args->serve_mode == ServeMode::SHARDED) {
+            // 3. Создаём по однопоточному io_context на ядро. У каждого свой акцептор на общем порту
+            std::vector<std::unique_ptr<net::io_context>> shards;
+            shards.reserve(num_threads);
+            listener_options.reuse_port = true;
+            for (unsigned i = 0; i < num_threads; ++i) {
+                auto& ioc = *shards.emplace_back(std::make_unique<net::io_context>(1));
+                http_server::ServeHttp(ioc, {address, port}, handle_request, listener_options);
+            }
+
+            // 4. Сигнал SIGINT или SIGTERM останавливает все шарды
+            net::signal_set signals(*shards.front(), SIGINT, SIGTERM);
+            signals.async_wait([&shards](const boost::system::error_code& ec, int /*signal_number*/) {
+                if (!ec) {
+                    for (auto& ioc : shards) {
+                        ioc->stop();
+                    }
+                }
+            });
+
+            std::cout << "Server has started..."sv << std::endl;
+            RunShards(shards);
+            handler.StopScheduling();
+        } else {
+            // 3. Инициализируем io_context
+            net::io_context ioc(num_threads);
+
+            // 4. Добавляем асинхронный обработчик сигналов SIGINT и SIGTERM
+            net::signal_set signals(ioc, SIGINT, SIGTERM);
+            signals.async_wait([&ioc](const boost::system::error_code& ec, int /*signal_number*/) {
+                if (!ec) {
+                    ioc.stop();
+                }
+            });
+
+            // 5. Запустить обработчик HTTP-запросов, делегируя их обработчику запросов
+            http_server::ServeHttp(ioc, {address, port}, handle_request, listener_options);
+
+            // 6. Запускаем обработку асинхронных операций
+            // ИЗМЕНЕНО: Сообщение о старте сервера для тестов
+            std::cout << "Server has started..."sv << std::endl;
+            RunWorkers(num_threads, [&ioc] {
+                ioc.run();
+            });
+            handler.StopScheduling();
+        }
+
+        if (tick_engine) {
+            tick_engine->Stop();
+        }
 
         std::cout << "server exited" << std::endl;
+        const auto& pool_stats = *listener_options.session_pool_stats;
+        std::cout << "session pool: hits "sv << pool_stats.hits << ", misses "sv << pool_stats.misses
+                  << ", hit rate "sv << pool_stats.GetHitRate() * 100 << "%, returned "sv << pool_stats.returns
+                  << ", dropped "sv << pool_stats.drops << std::endl;
+        const auto& compression_budget = handler.GetCompressionBudget();
+        std::cout << "on-the-fly gzip: permits granted "sv << compression_budget.GetGrantedCount()
+                  << ", refused over budget "sv << compression_budget.GetSkippedCount() << std::endl;
+        const auto& coalescing_stats = handler.GetCoalescingStats();
+        std::cout << "request coalescing: computed "sv << coalescing_stats.leaders << ", shared "sv
+                  << coalescing_stats.followers << ", coalescing ratio "sv
+                  << coalescing_stats.GetCoalescingRatio() * 100 << '%' << std::endl;
+        if (const auto* scheduler = handler.GetScheduler()) {
+            for (auto request_class : {http_server::RequestClass::GAME_API, http_server::RequestClass::STATIC}) {
+                const auto& queue_stats = scheduler->GetStats(request_class);
+                const auto budget = std::chrono::duration<double, std::milli>(
+                    scheduler->GetOptions(request_class).latency_budget);
+                std::cout << http_server::GetRequestClassName(request_class) << " queue: requests "sv
+                          << queue_stats.requests << ", average wait "sv << queue_stats.GetAverageMs()
+                          << " ms, max wait "sv << queue_stats.GetMaxMs() << " ms, over "sv << budget.count()
+                          << " ms budget "sv << queue_stats.over_budget << ", shed with 503 "sv
+                          << queue_stats.shed << std::endl;
+            }
+        }
+        if (tick_engine) {
+            const auto& tick_stats = tick_engine->GetStats();
+            std::cout << "game ticks: "sv << tick_stats.duration.ticks << ", average "sv
+                      << tick_stats.duration.GetAverageMs() << " ms, max "sv << tick_stats.duration.GetMaxMs()
+                      << " ms, over period "sv << tick_stats.overruns << ", skipped "sv << tick_stats.skipped
+                      << std::endl;
+            for (std::size_t i = 0; i < sessions.size(); ++i) {
+                const auto& session_stats = tick_engine->GetSessionStats(i);
+                std::cout << "  map "sv << *sessions[i]->GetMap().GetId() << ": average tick "sv
+                          << session_stats.GetAverageMs() << " ms, max "sv << session_stats.GetMaxMs() << " ms"sv
+                          << std::endl;
+            }
+        }
+        if (alloc_counter::IsEnabled()) {
+            std::cout << "heap allocations: "sv << alloc_counter::GetTotalAllocations() << std::endl;
+        }
     } catch (const std::exception& ex) {
         std::cerr << ex.what() << std::endl;
         return EXIT_FAILURE;
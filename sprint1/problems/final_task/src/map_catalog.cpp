@@ -0,0 +1,65 @@
+// src/map_catalog.cpp
+#include "map_catalog.h"
+
+#include "etag.h"
+#include "gzip.h"
+#include "map_json.h"
+
+namespace http_handler {
+
+namespace http = boost::beast::http;
+
+MapCatalog::MapCatalog(const model::Game& game, std::size_t max_cached_size) {
+    std::string body;
+    json_writer::JsonWriter writer{body};
+    WriteMapList(writer, game.GetMaps());
+    map_list_ = MakeEntry(std::move(body), true);
+
+    for (const auto& map : game.GetMaps()) {
+        std::string map_body;
+        json_writer::JsonWriter map_writer{map_body};
+        WriteMap(map_writer, map);
+        const bool keep_body = map_body.size() <= max_cached_size;
+        auto& entry = maps_[*map.GetId()] = MakeEntry(std::move(map_body), keep_body);
+        if (!keep_body) {
+            entry.map = &map;
+        }
+    }
+}
+
+MapCatalog::Entry MapCatalog::MakeEntry(std::string body, bool keep_body) {
+    Entry entry;
+    entry.etag = http_server::MakeStrongETag(body);
+    entry.gzip_etag = entry.etag;
+    entry.gzip_etag.insert(entry.gzip_etag.size() - 1, "-gzip");
+    entry.size = body.size();
+
+    http::response_header<> header;
+    header.result(http::status::ok);
+    header.set(http::field::content_type, "application/json");
+    header.set(http::field::vary, "Accept-Encoding");
+    header.set(http::field::etag, entry.etag);
+    if (keep_body) {
+        if (auto gzip = http_server::GzipCompress(body, GZIP_LEVEL);
+            http_server::IsWorthCompressing(body.size(), gzip.size())) {
+            header.set(http::field::etag, entry.gzip_etag);
+            header.set(http::field::content_encoding, "gzip");
+            entry.gzip_ok = std::make_shared<const http_server::PreparedResponse>(
+                header, http_server::MakeSharedBuffer(std::move(gzip)));
+            header.erase(http::field::content_encoding);
+            header.set(http::field::etag, entry.etag);
+        }
+        entry.ok = std::make_shared<const http_server::PreparedResponse>(
+            header, http_server::MakeSharedBuffer(std::move(body)));
+    }
+
+    // 304 повторяет ETag, а Content-Type не нужен: тела нет (RFC 9110, 15.4.5)
+    header.result(http::status::not_modified);
+    header.erase(http::field::content_type);
+    entry.not_modified = std::make_shared<const http_server::PreparedResponse>(header, nullptr);
+    header.set(http::field::etag, entry.gzip_etag);
+    entry.gzip_not_modified = std::make_shared<const http_server::PreparedResponse>(header, nullptr);
+    return entry;
+}
+
+}  // namespace http_handler
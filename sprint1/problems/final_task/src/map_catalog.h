@@ -0,0 +1,83 @@
+// src/map_catalog.h
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "model.h"
+#include "shared_body.h"
+
+namespace http_handler {
+
+// Сериализованные ответы API карт. Карты не меняются после загрузки игры, поэтому
+// каждое тело сериализуется один раз при создании каталога, а ответы на запросы
+// только ссылаются на готовые байты. Каталог неизменяем, его можно читать из любых потоков
+class MapCatalog {
+public:
+    static constexpr std::size_t UNLIMITED = std::numeric_limits<std::size_t>::max();
+
+    // Готовый ответ на GET: 200 с телом и ETag и 304 с тем же ETag без тела.
+    // Для клиентов, принимающих Content-Encoding: gzip, есть сжатый вариант со своим ETag.
+    // Все ответы содержат Vary: Accept-Encoding
+    struct Entry {
+        // Сильный ETag несжатого тела, в кавычках
+        std::string etag;
+        // ETag сжатого варианта: ETag несжатого тела с суффиксом "-gzip". Сжатые байты однозначно
+        // определяются несжатыми, поэтому тег остаётся сильным и для тела, сжимаемого на лету
+        std::string gzip_etag;
+        // Размер несжатого тела
+        std::uint64_t size = 0;
+        // nullptr, если тело больше предела каталога: тогда ответ формируется по частям
+        // из map при каждом запросе (см. MapJsonStream) и сжимается на лету, если есть бюджет
+        http_server::PreparedResponsePtr ok;
+        http_server::PreparedResponsePtr not_modified;
+        // Сжатый вариант. gzip_ok равен nullptr, если тело не хранится или сжатие почти
+        // не уменьшает его
+        http_server::PreparedResponsePtr gzip_ok;
+        http_server::PreparedResponsePtr gzip_not_modified;
+        const model::Map* map = nullptr;
+    };
+
+    // Степень сжатия вариантов, хранящихся в каталоге: они сжимаются один раз, поэтому максимальная
+    static constexpr int GZIP_LEVEL = 9;
+
+    // Тела карт длиннее max_cached_size байт не хранятся: при запросе они сериализуются заново
+    // и отправляются по частям. ETag для них вычисляется при создании каталога.
+    // Такие записи ссылаются на карты game, поэтому модель должна пережить каталог
+    explicit MapCatalog(const model::Game& game, std::size_t max_cached_size = UNLIMITED);
+
+    MapCatalog(const MapCatalog&) = delete;
+    MapCatalog& operator=(const MapCatalog&) = delete;
+
+    // Ответ на /api/v1/maps
+    const Entry& GetMapList() const noexcept {
+        return map_list_;
+    }
+
+    // Ответ на /api/v1/maps/:id или nullptr, если карты нет
+    const Entry* FindMap(std::string_view id) const noexcept {
+        auto it = maps_.find(id);
+        return it != maps_.end() ? &it->second : nullptr;
+    }
+
+private:
+    // Хеш с поиском по string_view без создания std::string
+    struct IdHasher {
+        using is_transparent = void;
+
+        std::size_t operator()(std::string_view id) const noexcept {
+            return std::hash<std::string_view>{}(id);
+        }
+    };
+
+    static Entry MakeEntry(std::string body, bool keep_body);
+
+    Entry map_list_;
+    std::unordered_map<std::string, Entry, IdHasher, std::equal_to<>> maps_;
+};
+
+}  // namespace http_handler
@@ -0,0 +1,114 @@
+// src/map_json.cpp
+#include "map_json.h"
+
+#include <limits>
+
+namespace http_handler {
+
+namespace {
+
+void WriteRoad(json_writer::JsonWriter& writer, const model::Road& road) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    writer.BeginObject().Field("x0", start.x).Field("y0", start.y);
+    if (road.IsHorizontal()) {
+        writer.Field("x1", end.x);
+    } else {
+        writer.Field("y1", end.y);
+    }
+    writer.EndObject();
+}
+
+void WriteBuilding(json_writer::JsonWriter& writer, const model::Building& building) {
+    const auto& bounds = building.GetBounds();
+    writer.BeginObject()
+        .Field("x", bounds.position.x)
+        .Field("y", bounds.position.y)
+        .Field("w", bounds.size.width)
+        .Field("h", bounds.size.height)
+        .EndObject();
+}
+
+void WriteOffice(json_writer::JsonWriter& writer, const model::Office& office) {
+    const auto pos = office.GetPosition();
+    const auto offset = office.GetOffset();
+    writer.BeginObject()
+        .Field("id", *office.GetId())
+        .Field("x", pos.x)
+        .Field("y", pos.y)
+        .Field("offsetX", offset.dx)
+        .Field("offsetY", offset.dy)
+        .EndObject();
+}
+
+}  // namespace
+
+void WriteMapList(json_writer::JsonWriter& writer, const model::Game::Maps& maps) {
+    writer.BeginArray();
+    for (const auto& map : maps) {
+        writer.BeginObject().Field("id", *map.GetId()).Field("name", map.GetName()).EndObject();
+    }
+    writer.EndArray();
+}
+
+void WriteMap(json_writer::JsonWriter& writer, const model::Map& map) {
+    // Пошаговая сериализация одной частью неограниченного размера
+    MapJsonStream stream{map, std::numeric_limits<std::size_t>::max()};
+    while (stream.Next(writer.GetOutput())) {
+    }
+}
+
+bool MapJsonStream::Next(std::string& buffer) {
+    writer_.SetOutput(buffer);
+    const auto limit = buffer.size() > std::numeric_limits<std::size_t>::max() - chunk_size_
+                           ? std::numeric_limits<std::size_t>::max()
+                           : buffer.size() + chunk_size_;
+
+    // Дописывает элементы массива items, начиная с index_, пока часть не заполнится.
+    // Возвращает true, если массив записан до конца
+    auto write_items = [&](const auto& items, auto write_item) {
+        for (; index_ < items.size() && buffer.size() < limit; ++index_) {
+            write_item(writer_, items[index_]);
+        }
+        if (index_ < items.size()) {
+            return false;
+        }
+        writer_.EndArray();
+        index_ = 0;
+        return true;
+    };
+
+    switch (stage_) {
+        case Stage::HEADER:
+            writer_.BeginObject().Field("id", *map_.GetId()).Field("name", map_.GetName());
+            writer_.Key("roads").BeginArray();
+            stage_ = Stage::ROADS;
+            [[fallthrough]];
+        case Stage::ROADS:
+            if (!write_items(map_.GetRoads(), WriteRoad)) {
+                return true;
+            }
+            writer_.Key("buildings").BeginArray();
+            stage_ = Stage::BUILDINGS;
+            [[fallthrough]];
+        case Stage::BUILDINGS:
+            if (!write_items(map_.GetBuildings(), WriteBuilding)) {
+                return true;
+            }
+            writer_.Key("offices").BeginArray();
+            stage_ = Stage::OFFICES;
+            [[fallthrough]];
+        case Stage::OFFICES:
+            if (!write_items(map_.GetOffices(), WriteOffice)) {
+                return true;
+            }
+            writer_.EndObject();
+            stage_ = Stage::DONE;
+            [[fallthrough]];
+        case Stage::DONE:
+            break;
+    }
+    return false;
+}
+
+}  // namespace http_handler
@@ -0,0 +1,52 @@
+// src/map_json.h
+#pragma once
+#include <cstddef>
+#include <string>
+
+#include "json_writer.h"
+#include "model.h"
+#include "shared_body.h"
+
+namespace http_handler {
+
+// Список карт для /api/v1/maps: [{"id": ..., "name": ...}, ...]
+void WriteMapList(json_writer::JsonWriter& writer, const model::Game::Maps& maps);
+
+// Карта целиком для /api/v1/maps/:id
+void WriteMap(json_writer::JsonWriter& writer, const model::Map& map);
+
+// Пошаговая сериализация карты: каждый вызов Next дописывает очередную часть JSON размером
+// примерно chunk_size байт. Байты совпадают с результатом WriteMap. Карта должна жить,
+// пока поток не закончится
+class MapJsonStream final : public http_server::BodyStream {
+public:
+    static constexpr std::size_t DEFAULT_CHUNK_SIZE = 16 * 1024;
+
+    explicit MapJsonStream(const model::Map& map, std::size_t chunk_size = DEFAULT_CHUNK_SIZE) noexcept
+        : map_(map)
+        , chunk_size_(chunk_size)
+        , writer_(placeholder_) {
+    }
+
+    bool Next(std::string& buffer) override;
+
+private:
+    enum class Stage {
+        HEADER,
+        ROADS,
+        BUILDINGS,
+        OFFICES,
+        DONE,
+    };
+
+    const model::Map& map_;
+    std::size_t chunk_size_;
+    // Приёмник писателя до первого вызова Next
+    std::string placeholder_;
+    json_writer::JsonWriter writer_;
+    Stage stage_ = Stage::HEADER;
+    // Номер следующего элемента текущего массива
+    std::size_t index_ = 0;
+};
+
+}  // namespace http_handler
@@ -1,4 +1,6 @@
 #include "model.h"
+#include "road_graph.h"
+#include "road_index.h"
 
 #include <stdexcept>
 #include <iostream>
@@ -18,11 +20,18 @@ void Map::AddOffice(Office office) {
     warehouse_id_to_index_[id] = index;
 }
 
+void Map::Compile() {
+    road_index_ = std::make_shared<const RoadIndex>(roads_);
+    road_graph_ = std::make_shared<const RoadGraph>(roads_);
+}
+
 void Game::AddMap(Map map) {
     const auto id = map.GetId();
     if (map_id_to_index_.contains(id)) {
         throw std::invalid_argument("Duplicate map");
     }
+    // Карта в игре больше не меняется: индекс и граф дорог строятся один раз при загрузке
+    map.Compile();
     const size_t index = maps_.size();
     maps_.push_back(std::move(map));
     map_id_to_index_[id] = index;
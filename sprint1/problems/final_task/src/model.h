@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +31,24 @@ struct Offset {
     Dimension dx, dy;
 };
 
+// Положение на карте. В отличие от Point, не обязательно в узле целочисленной сетки
+struct Position {
+    double x, y;
+};
+
+// Скорость в единицах карты в секунду
+struct Speed {
+    double vx, vy;
+};
+
+// Направление движения. Ось y направлена вниз: на север y уменьшается
+enum class Direction : char {
+    NORTH,
+    SOUTH,
+    WEST,
+    EAST,
+};
+
 class Road {
     struct HorizontalTag {
         explicit HorizontalTag() = default;
@@ -116,6 +135,9 @@ private:
     Offset offset_;
 };
 
+class RoadIndex;
+class RoadGraph;
+
 class Map {
 public:
     using Id = util::Tagged<std::string, Map>;
@@ -148,6 +170,20 @@ public:
         return offices_;
     }
 
+    // Пространственный индекс дорог (см. RoadIndex). Есть после Compile
+    const RoadIndex& GetRoadIndex() const noexcept {
+        return *road_index_;
+    }
+
+    // Граф дорог: перекрёстки и участки дорог между ними (см. RoadGraph). Есть после Compile
+    const RoadGraph& GetRoadGraph() const noexcept {
+        return *road_graph_;
+    }
+
+    // Строит по текущему набору дорог индекс и граф. Дороги, добавленные позже, в них не попадут.
+    // Game::AddMap делает это сам. Копии карты делят одни и те же индекс и граф
+    void Compile();
+
     void AddRoad(const Road& road) {
         roads_.emplace_back(road);
     }
@@ -164,6 +200,8 @@ private:
     Id id_;
     std::string name_;
     Roads roads_;
+    std::shared_ptr<const RoadIndex> road_index_;
+    std::shared_ptr<const RoadGraph> road_graph_;
     Buildings buildings_;
 
     OfficeIdToIndex warehouse_id_to_index_;
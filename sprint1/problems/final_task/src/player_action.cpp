@@ -0,0 +1,56 @@
+// src/player_action.cpp
+#include "player_action.h"
+
+#include <boost/json.hpp>
+
+namespace http_handler {
+
+namespace json = boost::json;
+
+std::optional<PlayerAction> ParsePlayerAction(std::string_view body) {
+    PlayerAction action;
+    switch (detail::ParsePlayerActionFast(body, action)) {
+        case detail::FastParseResult::OK:
+            return action;
+        case detail::FastParseResult::INVALID:
+            return std::nullopt;
+        case detail::FastParseResult::UNSUPPORTED:
+            break;
+    }
+    return detail::ParsePlayerActionDom(body);
+}
+
+namespace detail {
+
+std::optional<PlayerAction> ParsePlayerActionDom(std::string_view body) {
+    // Дерево живёт только до конца функции: память берётся из буфера на стеке,
+    // куча нужна лишь для необычно больших тел
+    unsigned char buffer[1024];
+    json::monotonic_resource resource{buffer, sizeof(buffer)};
+    json::error_code ec;
+    const auto value = json::parse(json::string_view{body.data(), body.size()}, ec, &resource);
+    if (ec) {
+        return std::nullopt;
+    }
+    const auto* object = value.if_object();
+    if (!object) {
+        return std::nullopt;
+    }
+    const auto it = object->find("move");
+    if (it == object->end()) {
+        return std::nullopt;
+    }
+    const auto* move = it->value().if_string();
+    if (!move) {
+        return std::nullopt;
+    }
+    const auto direction = ParseMoveDirection(std::string_view(move->data(), move->size()));
+    if (!direction) {
+        return std::nullopt;
+    }
+    return PlayerAction{.move = *direction};
+}
+
+}  // namespace detail
+
+}  // namespace http_handler
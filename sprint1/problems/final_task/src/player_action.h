@@ -0,0 +1,100 @@
+// src/player_action.h
+#pragma once
+#include <optional>
+#include <string_view>
+
+namespace http_handler {
+
+// Направление движения из тела запроса /api/v1/game/player/action
+enum class MoveDirection : char {
+    LEFT = 'L',
+    RIGHT = 'R',
+    UP = 'U',
+    DOWN = 'D',
+    // Пустая строка: игрок останавливается
+    STOP = '\0',
+};
+
+// Действие игрока: {"move": "L"}. Значение move — "L", "R", "U", "D" или пустая строка
+struct PlayerAction {
+    MoveDirection move = MoveDirection::STOP;
+};
+
+// Направление по значению поля move, nullopt — недопустимое значение
+constexpr std::optional<MoveDirection> ParseMoveDirection(std::string_view value) noexcept {
+    if (value.empty()) {
+        return MoveDirection::STOP;
+    }
+    if (value.size() == 1 && (value[0] == 'L' || value[0] == 'R' || value[0] == 'U' || value[0] == 'D')) {
+        return static_cast<MoveDirection>(value[0]);
+    }
+    return std::nullopt;
+}
+
+// Разбирает и проверяет тело действия игрока. Возвращает nullopt, если тело не является JSON-объектом
+// со строковым полем move одного из допустимых значений.
+// Обычные тела, которые отправляет клиент, разбираются без выделения памяти и без построения
+// дерева JSON (см. detail::ParsePlayerActionFast). Остальные (экранированные символы, другие поля,
+// повторы полей) проверяются полным разбором boost::json, результат тот же
+std::optional<PlayerAction> ParsePlayerAction(std::string_view body);
+
+namespace detail {
+
+enum class FastParseResult {
+    OK,
+    // Тело точно не соответствует схеме
+    INVALID,
+    // Тело не в канонической форме: решает полный разбор
+    UNSUPPORTED,
+};
+
+// Разбор канонической формы { "move" : "<значение>" } с пробелами JSON между лексемами.
+// Строки без экранирования сравниваются побайтно на месте, память не выделяется
+constexpr FastParseResult ParsePlayerActionFast(std::string_view body, PlayerAction& action) noexcept {
+    std::size_t pos = 0;
+    auto skip_spaces = [&] {
+        while (pos < body.size()
+               && (body[pos] == ' ' || body[pos] == '\t' || body[pos] == '\n' || body[pos] == '\r')) {
+            ++pos;
+        }
+    };
+    auto consume = [&](std::string_view token) {
+        skip_spaces();
+        if (body.substr(pos, token.size()) != token) {
+            return false;
+        }
+        pos += token.size();
+        return true;
+    };
+
+    if (!consume("{") || !consume("\"move\"") || !consume(":") || !consume("\"")) {
+        return FastParseResult::UNSUPPORTED;
+    }
+    const auto value_end = body.find_first_of("\"\\", pos);
+    if (value_end == std::string_view::npos || body[value_end] == '\\') {
+        return FastParseResult::UNSUPPORTED;
+    }
+    const auto value = body.substr(pos, value_end - pos);
+    pos = value_end + 1;
+    if (!consume("}")) {
+        return FastParseResult::UNSUPPORTED;
+    }
+    skip_spaces();
+    if (pos != body.size()) {
+        return FastParseResult::UNSUPPORTED;
+    }
+
+    const auto move = ParseMoveDirection(value);
+    if (!move) {
+        return FastParseResult::INVALID;
+    }
+    action.move = *move;
+    return FastParseResult::OK;
+}
+
+// Проверка через дерево boost::json. Небольшие тела разбираются в буфер на стеке
+std::optional<PlayerAction> ParsePlayerActionDom(std::string_view body);
+
+}  // namespace detail
+
+}  // namespace http_handler
@@ -1,134 +1,235 @@
 // src/request_handler.cpp
 #include "request_handler.h"
+#include <boost/beast/websocket/rfc6455.hpp>
 #include <boost/json.hpp>
+#include <atomic>
+#include <iostream>
 #include <string>
 #include <string_view>
-#include <iostream> // Раскомментируйте для отладки, если потребуется
-#include <iomanip>
+
+#include "content_coding.h"
+#include "etag.h"
+#include "game_state_json.h"
+#include "json_writer.h"
+#include "map_json.h"
 
 namespace http_handler {
 
 // Псевдонимы beast, http и json уже определены в заголовке через пространство имён http_handler
 
-http::response<http::string_body> RequestHandler::MakeErrorResponse(
-    http::status status, beast::string_view code, beast::string_view message,
-    unsigned http_version, bool keep_alive) {
-    http::response<http::string_body> res{status, http_version};
-    res.set(http::field::content_type, "application/json");
-    res.keep_alive(keep_alive); // Используем флаг keep_alive из запроса
-    
+namespace {
+
+// Номер текущего потока среди потоков, обрабатывавших запросы: выбирает таблицу формируемых тел
+unsigned GetThreadNumber() noexcept {
+    static std::atomic<unsigned> next_number{0};
+    thread_local const unsigned number = next_number.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+}  // namespace
+
+void RequestHandler::AddRoutes() {
+    AddRoute("/api/v1/maps", {http::verb::get}, &RequestHandler::HandleGetMaps);
+    AddRoute("/api/v1/maps/:id", {http::verb::get}, &RequestHandler::HandleGetMap);
+    AddRoute("/api/v1/game/state", {http::verb::get}, &RequestHandler::HandleGameState);
+}
+
+void RequestHandler::HandleRequest(const Request& req, ResponseSendCallback& sender) {
+    // Маршрут ищется по target без копирования, параметры пути ссылаются на target
+    const auto match = router_.Find(req.method(), std::string_view(req.target().data(), req.target().size()));
+    switch (match.status) {
+        case Router::Status::FOUND:
+            (this->*match.route->value.handler)(req, sender, match.params);
+            break;
+        case Router::Status::METHOD_NOT_ALLOWED:
+            sender(MakeCachedResponse(match.route->value.method_not_allowed, req));
+            break;
+        case Router::Status::NOT_FOUND:
+            if (static_files_ && !IsApiTarget(req.target())) {
+                sender(static_files_->Serve(req));
+            } else {
+                sender(MakeCachedResponse(bad_request_, req));
+            }
+            break;
+    }
+}
+
+void RequestHandler::HandleScheduledRequest(const Request& req, ResponseSendCallback& sender) {
+    try {
+        HandleRequest(req, sender);
+    } catch (const std::exception& e) {
+        std::cerr << "RequestHandler exception: " << e.what() << std::endl;
+        sender(MakeCachedResponse(internal_error_, req));
+    } catch (...) {
+        std::cerr << "Unknown exception in RequestHandler." << std::endl;
+        sender(MakeCachedResponse(internal_error_, req));
+    }
+}
+
+void RequestHandler::AddRoute(std::string_view pattern, std::initializer_list<http::verb> methods,
+                              RouteHandler handler) {
+    auto& route = router_.Add(pattern, methods, RouteTarget{.handler = handler});
+    route.value.method_not_allowed =
+        MakePreparedError(http::status::method_not_allowed, "methodNotAllowed", "Method not allowed", route.allow);
+}
+
+http_server::PreparedResponsePtr RequestHandler::MakePreparedError(
+    http::status status, beast::string_view code, beast::string_view message, beast::string_view allow) {
     json::object error;
     error["code"] = code;
     error["message"] = message;
-    
-    res.body() = json::serialize(error);
-    res.prepare_payload();
-    return res;
+
+    http::response_header<> header;
+    header.result(status);
+    header.set(http::field::content_type, "application/json");
+    if (!allow.empty()) {
+        header.set(http::field::allow, allow);
+    }
+    return std::make_shared<const http_server::PreparedResponse>(
+        header, http_server::MakeSharedBuffer(json::serialize(error)));
 }
 
-http::response<http::string_body> RequestHandler::MakeSuccessResponse(
-    http::status status, const json::value& body,
-    unsigned http_version, bool keep_alive) {
-    http::response<http::string_body> res{status, http_version};
-    res.set(http::field::content_type, "application/json");
-    res.keep_alive(keep_alive); // Используем флаг keep_alive из запроса
-    
-    res.body() = json::serialize(body);
-    res.prepare_payload();
-    return res;
+http_server::PreparedResponsePtr RequestHandler::MakeServiceUnavailable(std::chrono::seconds retry_after) {
+    json::object error;
+    error["code"] = "serviceUnavailable";
+    error["message"] = "Server is overloaded, retry later";
+
+    http::response_header<> header;
+    header.result(http::status::service_unavailable);
+    header.set(http::field::content_type, "application/json");
+    header.set(http::field::retry_after, std::to_string(retry_after.count()));
+    header.set(http::field::cache_control, "no-cache");
+    return std::make_shared<const http_server::PreparedResponse>(
+        header, http_server::MakeSharedBuffer(json::serialize(error)));
 }
 
-// Метод теперь принимает константную ссылку на запрос и ссылку на колбэк
-void RequestHandler::HandleGetMaps(const http::request<http::string_body>& req, StringResponseSendCallback& sender) {
-    json::array maps_json_array;
-    // Переименовал map в map_item, чтобы избежать возможного конфликта имен, если req содержит поле map
-    for (const auto& map_item : game_.GetMaps()) { 
-        json::object map_obj;
-        map_obj["id"] = *map_item.GetId();
-        map_obj["name"] = map_item.GetName();
-        maps_json_array.push_back(std::move(map_obj));
-    }
-    
-    // Используем версию HTTP и флаг keep_alive из переданного запроса
-    sender(MakeSuccessResponse(http::status::ok, maps_json_array, req.version(), req.keep_alive()));
+http_server::CachedResponse RequestHandler::MakeCachedResponse(
+    const http_server::PreparedResponsePtr& response, unsigned http_version, bool keep_alive, bool head_only) {
+    return http_server::CachedResponse{
+        .response = response,
+        .version = http_version,
+        .keep_alive = keep_alive,
+        .head_only = head_only,
+    };
 }
 
-// Метод теперь принимает константную ссылку на запрос, ссылку на колбэк и ID карты
-void RequestHandler::HandleGetMap(const http::request<http::string_body>& req, StringResponseSendCallback& sender, beast::string_view id_sv) {
-    // Debug output
-    std::cerr << "Requested map id: '" << id_sv << "' (length: " << id_sv.length() << ")\n";
-    std::cerr << "Requested map id bytes: ";
-    for (char c : id_sv) {
-        std::cerr << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(static_cast<unsigned char>(c)) << " ";
+http_server::CachedResponse RequestHandler::MakeCachedResponse(const http_server::PreparedResponsePtr& response,
+                                                               const Request& req) {
+    return MakeCachedResponse(response, req.version(), req.keep_alive(), req.method() == http::verb::head);
+}
+
+void RequestHandler::HandleGameState(const Request& req, ResponseSendCallback& sender,
+                                     const http_server::RouteParams& /*params*/) {
+    if (!game_states_) {
+        // Игровое время не идёт: нет ни снимков состояния, ни кадров для подписчиков WebSocket
+        sender(MakeCachedResponse(bad_request_, req));
+        return;
     }
-    std::cerr << std::dec << "\n";
-    
-    std::cerr << "Available map ids:\n";
-    for (const auto& map : game_.GetMaps()) {
-        const auto& id = *map.GetId();
-        std::cerr << "  '" << id << "' (length: " << id.length() << ")\n";
-        std::cerr << "  bytes: ";
-        for (char c : id) {
-            std::cerr << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(static_cast<unsigned char>(c)) << " ";
-        }
-        std::cerr << std::dec << "\n";
+    if (beast::websocket::is_upgrade(req)) {
+        // Вместо опроса клиент получает состояние по WebSocket каждый тик
+        sender(http_server::MakeWebSocketUpgrade(req, state_channel_));
+        return;
     }
-    
-    // Конструируем Map::Id из string_view
-    model::Map::Id map_id_to_find{std::string(id_sv)};
-    
-    // Ищем карту по ID
-    if (auto map_ptr = game_.FindMap(map_id_to_find)) {
-        json::object map_obj;
-        map_obj["id"] = *map_ptr->GetId();
-        map_obj["name"] = map_ptr->GetName();
-        
-        json::array roads_json; // Переименовал, чтобы не конфликтовать с map_ptr->GetRoads()
-        for (const auto& road : map_ptr->GetRoads()) {
-            json::object road_obj;
-            auto start = road.GetStart();
-            auto end = road.GetEnd();
-            road_obj["x0"] = start.x;
-            road_obj["y0"] = start.y;
-            if (road.IsHorizontal()) {
-                road_obj["x1"] = end.x;
-            } else {
-                road_obj["y1"] = end.y;
+    std::string body;
+    {
+        // Снимок читается без блокировок: тик тем временем пишет следующий снимок в другой буфер
+        const auto state = game_states_->Read();
+        json_writer::JsonWriter writer{body};
+        WriteGameState(writer, *state);
+    }
+    auto res = http_server::MakeStringResponse(req, http::status::ok);
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::cache_control, "no-cache");
+    res.keep_alive(req.keep_alive());
+    res.body().assign(body.data(), body.size());
+    res.prepare_payload();
+    sender(std::move(res));
+}
+
+void RequestHandler::SendCatalogEntry(const Request& req, ResponseSendCallback& sender,
+                                      const std::shared_ptr<const MapCatalog>& catalog,
+                                      const MapCatalog::Entry& entry) {
+    const auto accept_encoding = req[http::field::accept_encoding];
+    const bool accepts_gzip =
+        http_server::AcceptsEncoding(std::string_view(accept_encoding.data(), accept_encoding.size()), "gzip");
+
+    // Карта, которой нет в каталоге, сжимается во время отправки: на это нужно разрешение бюджета.
+    // Запрос, присоединившийся к уже сжимаемому телу, разрешения не берёт
+    std::optional<http_server::CompressionBudget::Permit> permit;
+    std::unique_ptr<http_server::BodyStream> body;
+    bool gzip = false;
+    if (accepts_gzip) {
+        if (entry.ok) {
+            gzip = entry.gzip_ok != nullptr;
+        } else if (entry.size >= dynamic_compression_.min_size) {
+            if (coalesce_requests_) {
+                body = GetMapFlights().Join({&entry, true});
             }
-            roads_json.push_back(std::move(road_obj));
-        }
-        map_obj["roads"] = std::move(roads_json);
-        
-        json::array buildings_json; // Переименовал
-        for (const auto& building : map_ptr->GetBuildings()) {
-            json::object building_obj;
-            auto bounds = building.GetBounds();
-            building_obj["x"] = bounds.position.x;
-            building_obj["y"] = bounds.position.y;
-            building_obj["w"] = bounds.size.width;
-            building_obj["h"] = bounds.size.height;
-            buildings_json.push_back(std::move(building_obj));
+            if (!body) {
+                permit = compression_budget_->TryAcquire();
+            }
+            gzip = body || permit;
         }
-        map_obj["buildings"] = std::move(buildings_json);
-        
-        json::array offices_json; // Переименовал
-        for (const auto& office : map_ptr->GetOffices()) {
-            json::object office_obj;
-            office_obj["id"] = *office.GetId();
-            auto pos = office.GetPosition();
-            office_obj["x"] = pos.x;
-            office_obj["y"] = pos.y;
-            auto offset = office.GetOffset();
-            office_obj["offsetX"] = offset.dx;
-            office_obj["offsetY"] = offset.dy;
-            offices_json.push_back(std::move(office_obj));
+    }
+
+    const auto if_none_match = req[http::field::if_none_match];
+    const bool not_modified =
+        !if_none_match.empty()
+        && http_server::MatchesIfNoneMatch(std::string_view(if_none_match.data(), if_none_match.size()),
+                                           gzip ? entry.gzip_etag : entry.etag);
+    if (not_modified) {
+        sender(MakeCachedResponse(gzip ? entry.gzip_not_modified : entry.not_modified, req));
+        return;
+    }
+    if (entry.ok) {
+        sender(MakeCachedResponse(gzip ? entry.gzip_ok : entry.ok, req));
+        return;
+    }
+    // Большая карта: первые части уходят клиенту, пока остальные ещё не сериализованы
+    http_server::StreamResponse res{http::status::ok, req.version()};
+    res.set(http::field::content_type, "application/json");
+    res.set(http::field::vary, "Accept-Encoding");
+    res.keep_alive(req.keep_alive());
+    auto make_source = [&]() -> std::unique_ptr<http_server::BodyStream> {
+        std::unique_ptr<http_server::BodyStream> source = std::make_unique<MapJsonStream>(*entry.map);
+        if (gzip) {
+            source = std::make_unique<http_server::GzipBodyStream>(std::move(source), dynamic_compression_.level,
+                                                                   std::move(*permit));
         }
-        map_obj["offices"] = std::move(offices_json);
-        
-        sender(MakeSuccessResponse(http::status::ok, map_obj, req.version(), req.keep_alive()));
+        return source;
+    };
+    if (!body && coalesce_requests_) {
+        // Пока тело хранится целиком, к нему присоединяются одновременные запросы той же карты.
+        // Хранится не больше, чем карта, которую каталог счёл бы достаточно маленькой
+        body = GetMapFlights().JoinOrStart({&entry, gzip}, make_source, max_cached_map_size_, catalog);
+    }
+    if (!body) {
+        body = make_source();
+    }
+    res.set(http::field::etag, gzip ? entry.gzip_etag : entry.etag);
+    if (gzip) {
+        res.set(http::field::content_encoding, "gzip");
+    }
+    res.body() = std::move(body);
+    res.prepare_payload();
+    sender(std::move(res));
+}
+
+RequestHandler::MapFlights& RequestHandler::GetMapFlights() {
+    return *map_flights_[map_flights_.size() == 1 ? 0 : GetThreadNumber() % map_flights_.size()];
+}
+
+void RequestHandler::HandleGetMaps(const Request& req, ResponseSendCallback& sender,
+                                   const http_server::RouteParams& /*params*/) {
+    SendCatalogEntry(req, sender, map_catalog_, map_catalog_->GetMapList());
+}
+
+void RequestHandler::HandleGetMap(const Request& req, ResponseSendCallback& sender,
+                                  const http_server::RouteParams& params) {
+    if (const auto* entry = map_catalog_->FindMap(params.Get("id"))) {
+        SendCatalogEntry(req, sender, map_catalog_, *entry);
     } else {
-        // Карта не найдена
-        sender(MakeErrorResponse(http::status::not_found, "mapNotFound", "Map not found", req.version(), req.keep_alive()));
+        sender(MakeCachedResponse(map_not_found_, req));
     }
 }
 
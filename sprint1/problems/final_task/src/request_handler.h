@@ -1,8 +1,23 @@
 // src/request_handler.h
 #pragma once
-#include "http_server.h" // Для http::request, http::response и псевдонима http_server::RequestHandler (std::function)
+#include "broadcast_channel.h"
+#include "dynamic_compression.h"
+#include "game_session.h"
+#include "http_server.h" // Для http::request, http::response и типов ответов сессии
+#include "map_catalog.h"
 #include "model.h"
-#include <functional>
+#include "request_scheduler.h"
+#include "router.h"
+#include "singleflight.h"
+#include "snapshot.h"
+#include "small_function.h"
+#include "static_files.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
 #include <boost/json.hpp>
 
 namespace http_handler {
@@ -10,88 +25,242 @@ namespace beast = boost::beast;
 namespace http = beast::http;
 namespace json = boost::json;
 
-// Конкретный тип колбэка, используемый методами этого обработчика для отправки ответов
-using StringResponseSendCallback = std::function<void(http::response<http::string_body>&&)>;
+using Request = http_server::Request;
+using StringResponse = http_server::StringResponse;
+
+// Конкретный тип колбэка, используемый методами этого обработчика для отправки ответов.
+// Колбэк сессии (http_server::ResponseSender) помещается во внутренний буфер, поэтому
+// приведение к нему не выделяет память
+using ResponseSendCallback = http_server::SmallFunction<void(http_server::Response&&)>;
+
+struct RequestHandlerOptions {
+    // Ответы на карты длиннее max_cached_map_size байт не хранятся в памяти, а сериализуются
+    // при каждом запросе и отправляются по частям (Transfer-Encoding: chunked).
+    // По умолчанию хранятся все карты
+    std::size_t max_cached_map_size = MapCatalog::UNLIMITED;
+    // Отдача статических файлов на запросы вне /api/. Без неё на такие запросы приходит 400
+    std::optional<StaticFilesOptions> static_files;
+    // Сжатие карт, которые не хранятся в каталоге. Хранимые карты сжимаются заранее
+    http_server::DynamicCompressionOptions dynamic_compression;
+    // Одновременные запросы карты, которой нет в каталоге, сериализуют её один раз: остальные
+    // запросы присоединяются к телу, которое уже формируется для первого, и получают те же части
+    // (см. http_server::SharedStream). Карты из каталога уже сериализованы, их это не касается.
+    // false — каждый запрос сериализует карту сам
+    bool coalesce_requests = true;
+    // Объединять только запросы, которые обрабатывает один поток: у каждого потока своя таблица
+    // формируемых тел, и потоки не делят её блокировку. Для режима sharded, где поток — это шард
+    bool coalesce_per_thread = false;
+    // Пулы потоков для запросов API игры и статических файлов (см. RequestScheduler).
+    // Без них запрос обрабатывается в потоке io_context, прочитавшем его
+    std::optional<http_server::RequestSchedulerOptions> scheduling;
+    // Снимки состояния игры после тиков (см. TickEngine) для GET /api/v1/game/state.
+    // Без них на такой запрос, в том числе на переключение на WebSocket, приходит 400.
+    // Должны жить дольше обработчика
+    const util::SnapshotChannel<model::GameState>* game_states = nullptr;
+    // Канал, в который рассылается состояние игры подписчикам WebSocket на /api/v1/game/state
+    // (см. PublishGameState). nullptr — обработчик создаёт свой канал, и кадров в нём не будет
+    std::shared_ptr<http_server::BroadcastChannel> state_channel;
+};
 
 class RequestHandler {
 public:
-    explicit RequestHandler(model::Game& game)
-        : game_{game} {
+    explicit RequestHandler(model::Game& game, RequestHandlerOptions options = {})
+        : game_{game}
+        , max_cached_map_size_{options.max_cached_map_size}
+        , dynamic_compression_{options.dynamic_compression}
+        , compression_budget_{
+              std::make_shared<http_server::CompressionBudget>(options.dynamic_compression.max_streams)}
+        , coalesce_requests_{options.coalesce_requests}
+        , coalescing_stats_{std::make_shared<http_server::CoalescingStats>()}
+        , game_states_{options.game_states}
+        , state_channel_{options.state_channel ? std::move(options.state_channel)
+                                               : std::make_shared<http_server::BroadcastChannel>()}
+        , bad_request_{MakePreparedError(http::status::bad_request, "badRequest", "Bad request")}
+        , map_not_found_{MakePreparedError(http::status::not_found, "mapNotFound", "Map not found")}
+        , internal_error_{
+              MakePreparedError(http::status::internal_server_error, "internalError", "Internal server error")}
+        , map_catalog_{std::make_shared<const MapCatalog>(game, max_cached_map_size_)}
+        , static_files_{options.static_files ? std::make_unique<StaticFiles>(std::move(*options.static_files))
+                                             : nullptr}
+        , scheduler_{options.scheduling ? std::make_unique<http_server::RequestScheduler>(*options.scheduling)
+                                        : nullptr} {
+        if (scheduler_) {
+            service_unavailable_ = MakeServiceUnavailable(scheduler_->GetRetryAfter());
+        }
+        const auto flight_tables = options.coalesce_per_thread ? std::max(1u, std::thread::hardware_concurrency()) : 1u;
+        for (unsigned i = 0; i < flight_tables; ++i) {
+            map_flights_.push_back(std::make_unique<MapFlights>(coalescing_stats_));
+        }
+        AddRoutes();
     }
 
     RequestHandler(const RequestHandler&) = delete;
     RequestHandler& operator=(const RequestHandler&) = delete;
 
-    // operator() шаблонизирован для приёма конкретного типа колбэка отправки из http_server
+    // Бюджет сжатия ответов на лету, для статистики
+    const http_server::CompressionBudget& GetCompressionBudget() const noexcept {
+        return *compression_budget_;
+    }
+
+    // Счётчики объединения одинаковых запросов
+    const http_server::CoalescingStats& GetCoalescingStats() const noexcept {
+        return *coalescing_stats_;
+    }
+
+    // Планировщик запросов, nullptr — запросы обрабатываются в потоках io_context
+    const http_server::RequestScheduler* GetScheduler() const noexcept {
+        return scheduler_.get();
+    }
+
+    // Останавливает пулы потоков планировщика. Вызывать после остановки io_context,
+    // но до его уничтожения: невыполненные задачи удерживают сессии
+    void StopScheduling() noexcept {
+        if (scheduler_) {
+            scheduler_->Stop();
+        }
+    }
+
+    // operator() шаблонизирован для приёма конкретного типа колбэка отправки из http_server.
+    // hold удерживает арену запроса (см. http_server::RequestHold): без планировщика запрос
+    // не переживает вызов, и удержание освобождается при возврате
     template <typename Body, typename Allocator, typename Send>
-    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send_cb) {
-        
-        const auto& target = req.target(); // Константная ссылка на target
-        const auto method = req.method();
-        unsigned http_version = req.version();
-        bool keep_alive = req.keep_alive();
-
-        // Адаптируем общий Send&& send_cb к конкретному StringResponseSendCallback.
+    void operator()(http::request<Body, http::basic_fields<Allocator>>&& req, Send&& send_cb,
+                    http_server::RequestHold&& hold) {
+        // Адаптируем общий Send&& send_cb к конкретному ResponseSendCallback.
         // Это позволяет HandleGetMaps/HandleGetMap иметь конкретную сигнатуру.
-        StringResponseSendCallback sender = std::forward<Send>(send_cb);
-
-        // Предполагаем, что Body - это http::string_body, как используется в http_server.cpp.
-        // В данном проекте http_server использует http::string_body.
-        // Создаем константную ссылку на конкретный тип запроса, чтобы передавать ее дальше
-        // и избежать проблем с перемещением из req, если он нужен в нескольких ветках.
-        // Это важно, так как req (параметр) может быть rvalue-ссылкой, и мы не хотим его перемещать досрочно.
-        const auto& concrete_req_ref = static_cast<const http::request<http::string_body>&>(req);
-
-        // Normalize target to always start with a slash
-        std::string normalized_target = target.starts_with('/') ? std::string(target) : "/" + std::string(target);
-        beast::string_view norm_target_sv{normalized_target};
-
-        // Define the API prefix for map IDs
-        static const beast::string_view API_MAP_PREFIX = "/api/v1/maps/";
-        static const beast::string_view API_MAPS = "/api/v1/maps";
-
-        if (norm_target_sv == API_MAPS) {
-            if (method == http::verb::get) {
-                HandleGetMaps(concrete_req_ref, sender);
-            } else {
-                sender(MakeErrorResponse(http::status::method_not_allowed, "methodNotAllowed", "Method not allowed", http_version, keep_alive));
-            }
-        } else if (norm_target_sv.starts_with(API_MAP_PREFIX)) {
-            // Проверяем, что после префикса есть хотя бы один символ (ID карты не пустой)
-            if (norm_target_sv.size() > API_MAP_PREFIX.size()) {
-                if (method == http::verb::get) {
-                    auto id_sv = norm_target_sv.substr(API_MAP_PREFIX.size());
-                    // Trim leading/trailing slashes
-                    while (!id_sv.empty() && id_sv.front() == '/') id_sv.remove_prefix(1);
-                    while (!id_sv.empty() && id_sv.back() == '/') id_sv.remove_suffix(1);
-                    HandleGetMap(concrete_req_ref, sender, id_sv);
-                } else {
-                    sender(MakeErrorResponse(http::status::method_not_allowed, "methodNotAllowed", "Method not allowed", http_version, keep_alive));
-                }
-            } else {
-                sender(MakeErrorResponse(http::status::bad_request, "badRequest", "Bad request", http_version, keep_alive));
-            }
-        } else {
-            sender(MakeErrorResponse(http::status::bad_request, "badRequest", "Bad request", http_version, keep_alive));
+        ResponseSendCallback sender = std::forward<Send>(send_cb);
+        if (!scheduler_) {
+            HandleRequest(req, sender);
+            return;
         }
+        // Запрос переносится в задачу. Задача уничтожает его уже после отправки ответа, поэтому
+        // забирает и удержание арены, иначе сессия перемотала бы её под ещё живым запросом
+        const auto request_class = static_files_ && !IsApiTarget(req.target()) ? http_server::RequestClass::STATIC
+                                                                                : http_server::RequestClass::GAME_API;
+        scheduler_->Post(request_class, [this, task = ScheduledRequest{std::move(hold), std::move(req)},
+                                         sender = std::move(sender)](http_server::Admission admission) mutable {
+            const Request& req = task.req;
+            if (admission == http_server::Admission::SHED) {
+                // Перегрузка: готовый ответ 503 вместо обработки, которая только удлинила бы очередь
+                sender(MakeCachedResponse(service_unavailable_, req));
+                return;
+            }
+            HandleScheduledRequest(req, sender);
+        });
     }
 
 private:
-    // Вспомогательные методы теперь принимают константную ссылку на запрос и колбэк отправки
-    void HandleGetMaps(const http::request<http::string_body>& req, StringResponseSendCallback& sender);
-    
-    void HandleGetMap(const http::request<http::string_body>& req, StringResponseSendCallback& sender, beast::string_view id_sv);
+    using RouteHandler = void (RequestHandler::*)(const Request& req, ResponseSendCallback& sender,
+                                                  const http_server::RouteParams& params);
+
+    struct RouteTarget {
+        RouteHandler handler;
+        // Ответ 405 с заголовком Allow, перечисляющим методы маршрута
+        http_server::PreparedResponsePtr method_not_allowed;
+    };
 
-    // Эти вспомогательные функции также нуждаются в версии HTTP и флаге keep_alive из запроса
-    http::response<http::string_body> MakeErrorResponse(
-        http::status status, beast::string_view code, beast::string_view message,
-        unsigned http_version, bool keep_alive);
+    // Ключ формируемого тела карты: запись каталога и вариант кодирования.
+    // Запись живёт, пока тело читают: SharedStream удерживает каталог
+    struct MapFlightKey {
+        const MapCatalog::Entry* entry;
+        bool gzip;
+
+        bool operator==(const MapFlightKey&) const = default;
+    };
+
+    struct MapFlightKeyHasher {
+        std::size_t operator()(const MapFlightKey& key) const noexcept {
+            return std::hash<const void*>{}(key.entry) * 2 + key.gzip;
+        }
+    };
+
+    using MapFlights = http_server::StreamFlights<MapFlightKey, MapFlightKeyHasher>;
+
+    using Router = http_server::Router<RouteTarget>;
+
+    // Запрос в задаче планировщика. Члены уничтожаются в обратном порядке: сначала запрос,
+    // затем удержание его арены
+    struct ScheduledRequest {
+        http_server::RequestHold hold;
+        Request req;
+    };
+
+    // Запросы к API начинаются с /api/, все остальные — к статическим файлам
+    static bool IsApiTarget(beast::string_view target) noexcept {
+        return target.starts_with("/api/") || target == "/api";
+    }
+
+    // Маршрутизирует запрос и отправляет ответ. Вызывается в потоке io_context или пула планировщика
+    void HandleRequest(const Request& req, ResponseSendCallback& sender);
+
+    // HandleRequest в потоке пула планировщика. Исключение сессия здесь уже не перехватит, а поток
+    // пула оно завершило бы вместе с процессом, поэтому любое исключение превращается в ответ 500
+    void HandleScheduledRequest(const Request& req, ResponseSendCallback& sender);
+
+    // Таблица маршрутов. Строится один раз при создании обработчика
+    void AddRoutes();
+    void AddRoute(std::string_view pattern, std::initializer_list<http::verb> methods, RouteHandler handler);
+
+    // Вспомогательные методы принимают константную ссылку на запрос, колбэк отправки
+    // и параметры пути найденного маршрута
+    void HandleGetMaps(const Request& req, ResponseSendCallback& sender, const http_server::RouteParams& params);
     
-    http::response<http::string_body> MakeSuccessResponse(
-        http::status status, const json::value& body,
-        unsigned http_version, bool keep_alive);
+    void HandleGetMap(const Request& req, ResponseSendCallback& sender, const http_server::RouteParams& params);
+
+    // Состояние игры после последнего тика или переключение на WebSocket для получения его каждый тик
+    void HandleGameState(const Request& req, ResponseSendCallback& sender, const http_server::RouteParams& params);
+
+    // Отправляет ответ каталога карт: 304 без тела, если клиент прислал в If-None-Match
+    // ETag этого ответа, иначе 200 с готовым телом или телом, формируемым по частям.
+    // Клиент, принимающий gzip, получает сжатый вариант: заранее сжатый из каталога или
+    // сжимаемый на лету, если позволяет бюджет сжатия. Запись принадлежит каталогу catalog
+    void SendCatalogEntry(const Request& req, ResponseSendCallback& sender,
+                          const std::shared_ptr<const MapCatalog>& catalog, const MapCatalog::Entry& entry);
+
+    // Таблица формируемых тел карт для текущего потока
+    MapFlights& GetMapFlights();
+
+    // Ответ об ошибке, сериализуемый один раз при создании обработчика.
+    // Непустой allow добавляется в ответ заголовком Allow
+    static http_server::PreparedResponsePtr MakePreparedError(
+        http::status status, beast::string_view code, beast::string_view message, beast::string_view allow = {});
+
+    // Ответ 503 на запросы, отклонённые при перегрузке, с заголовком Retry-After
+    static http_server::PreparedResponsePtr MakeServiceUnavailable(std::chrono::seconds retry_after);
+
+    // Привязывает подготовленный ответ к запросу с заданными версией HTTP и флагом keep_alive.
+    // Ответ на HEAD отправляется без тела
+    static http_server::CachedResponse MakeCachedResponse(
+        const http_server::PreparedResponsePtr& response, unsigned http_version, bool keep_alive, bool head_only);
+    // То же для версии HTTP, keep_alive и метода запроса req
+    static http_server::CachedResponse MakeCachedResponse(const http_server::PreparedResponsePtr& response,
+                                                          const Request& req);
 
     model::Game& game_; // Ссылка на модель игры
+    std::size_t max_cached_map_size_;
+    http_server::DynamicCompressionOptions dynamic_compression_;
+    std::shared_ptr<http_server::CompressionBudget> compression_budget_;
+    bool coalesce_requests_;
+    std::shared_ptr<http_server::CoalescingStats> coalescing_stats_;
+    // Тела карт вне каталога, которые формируются сейчас. Одна таблица или по таблице на поток
+    // (coalesce_per_thread): поток берёт таблицу по своему номеру, потоков больше таблиц — делят их
+    std::vector<std::unique_ptr<MapFlights>> map_flights_;
+    const util::SnapshotChannel<model::GameState>* game_states_;
+    // Подписчики на состояние игры
+    std::shared_ptr<http_server::BroadcastChannel> state_channel_;
+    // Типовые ответы об ошибках. Тело и заголовки общие для всех запросов
+    http_server::PreparedResponsePtr bad_request_;
+    http_server::PreparedResponsePtr map_not_found_;
+    http_server::PreparedResponsePtr internal_error_;
+    // Есть, только если запросы обрабатываются планировщиком
+    http_server::PreparedResponsePtr service_unavailable_;
+    // Сериализованные ответы API карт. Карты не меняются после загрузки, поэтому каталог строится
+    // один раз. Тело карты вне каталога, которое читают объединённые запросы, удерживает его
+    const std::shared_ptr<const MapCatalog> map_catalog_;
+    std::unique_ptr<StaticFiles> static_files_;
+    Router router_;
+    // Объявлен последним: его потоки обращаются к остальным членам и останавливаются первыми
+    std::unique_ptr<http_server::RequestScheduler> scheduler_;
     // Удалены члены req_ и send_, так как RequestHandler теперь stateless для каждого запроса
 };
 
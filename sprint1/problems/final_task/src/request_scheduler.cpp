@@ -0,0 +1,74 @@
+// src/request_scheduler.cpp
+#include "request_scheduler.h"
+
+#include <algorithm>
+
+namespace http_server {
+
+void QueueTimeStats::Record(std::chrono::steady_clock::duration queue_time,
+                            std::chrono::steady_clock::duration latency_budget) noexcept {
+    const auto ns = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(queue_time).count());
+    requests.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(ns, std::memory_order_relaxed);
+    auto max = max_ns.load(std::memory_order_relaxed);
+    while (ns > max && !max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+    if (latency_budget != std::chrono::steady_clock::duration::zero() && queue_time > latency_budget) {
+        over_budget.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Admission LoadShedder::Admit(Clock::time_point now, Clock::duration sojourn) noexcept {
+    if (interval_ == Clock::duration::zero()) {
+        return Admission::ACCEPT;
+    }
+    bool overloaded;
+    {
+        std::lock_guard lock{mutex_};
+        overloaded = overloaded_.load(std::memory_order_relaxed);
+        if (now >= interval_end_) {
+            if (now >= interval_end_ + interval_) {
+                // После окна целое окно не было запросов: очередь пуста. Так же и до первого окна
+                overloaded = false;
+            } else if (!overloaded) {
+                // Перегрузка начинается, если ни один запрос за окно не дождался обработки за target
+                overloaded = min_sojourn_ > target_;
+            } else {
+                // и заканчивается, когда за окно ни один запрос не ждал дольше target. Пока отказы идут,
+                // очередь опустошается и наименьшее ожидание мало, поэтому по нему о конце перегрузки
+                // судить нельзя
+                overloaded = max_sojourn_ > target_;
+            }
+            overloaded_.store(overloaded, std::memory_order_relaxed);
+            interval_end_ = now + interval_;
+            min_sojourn_ = Clock::duration::max();
+            max_sojourn_ = Clock::duration::zero();
+        }
+        min_sojourn_ = std::min(min_sojourn_, sojourn);
+        max_sojourn_ = std::max(max_sojourn_, sojourn);
+    }
+    return sojourn > (overloaded ? target_ : interval_) ? Admission::SHED : Admission::ACCEPT;
+}
+
+RequestScheduler::RequestScheduler(RequestSchedulerOptions options)
+    : lanes_{Lane{options.game_api}, Lane{options.static_files}}
+    , retry_after_(options.retry_after) {
+}
+
+void RequestScheduler::Stop() noexcept {
+    for (auto& lane : lanes_) {
+        if (lane.pool) {
+            lane.pool->stop();
+        }
+    }
+    // Невыполненные задачи уничтожаются вместе с пулом, пока их сессии ещё можно закрыть
+    for (auto& lane : lanes_) {
+        if (lane.pool) {
+            lane.pool->join();
+            lane.pool.reset();
+        }
+    }
+}
+
+}  // namespace http_server
@@ -0,0 +1,191 @@
+// src/request_scheduler.h
+#pragma once
+#include <boost/asio/post.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+// Класс запроса: от него зависит, в каком пуле потоков запрос обрабатывается
+enum class RequestClass : std::uint8_t {
+    // API игры: ответы маленькие и готовые, задержка заметна игроку
+    GAME_API,
+    // Статические файлы: запросов много, отдача может упираться в диск и сжатие
+    STATIC,
+};
+
+inline constexpr std::size_t REQUEST_CLASS_COUNT = 2;
+
+constexpr std::string_view GetRequestClassName(RequestClass request_class) noexcept {
+    return request_class == RequestClass::GAME_API ? "game API" : "static";
+}
+
+// Решение о запросе, дождавшемся своей очереди
+enum class Admission : std::uint8_t {
+    // Обработать
+    ACCEPT,
+    // Сервер перегружен: ответить отказом, не обрабатывая
+    SHED,
+};
+
+struct RequestClassOptions {
+    // Потоки пула этого класса (не меньше одного). Пулы разных классов не делят потоки,
+    // поэтому наплыв запросов одного класса не задерживает запросы другого
+    unsigned threads = 1;
+    // Сколько запрос может ждать в очереди пула. Запросы, ждавшие дольше, учитываются в статистике.
+    // Это же целевое время ожидания для отказов при перегрузке (см. LoadShedder)
+    std::chrono::steady_clock::duration latency_budget{};
+    // Окно, за которое оценивается перегрузка. Нулевое — запросы этого класса не отклоняются
+    std::chrono::steady_clock::duration shedding_interval{};
+};
+
+struct RequestSchedulerOptions {
+    RequestClassOptions game_api{.threads = 2,
+                                 .latency_budget = std::chrono::milliseconds{5},
+                                 .shedding_interval = std::chrono::milliseconds{100}};
+    RequestClassOptions static_files{.threads = 1,
+                                     .latency_budget = std::chrono::milliseconds{100},
+                                     .shedding_interval = std::chrono::seconds{1}};
+    // Через сколько секунд клиенту предлагается повторить отклонённый запрос (Retry-After)
+    std::chrono::seconds retry_after{1};
+};
+
+// Отказы при перегрузке в духе CoDel: решение принимается по времени, которое запрос провёл
+// в очереди. Пока очередь хотя бы раз за interval опустошается (наименьшее ожидание за окно
+// не больше target), запрос может ждать до interval: это всплеск, и очередь его рассосёт.
+// Если за всё окно ожидание ни разу не опустилось до target, очередь стоит и сама не
+// рассосётся: тогда запросы, ждавшие дольше target, отклоняются, и очередь быстро сжимается,
+// а принятые запросы ждут не дольше target вместо того, чтобы ждать все одинаково долго.
+// Отказы прекращаются, когда за целое окно ни один запрос не ждал дольше target.
+// Можно использовать из нескольких потоков
+class LoadShedder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // interval == 0 — запросы не отклоняются
+    LoadShedder(Clock::duration target, Clock::duration interval) noexcept
+        : target_(target)
+        , interval_(interval) {
+    }
+
+    // Решение о запросе, извлечённом из очереди в момент now после ожидания sojourn
+    Admission Admit(Clock::time_point now, Clock::duration sojourn) noexcept;
+
+    // Отклоняются ли сейчас запросы, ждавшие дольше target
+    bool IsOverloaded() const noexcept {
+        return overloaded_.load(std::memory_order_relaxed);
+    }
+
+private:
+    const Clock::duration target_;
+    const Clock::duration interval_;
+    std::mutex mutex_;
+    // Конец текущего окна, наименьшее и наибольшее ожидание в нём
+    Clock::time_point interval_end_{};
+    Clock::duration min_sojourn_ = Clock::duration::max();
+    Clock::duration max_sojourn_ = Clock::duration::zero();
+    std::atomic<bool> overloaded_{false};
+};
+
+// Время ожидания запросов одного класса в очереди: от передачи планировщику до начала обработки.
+// Счётчики обновляются из нескольких потоков
+struct QueueTimeStats {
+    std::atomic<std::uint64_t> requests{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    // Запросы, ждавшие дольше бюджета задержки класса
+    std::atomic<std::uint64_t> over_budget{0};
+    // Запросы, отклонённые из-за перегрузки. Учитываются и в requests
+    std::atomic<std::uint64_t> shed{0};
+
+    void Record(std::chrono::steady_clock::duration queue_time,
+                std::chrono::steady_clock::duration latency_budget) noexcept;
+
+    double GetAverageMs() const noexcept {
+        const auto count = requests.load(std::memory_order_relaxed);
+        return count != 0 ? static_cast<double>(total_ns.load(std::memory_order_relaxed)) / count / 1e6 : 0.0;
+    }
+
+    double GetMaxMs() const noexcept {
+        return static_cast<double>(max_ns.load(std::memory_order_relaxed)) / 1e6;
+    }
+};
+
+// Обрабатывает запросы в отдельных пулах потоков по классам. Потоки io_context только читают
+// запросы и отправляют ответы, а наплыв загрузок статических файлов занимает лишь потоки своего
+// пула и не задерживает API игры. Задача получает управление в потоке пула и должна сама
+// отправить ответ (ResponseSender можно вызывать из любого потока).
+// Когда очередь класса перегружена, задача вызывается с Admission::SHED (см. LoadShedder) и должна
+// ответить отказом, не обрабатывая запрос.
+// Можно использовать из нескольких потоков
+class RequestScheduler {
+public:
+    explicit RequestScheduler(RequestSchedulerOptions options);
+
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    // Ставит задачу в очередь пула класса request_class. Задача вызывается как task(Admission)
+    template <typename Task>
+    void Post(RequestClass request_class, Task&& task) {
+        auto& lane = lanes_[static_cast<std::size_t>(request_class)];
+        net::post(*lane.pool, [&lane, queued_at = LoadShedder::Clock::now(),
+                              task = std::forward<Task>(task)]() mutable {
+            const auto now = LoadShedder::Clock::now();
+            const auto sojourn = now - queued_at;
+            lane.stats.Record(sojourn, lane.options.latency_budget);
+            const auto admission = lane.shedder.Admit(now, sojourn);
+            if (admission == Admission::SHED) {
+                lane.stats.shed.fetch_add(1, std::memory_order_relaxed);
+            }
+            task(admission);
+        });
+    }
+
+    // Останавливает пулы и уничтожает задачи, которые не успели начаться, вместе с их запросами.
+    // Вызывать после остановки io_context, но до его уничтожения: задачи удерживают сессии
+    void Stop() noexcept;
+
+    const RequestClassOptions& GetOptions(RequestClass request_class) const noexcept {
+        return lanes_[static_cast<std::size_t>(request_class)].options;
+    }
+
+    const QueueTimeStats& GetStats(RequestClass request_class) const noexcept {
+        return lanes_[static_cast<std::size_t>(request_class)].stats;
+    }
+
+    std::chrono::seconds GetRetryAfter() const noexcept {
+        return retry_after_;
+    }
+
+private:
+    struct Lane {
+        explicit Lane(RequestClassOptions lane_options)
+            : options(lane_options)
+            , shedder(lane_options.latency_budget, lane_options.shedding_interval)
+            , pool(std::in_place, std::max(1u, lane_options.threads)) {
+        }
+
+        RequestClassOptions options;
+        QueueTimeStats stats;
+        LoadShedder shedder;
+        // Пуст после Stop
+        std::optional<net::thread_pool> pool;
+    };
+
+    std::array<Lane, REQUEST_CLASS_COUNT> lanes_;
+    std::chrono::seconds retry_after_;
+};
+
+}  // namespace http_server
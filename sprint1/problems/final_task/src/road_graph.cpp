@@ -0,0 +1,164 @@
+// src/road_graph.cpp
+#include "road_graph.h"
+
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+namespace model {
+
+namespace {
+
+// Дорога после слияния: line — координата поперёк, [begin, end] — вдоль
+struct Segment {
+    Coord line;
+    Coord begin;
+    Coord end;
+};
+
+// Узел на дороге: номер дороги и координата вдоль неё
+using Stop = std::pair<std::uint32_t, Coord>;
+
+// Сливает накладывающиеся и соприкасающиеся отрезки одной линии. Результат упорядочен по (line, begin)
+std::vector<Segment> MergeCollinear(std::vector<Segment> spans) {
+    std::sort(spans.begin(), spans.end(), [](const Segment& lhs, const Segment& rhs) {
+        return std::tie(lhs.line, lhs.begin) < std::tie(rhs.line, rhs.begin);
+    });
+    std::vector<Segment> merged;
+    for (const auto& span : spans) {
+        if (!merged.empty() && merged.back().line == span.line && span.begin <= merged.back().end) {
+            merged.back().end = std::max(merged.back().end, span.end);
+        } else {
+            merged.push_back(span);
+        }
+    }
+    return merged;
+}
+
+// Концы каждой дороги — узлы
+std::vector<Stop> MakeEndStops(const std::vector<Segment>& segments) {
+    std::vector<Stop> stops;
+    stops.reserve(2 * segments.size());
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        stops.emplace_back(static_cast<std::uint32_t>(i), segments[i].begin);
+        stops.emplace_back(static_cast<std::uint32_t>(i), segments[i].end);
+    }
+    return stops;
+}
+
+bool ByPosition(Point lhs, Point rhs) noexcept {
+    return std::tie(lhs.y, lhs.x) < std::tie(rhs.y, rhs.x);
+}
+
+constexpr std::size_t DirectionIndex(Direction direction) noexcept {
+    return static_cast<std::size_t>(direction);
+}
+
+}  // namespace
+
+RoadGraph::RoadGraph(const std::vector<Road>& roads) {
+    std::vector<Segment> horizontal;
+    std::vector<Segment> vertical;
+    for (const auto& road : roads) {
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        // Дорога нулевой длины — отдельный узел, её описывает горизонтальный отрезок
+        if (road.IsHorizontal()) {
+            horizontal.push_back({start.y, std::min(start.x, end.x), std::max(start.x, end.x)});
+        } else {
+            vertical.push_back({start.x, std::min(start.y, end.y), std::max(start.y, end.y)});
+        }
+    }
+    horizontal = MergeCollinear(std::move(horizontal));
+    vertical = MergeCollinear(std::move(vertical));
+    auto horizontal_stops = MakeEndStops(horizontal);
+    auto vertical_stops = MakeEndStops(vertical);
+
+    // Перекрёстки: для вертикальной дороги — горизонтальные линии в пределах её длины и на каждой
+    // двоичным поиском дорога, через которую она проходит. Отрезки одной линии не пересекаются
+    const auto line_less = [](const Segment& segment, Coord line) {
+        return segment.line < line;
+    };
+    for (std::size_t v = 0; v < vertical.size(); ++v) {
+        const auto& road = vertical[v];
+        auto it = std::lower_bound(horizontal.begin(), horizontal.end(), road.begin, line_less);
+        while (it != horizontal.end() && it->line <= road.end) {
+            const auto line_end =
+                std::upper_bound(it, horizontal.end(), it->line, [](Coord line, const Segment& segment) {
+                    return line < segment.line;
+                });
+            const auto h = std::upper_bound(it, line_end, road.line, [](Coord x, const Segment& segment) {
+                return x < segment.begin;
+            });
+            if (h != it && std::prev(h)->end >= road.line) {
+                horizontal_stops.emplace_back(static_cast<std::uint32_t>(std::prev(h) - horizontal.begin()), road.line);
+                vertical_stops.emplace_back(static_cast<std::uint32_t>(v), it->line);
+            }
+            it = line_end;
+        }
+    }
+    for (auto* stops : {&horizontal_stops, &vertical_stops}) {
+        std::sort(stops->begin(), stops->end());
+        stops->erase(std::unique(stops->begin(), stops->end()), stops->end());
+    }
+
+    const auto horizontal_point = [&horizontal](const Stop& stop) {
+        return Point{stop.second, horizontal[stop.first].line};
+    };
+    const auto vertical_point = [&vertical](const Stop& stop) {
+        return Point{vertical[stop.first].line, stop.second};
+    };
+    nodes_.reserve(horizontal_stops.size() + vertical_stops.size());
+    for (const auto& stop : horizontal_stops) {
+        nodes_.push_back(horizontal_point(stop));
+    }
+    for (const auto& stop : vertical_stops) {
+        nodes_.push_back(vertical_point(stop));
+    }
+    std::sort(nodes_.begin(), nodes_.end(), ByPosition);
+    nodes_.erase(std::unique(nodes_.begin(), nodes_.end(),
+                             [](Point lhs, Point rhs) {
+                                 return lhs.x == rhs.x && lhs.y == rhs.y;
+                             }),
+                 nodes_.end());
+
+    // Рёбра — участки между соседними узлами одной дороги
+    exits_.assign(nodes_.size(), {NONE, NONE, NONE, NONE});
+    const auto add_edges = [this](const std::vector<Stop>& stops, const auto& to_point, Direction forward,
+                                  Direction backward) {
+        for (std::size_t i = 1; i < stops.size(); ++i) {
+            if (stops[i - 1].first != stops[i].first) {
+                continue;
+            }
+            const auto edge = static_cast<EdgeId>(edges_.size());
+            const Edge& added = edges_.emplace_back(Edge{*FindNode(to_point(stops[i - 1])), *FindNode(to_point(stops[i]))});
+            exits_[added.from][DirectionIndex(forward)] = edge;
+            exits_[added.to][DirectionIndex(backward)] = edge;
+        }
+    };
+    add_edges(horizontal_stops, horizontal_point, Direction::EAST, Direction::WEST);
+    add_edges(vertical_stops, vertical_point, Direction::SOUTH, Direction::NORTH);
+
+    incident_offsets_.reserve(nodes_.size() + 1);
+    incident_edges_.reserve(2 * edges_.size());
+    for (const auto& exits : exits_) {
+        incident_offsets_.push_back(static_cast<std::uint32_t>(incident_edges_.size()));
+        for (EdgeId edge : exits) {
+            if (edge != NONE) {
+                incident_edges_.push_back(edge);
+            }
+        }
+    }
+    incident_offsets_.push_back(static_cast<std::uint32_t>(incident_edges_.size()));
+}
+
+std::optional<RoadGraph::NodeId> RoadGraph::FindNode(Point position) const noexcept {
+    const auto it = std::lower_bound(nodes_.begin(), nodes_.end(), position, ByPosition);
+    if (it == nodes_.end() || it->x != position.x || it->y != position.y) {
+        return std::nullopt;
+    }
+    return static_cast<NodeId>(it - nodes_.begin());
+}
+
+}  // namespace model
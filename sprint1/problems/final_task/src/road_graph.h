@@ -0,0 +1,91 @@
+// src/road_graph.h
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "model.h"
+
+namespace model {
+
+// Граф дорог карты. Накладывающиеся и соприкасающиеся дороги одной линии сливаются в одну,
+// узлы графа — перекрёстки и концы дорог, рёбра — участки дорог между соседними узлами.
+// Из узла можно за O(1) узнать ребро в каждом из четырёх направлений (GetExit): так собака
+// на перекрёстке переходит на другую дорогу, не перебирая дороги карты. Рёбра узла лежат
+// подряд в плоском массиве (CSR) для поиска путей и обхода графа.
+// Граф неизменяем, его можно читать из нескольких потоков
+class RoadGraph {
+public:
+    using NodeId = std::uint32_t;
+    using EdgeId = std::uint32_t;
+
+    static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Edge {
+        // Западный конец горизонтального ребра или северный конец вертикального
+        NodeId from;
+        NodeId to;
+    };
+
+    explicit RoadGraph(const std::vector<Road>& roads);
+
+    std::size_t GetNodeCount() const noexcept {
+        return nodes_.size();
+    }
+
+    std::size_t GetEdgeCount() const noexcept {
+        return edges_.size();
+    }
+
+    Point GetNodePosition(NodeId node) const noexcept {
+        return nodes_[node];
+    }
+
+    // Узел в точке position, если он там есть. За O(log n)
+    std::optional<NodeId> FindNode(Point position) const noexcept;
+
+    const Edge& GetEdge(EdgeId edge) const noexcept {
+        return edges_[edge];
+    }
+
+    bool IsHorizontal(EdgeId edge) const noexcept {
+        return nodes_[edges_[edge].from].y == nodes_[edges_[edge].to].y;
+    }
+
+    Dimension GetEdgeLength(EdgeId edge) const noexcept {
+        const auto from = nodes_[edges_[edge].from];
+        const auto to = nodes_[edges_[edge].to];
+        return (to.x - from.x) + (to.y - from.y);
+    }
+
+    // Другой конец ребра edge, выходящего из node
+    NodeId GetOppositeNode(EdgeId edge, NodeId node) const noexcept {
+        return edges_[edge].from == node ? edges_[edge].to : edges_[edge].from;
+    }
+
+    // Ребро, выходящее из node в направлении direction, или NONE
+    EdgeId GetExit(NodeId node, Direction direction) const noexcept {
+        return exits_[node][static_cast<std::size_t>(direction)];
+    }
+
+    // Все рёбра узла, не больше четырёх
+    std::span<const EdgeId> GetIncidentEdges(NodeId node) const noexcept {
+        return {incident_edges_.data() + incident_offsets_[node], incident_edges_.data() + incident_offsets_[node + 1]};
+    }
+
+private:
+    // Узлы по возрастанию (y, x): так FindNode обходится двоичным поиском
+    std::vector<Point> nodes_;
+    std::vector<Edge> edges_;
+    // Рёбра узла по направлениям, индексы — значения Direction
+    std::vector<std::array<EdgeId, 4>> exits_;
+    // Рёбра узла i: [incident_offsets_[i], incident_offsets_[i + 1]) в incident_edges_
+    std::vector<std::uint32_t> incident_offsets_;
+    std::vector<EdgeId> incident_edges_;
+};
+
+}  // namespace model
@@ -0,0 +1,170 @@
+// src/road_index.cpp
+#include "road_index.h"
+
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+namespace model {
+
+RoadIndex::RoadIndex(const std::vector<Road>& roads) {
+    std::vector<std::pair<Coord, Lines::Span>> horizontal;
+    std::vector<std::pair<Coord, Lines::Span>> vertical;
+    for (std::size_t i = 0; i < roads.size(); ++i) {
+        const auto start = roads[i].GetStart();
+        const auto end = roads[i].GetEnd();
+        const auto road = static_cast<std::uint32_t>(i);
+        // Дорога нулевой длины — квадрат вокруг точки, горизонтальная линия описывает его целиком
+        if (roads[i].IsHorizontal()) {
+            horizontal.emplace_back(start.y, Lines::Span{std::min(start.x, end.x), std::max(start.x, end.x), road});
+        } else {
+            vertical.emplace_back(start.x, Lines::Span{std::min(start.y, end.y), std::max(start.y, end.y), road});
+        }
+    }
+    horizontal_.Build(std::move(horizontal));
+    vertical_.Build(std::move(vertical));
+}
+
+bool RoadIndex::IsOnRoad(Position position) const noexcept {
+    return horizontal_.FindSegment(position.y, position.x) || vertical_.FindSegment(position.x, position.y);
+}
+
+Position RoadIndex::GetFarthestPoint(Position from, Direction direction) const noexcept {
+    switch (direction) {
+        case Direction::WEST:
+        case Direction::EAST:
+            if (auto reach = FindReach(horizontal_, vertical_, from.x, from.y, direction == Direction::EAST)) {
+                return {*reach, from.y};
+            }
+            break;
+        case Direction::NORTH:
+        case Direction::SOUTH:
+            if (auto reach = FindReach(vertical_, horizontal_, from.y, from.x, direction == Direction::SOUTH)) {
+                return {from.x, *reach};
+            }
+            break;
+    }
+    return from;
+}
+
+std::optional<double> RoadIndex::FindReach(const Lines& along_lines, const Lines& cross_lines, double along,
+                                           double across, bool forward) noexcept {
+    // Продольные дороги линии, накладывающиеся друг на друга, ведут до конца их объединения.
+    // Поперечная дорога позволяет сдвинуться только в пределах своей ширины. Дальше не ведёт ни одна
+    // другая дорога: у соседних линий и у дорог, начинающихся через клетку, между краями остаётся
+    // зазор 1 - 2 * ROAD_HALF_WIDTH
+    std::optional<double> reach;
+    if (auto segment = along_lines.FindSegment(across, along)) {
+        reach = forward ? segment->second + ROAD_HALF_WIDTH : segment->first - ROAD_HALF_WIDTH;
+    }
+    if (cross_lines.FindSegment(along, across)) {
+        const double line = std::round(along);
+        const double edge = forward ? line + ROAD_HALF_WIDTH : line - ROAD_HALF_WIDTH;
+        reach = !reach ? edge : forward ? std::max(*reach, edge) : std::min(*reach, edge);
+    }
+    return reach;
+}
+
+void RoadIndex::Lines::Build(std::vector<std::pair<Coord, Span>> spans) {
+    // Внутри линии — по началу, а из дорог с общим началом первой идёт длинная: она содержит остальные
+    std::sort(spans.begin(), spans.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tuple{lhs.first, lhs.second.begin, rhs.second.end}
+             < std::tuple{rhs.first, rhs.second.begin, lhs.second.end};
+    });
+    constexpr auto NO_PARENT = std::numeric_limits<std::uint32_t>::max();
+    // parents[i] — ближайшая дорога линии, целиком содержащая spans[i]
+    std::vector<std::uint32_t> parents(spans.size(), NO_PARENT);
+    std::vector<std::uint32_t> open;
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        const auto& [line, span] = spans[i];
+        const bool new_line = i == 0 || spans[i - 1].first != line;
+        if (new_line) {
+            lines_.push_back(line);
+            segment_offsets_.push_back(static_cast<std::uint32_t>(segment_begins_.size()));
+            open.clear();
+        }
+        // Открытые дороги начинаются не дальше этой, и она вложена в последнюю, что кончается не раньше неё
+        while (!open.empty() && spans[open.back()].second.end < span.end) {
+            open.pop_back();
+        }
+        if (!open.empty()) {
+            parents[i] = open.back();
+        }
+        open.push_back(static_cast<std::uint32_t>(i));
+        // Дорога продолжает объединение, если её край не отстоит от края предыдущих
+        if (!new_line && span.begin - segment_ends_.back() <= 2 * ROAD_HALF_WIDTH) {
+            segment_ends_.back() = std::max(segment_ends_.back(), span.end);
+        } else {
+            segment_begins_.push_back(span.begin);
+            segment_ends_.push_back(span.end);
+        }
+    }
+    segment_offsets_.push_back(static_cast<std::uint32_t>(segment_begins_.size()));
+
+    // Сначала верхние списки всех линий подряд, затем списки вложенных дорог
+    std::vector<std::vector<std::uint32_t>> children(spans.size());
+    std::vector<std::uint32_t> node_spans;
+    node_spans.reserve(spans.size());
+    for (std::size_t i = 0; i < spans.size(); ++i) {
+        if (i == 0 || spans[i - 1].first != spans[i].first) {
+            line_offsets_.push_back(static_cast<std::uint32_t>(node_spans.size()));
+        }
+        if (parents[i] == NO_PARENT) {
+            node_spans.push_back(static_cast<std::uint32_t>(i));
+        } else {
+            children[parents[i]].push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    line_offsets_.push_back(static_cast<std::uint32_t>(node_spans.size()));
+    nodes_.resize(spans.size());
+    // node_spans растёт, пока цикл по нему идёт: вложенные списки добавляются в конец
+    for (std::size_t node = 0; node < node_spans.size(); ++node) {
+        const auto& span = spans[node_spans[node]].second;
+        const auto& nested = children[node_spans[node]];
+        const auto children_first = static_cast<std::uint32_t>(node_spans.size());
+        node_spans.insert(node_spans.end(), nested.begin(), nested.end());
+        nodes_[node] = {span.begin, span.end, span.road, children_first,
+                        static_cast<std::uint32_t>(node_spans.size())};
+    }
+}
+
+std::optional<std::pair<Coord, Coord>> RoadIndex::Lines::FindSegment(double across, double along) const noexcept {
+    const auto line = FindLine(across);
+    if (!line) {
+        return std::nullopt;
+    }
+    const auto first = segment_begins_.begin() + segment_offsets_[*line];
+    const auto last = segment_begins_.begin() + segment_offsets_[*line + 1];
+    // Последнее объединение, начинающееся не дальше точки. Объединения линии не пересекаются
+    const auto it = std::upper_bound(first, last, along + ROAD_HALF_WIDTH, [](double value, Coord begin) {
+        return value < begin;
+    });
+    if (it == first) {
+        return std::nullopt;
+    }
+    const auto i = static_cast<std::size_t>(it - segment_begins_.begin()) - 1;
+    if (segment_ends_[i] + ROAD_HALF_WIDTH < along) {
+        return std::nullopt;
+    }
+    return std::pair{segment_begins_[i], segment_ends_[i]};
+}
+
+std::optional<std::size_t> RoadIndex::Lines::FindLine(double across) const noexcept {
+    const double nearest = std::round(across);
+    // Края сравниваются в том же виде, в каком их вычисляют остальные запросы (line ± ROAD_HALF_WIDTH):
+    // разность across - nearest округляется иначе, и точка на краю дороги оказалась бы вне её.
+    // Проверка заодно отбрасывает NaN и координаты за пределами Coord
+    if (!(across >= nearest - ROAD_HALF_WIDTH && across <= nearest + ROAD_HALF_WIDTH)
+        || !(nearest >= std::numeric_limits<Coord>::min() && nearest <= std::numeric_limits<Coord>::max())) {
+        return std::nullopt;
+    }
+    const auto line = static_cast<Coord>(nearest);
+    const auto it = std::lower_bound(lines_.begin(), lines_.end(), line);
+    if (it == lines_.end() || *it != line) {
+        return std::nullopt;
+    }
+    return static_cast<std::size_t>(it - lines_.begin());
+}
+
+}  // namespace model
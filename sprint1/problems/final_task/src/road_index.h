@@ -0,0 +1,121 @@
+// src/road_index.h
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "model.h"
+
+namespace model {
+
+// Пространственный индекс дорог карты: какие дороги покрывают точку и докуда можно дойти
+// по дорогам в заданном направлении. Дорога — прямоугольник шириной 2 * ROAD_HALF_WIDTH
+// вокруг отрезка с целочисленными концами.
+// Горизонтальные дороги сгруппированы по линиям (одинаковый y), вертикальные — по x.
+// Линии отсортированы, дороги внутри линии упорядочены по началу, всё лежит в нескольких плоских
+// массивах. Точка с нецелой координатой попадает самое большее на одну горизонтальную
+// и одну вертикальную линию (ширина дороги меньше шага сетки), поэтому запрос — два
+// двоичных поиска линии и по двоичному поиску внутри каждой: O(log n).
+// Индекс неизменяем, его можно читать из нескольких потоков
+class RoadIndex {
+public:
+    static constexpr double ROAD_HALF_WIDTH = 0.4;
+
+    explicit RoadIndex(const std::vector<Road>& roads);
+
+    // Вызывает fn(road) для индекса каждой дороги в векторе, переданном при построении,
+    // покрывающей точку position (с краями). За O(log n) на каждую найденную дорогу
+    template <typename Fn>
+    void ForEachRoadAt(Position position, Fn&& fn) const {
+        horizontal_.ForEachRoadAt(position.y, position.x, fn);
+        vertical_.ForEachRoadAt(position.x, position.y, fn);
+    }
+
+    bool IsOnRoad(Position position) const noexcept;
+
+    // Самая дальняя точка, до которой можно дойти из from в направлении direction, не сходя
+    // с дорог. Соседние и пересекающиеся дороги переходят одна в другую. Если from не на дороге,
+    // возвращает from
+    Position GetFarthestPoint(Position from, Direction direction) const noexcept;
+
+private:
+    // Дороги одного направления. along — координата вдоль дороги, across — поперёк
+    class Lines {
+    public:
+        struct Span {
+            Coord begin;
+            Coord end;
+            std::uint32_t road;
+        };
+
+        // Строит линии по отрезкам; line[i] — координата поперёк отрезка spans[i]
+        void Build(std::vector<std::pair<Coord, Span>> spans);
+
+        template <typename Fn>
+        void ForEachRoadAt(double across, double along, Fn& fn) const {
+            if (const auto line = FindLine(across)) {
+                VisitCovering(line_offsets_[*line], line_offsets_[*line + 1], along, fn);
+            }
+        }
+
+        // Отрезок линии, составленный из накладывающихся дорог и содержащий точку (с краями).
+        // nullopt, если точка не на дороге этого направления
+        std::optional<std::pair<Coord, Coord>> FindSegment(double across, double along) const noexcept;
+
+    private:
+        // Дорога линии и список дорог, которые в ней целиком лежат: [children_first, children_last)
+        struct Node {
+            Coord begin;
+            Coord end;
+            std::uint32_t road;
+            std::uint32_t children_first;
+            std::uint32_t children_last;
+        };
+
+        // Номер линии, на которую попадает координата across, если такая линия есть
+        std::optional<std::size_t> FindLine(double across) const noexcept;
+
+        template <typename Fn>
+        void VisitCovering(std::uint32_t first, std::uint32_t last, double along, Fn& fn) const {
+            // В одном списке дороги не вложены друг в друга, поэтому и начала, и концы в нём идут
+            // по возрастанию, а точку покрывают дороги подряд, начиная с первой, которая кончается
+            // не раньше точки. Каждая просмотренная дорога покрывает точку
+            const auto list_end = nodes_.begin() + last;
+            auto it = std::lower_bound(nodes_.begin() + first, list_end, along - ROAD_HALF_WIDTH,
+                                       [](const Node& node, double value) {
+                                           return node.end < value;
+                                       });
+            for (; it != list_end && it->begin - ROAD_HALF_WIDTH <= along; ++it) {
+                fn(static_cast<std::size_t>(it->road));
+                VisitCovering(it->children_first, it->children_last, along, fn);
+            }
+        }
+
+        // Координаты линий по возрастанию
+        std::vector<Coord> lines_;
+        // Дороги линии хранятся вложенными списками (nested containment list): дороги линии i,
+        // не лежащие целиком в других, занимают [line_offsets_[i], line_offsets_[i + 1]) в nodes_,
+        // вложенные — списки своих узлов. Наложение дорог (проспект поверх отрезков улицы)
+        // не заставляет перебирать все дороги линии
+        std::vector<std::uint32_t> line_offsets_;
+        std::vector<Node> nodes_;
+        // Объединения накладывающихся дорог линии i: [segment_offsets_[i], segment_offsets_[i + 1])
+        std::vector<std::uint32_t> segment_offsets_;
+        std::vector<Coord> segment_begins_;
+        std::vector<Coord> segment_ends_;
+    };
+
+    // Граница, до которой из точки along можно дойти вдоль линий along_lines (дороги, идущие
+    // в направлении движения) и cross_lines (поперечные дороги, их ширина). forward — движение
+    // в сторону увеличения координаты
+    static std::optional<double> FindReach(const Lines& along_lines, const Lines& cross_lines, double along,
+                                           double across, bool forward) noexcept;
+
+    Lines horizontal_;
+    Lines vertical_;
+};
+
+}  // namespace model
@@ -0,0 +1,299 @@
+// src/router.h
+#pragma once
+#include <boost/beast/http/verb.hpp>
+#include <array>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http_server {
+
+namespace http = boost::beast::http;
+
+// Параметры пути найденного маршрута. Значения ссылаются на target запроса
+class RouteParams {
+public:
+    static constexpr std::size_t MAX_PARAMS = 4;
+
+    RouteParams() = default;
+
+    // Значение параметра по имени (без ':'), пустое, если такого параметра нет
+    std::string_view Get(std::string_view name) const noexcept {
+        if (names_) {
+            for (std::size_t i = 0; i < names_->size(); ++i) {
+                if ((*names_)[i] == name) {
+                    return values_[i];
+                }
+            }
+        }
+        return {};
+    }
+
+    // Значение параметра по порядковому номеру в шаблоне
+    std::string_view operator[](std::size_t index) const noexcept {
+        return values_[index];
+    }
+
+    std::size_t Size() const noexcept {
+        return names_ ? names_->size() : 0;
+    }
+
+private:
+    template <typename Value>
+    friend class Router;
+
+    const std::vector<std::string>* names_ = nullptr;
+    std::array<std::string_view, MAX_PARAMS> values_{};
+};
+
+// Путь target запроса в том виде, в каком его различает Router: без строки запроса
+// и завершающего '/'. Годится в ключи, общие для запросов одного маршрута с одними параметрами
+inline std::string_view GetRoutePath(std::string_view target) noexcept {
+    target = target.substr(0, target.find('?'));
+    while (target.size() > 1 && target.ends_with('/')) {
+        target.remove_suffix(1);
+    }
+    return target;
+}
+
+// Маршрутизатор запросов по шаблонам путей вида "/api/v1/maps/:id".
+// Шаблоны разбиваются на сегменты и собираются в префиксное дерево один раз при настройке.
+// Поиск идёт по string_view target запроса: не копирует его и не выделяет память,
+// а параметры пути (":id") возвращает как string_view на части target.
+// Сегмент-константа приоритетнее параметра на том же уровне; если с константой путь
+// не нашёлся, поиск возвращается и пробует параметр.
+// Для каждого маршрута задаётся набор допустимых методов и заранее строится значение
+// заголовка Allow для ответа 405 Method Not Allowed.
+// После настройки маршрутизатор можно использовать из нескольких потоков
+template <typename Value>
+class Router {
+public:
+    static constexpr std::size_t MAX_PARAMS = RouteParams::MAX_PARAMS;
+
+    struct Route {
+        std::string pattern;
+        // Множество допустимых методов: бит с номером значения http::verb
+        std::uint64_t methods = 0;
+        // Значение заголовка Allow, например "GET, HEAD"
+        std::string allow;
+        std::vector<std::string> param_names;
+        Value value;
+
+        bool IsAllowed(http::verb method) const noexcept {
+            return (methods & MethodBit(method)) != 0;
+        }
+    };
+
+    enum class Status {
+        FOUND,
+        // Путь совпал с маршрутом, но метод не входит в допустимые
+        METHOD_NOT_ALLOWED,
+        NOT_FOUND,
+    };
+
+    struct Match {
+        Status status = Status::NOT_FOUND;
+        // nullptr, если маршрут не найден
+        const Route* route = nullptr;
+        RouteParams params;
+    };
+
+    Router()
+        : nodes_(1) {
+    }
+
+    // Добавляет маршрут. Сегмент шаблона, начинающийся с ':', — параметр.
+    // При некорректном или повторяющемся шаблоне выбрасывает std::invalid_argument.
+    // Возвращённая ссылка действительна до следующего вызова Add
+    Route& Add(std::string_view pattern, std::initializer_list<http::verb> methods, Value value) {
+        Route route{
+            .pattern = std::string(pattern),
+            .methods = 0,
+            .allow = {},
+            .param_names = {},
+            .value = std::move(value),
+        };
+        for (auto method : methods) {
+            if (!route.IsAllowed(method)) {
+                route.methods |= MethodBit(method);
+                if (!route.allow.empty()) {
+                    route.allow += ", ";
+                }
+                const auto name = http::to_string(method);
+                route.allow.append(name.data(), name.size());
+            }
+        }
+        if (route.methods == 0) {
+            throw std::invalid_argument("Route " + route.pattern + " allows no methods");
+        }
+
+        std::uint32_t node = 0;
+        for (auto path = StripPath(pattern); !path.empty();) {
+            auto segment = NextSegment(path);
+            if (segment.starts_with(':')) {
+                if (segment.size() == 1 || route.param_names.size() == MAX_PARAMS) {
+                    throw std::invalid_argument("Bad parameter in route " + route.pattern);
+                }
+                route.param_names.emplace_back(segment.substr(1));
+                if (nodes_[node].param_child == NO_NODE) {
+                    nodes_[node].param_child = NewNode();
+                }
+                node = nodes_[node].param_child;
+            } else {
+                node = GetOrAddChild(node, segment);
+            }
+        }
+        if (nodes_[node].route != NO_NODE) {
+            throw std::invalid_argument("Duplicate route " + route.pattern);
+        }
+        nodes_[node].route = static_cast<std::uint32_t>(routes_.size());
+        return routes_.emplace_back(std::move(route));
+    }
+
+    // Ищет маршрут для target запроса. Строка запроса ('?' и далее) не учитывается,
+    // ведущий и завершающий '/' необязательны. Параметр не может быть пустым
+    Match Find(http::verb method, std::string_view target) const noexcept {
+        Match match;
+        if (target.starts_with('/')) {
+            target.remove_prefix(1);
+        }
+        const auto route = FindRoute(0, target, match.params.values_, 0);
+        if (route == NO_NODE) {
+            return match;
+        }
+        match.route = &routes_[route];
+        match.params.names_ = &match.route->param_names;
+        match.status = match.route->IsAllowed(method) ? Status::FOUND : Status::METHOD_NOT_ALLOWED;
+        return match;
+    }
+
+    const std::vector<Route>& GetRoutes() const noexcept {
+        return routes_;
+    }
+
+private:
+    static constexpr std::uint32_t NO_NODE = std::numeric_limits<std::uint32_t>::max();
+
+    struct Node {
+        // Дочерние узлы сегментов-констант, упорядочены для двоичного поиска (см. LowerBound)
+        std::vector<std::pair<std::string, std::uint32_t>> children;
+        std::uint32_t param_child = NO_NODE;
+        // Индекс маршрута, который заканчивается в этом узле
+        std::uint32_t route = NO_NODE;
+    };
+
+    static std::uint64_t MethodBit(http::verb method) noexcept {
+        const auto index = static_cast<unsigned>(method);
+        return index < 64 ? std::uint64_t{1} << index : 0;
+    }
+
+    // Шаблон без '/' по краям
+    static std::string_view StripPath(std::string_view pattern) noexcept {
+        if (pattern.starts_with('/')) {
+            pattern.remove_prefix(1);
+        }
+        if (pattern.ends_with('/')) {
+            pattern.remove_suffix(1);
+        }
+        return pattern;
+    }
+
+    // Путь закончился: дальше ничего нет или начинается строка запроса
+    static bool IsEnd(std::string_view path) noexcept {
+        return path.empty() || path.front() == '?';
+    }
+
+    // Отделяет от path первый сегмент. Сегмент заканчивается на '/' (он отбрасывается)
+    // или перед '?'. Сегменты короткие, поэтому простой цикл быстрее отдельных find
+    static std::string_view NextSegment(std::string_view& path) noexcept {
+        std::size_t end = 0;
+        while (end < path.size() && path[end] != '/' && path[end] != '?') {
+            ++end;
+        }
+        const auto segment = path.substr(0, end);
+        path.remove_prefix(end < path.size() && path[end] == '/' ? end + 1 : end);
+        return segment;
+    }
+
+    std::uint32_t NewNode() {
+        nodes_.emplace_back();
+        return static_cast<std::uint32_t>(nodes_.size() - 1);
+    }
+
+    std::uint32_t GetOrAddChild(std::uint32_t node, std::string_view segment) {
+        auto& children = nodes_[node].children;
+        auto it = LowerBound(children, segment);
+        if (it != children.end() && it->first == segment) {
+            return it->second;
+        }
+        const auto index = static_cast<std::uint32_t>(it - children.begin());
+        const auto child = NewNode();
+        // NewNode мог переместить узлы, поэтому ссылку на children берём заново
+        auto& updated = nodes_[node].children;
+        updated.emplace(updated.begin() + index, std::string(segment), child);
+        return child;
+    }
+
+    // Дочерние сегменты упорядочены сначала по длине, потом по содержимому:
+    // сравнение сегментов разной длины не доходит до сравнения байтов
+    template <typename Children>
+    static auto LowerBound(Children& children, std::string_view segment) noexcept {
+        return std::lower_bound(children.begin(), children.end(), segment,
+                                [](const auto& child, std::string_view value) {
+                                    if (child.first.size() != value.size()) {
+                                        return child.first.size() < value.size();
+                                    }
+                                    return std::string_view(child.first) < value;
+                                });
+    }
+
+    std::uint32_t FindChild(const Node& node, std::string_view segment) const noexcept {
+        const auto& children = node.children;
+        auto it = LowerBound(children, segment);
+        return it != children.end() && it->first == segment ? it->second : NO_NODE;
+    }
+
+    // Спускается по дереву. Рекурсия нужна только там, где у узла есть и подходящая
+    // константа, и параметр: если путь через константу не найдётся, пробуется параметр
+    std::uint32_t FindRoute(std::uint32_t node, std::string_view path,
+                            std::array<std::string_view, MAX_PARAMS>& params, std::size_t param_count) const noexcept {
+        for (;;) {
+            if (IsEnd(path)) {
+                return nodes_[node].route;
+            }
+            std::string_view rest = path;
+            const auto segment = NextSegment(rest);
+            const Node& current = nodes_[node];
+            const bool has_param = current.param_child != NO_NODE && !segment.empty();
+
+            if (const auto child = FindChild(current, segment); child != NO_NODE) {
+                if (!has_param) {
+                    node = child;
+                    path = rest;
+                    continue;
+                }
+                if (auto route = FindRoute(child, rest, params, param_count); route != NO_NODE) {
+                    return route;
+                }
+            }
+            if (!has_param) {
+                return NO_NODE;
+            }
+            params[param_count++] = segment;
+            node = current.param_child;
+            path = rest;
+        }
+    }
+
+    std::vector<Node> nodes_;
+    std::vector<Route> routes_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,55 @@
+// src/session_limiter.cpp
+#include "session_limiter.h"
+
+namespace http_server {
+
+SessionLimiter::Permit& SessionLimiter::Permit::operator=(Permit&& other) noexcept {
+    if (this != &other) {
+        if (limiter_) {
+            limiter_->Release();
+        }
+        limiter_ = std::move(other.limiter_);
+    }
+    return *this;
+}
+
+SessionLimiter::Permit::~Permit() {
+    if (limiter_) {
+        limiter_->Release();
+    }
+}
+
+std::optional<SessionLimiter::Permit> SessionLimiter::TryAcquire(Waiter&& on_available) {
+    {
+        std::lock_guard lock{mutex_};
+        if (max_sessions_ != 0 && active_sessions_ >= max_sessions_) {
+            waiters_.push_back(std::move(on_available));
+            return std::nullopt;
+        }
+        ++active_sessions_;
+    }
+    return Permit{shared_from_this()};
+}
+
+std::size_t SessionLimiter::GetActiveSessions() const {
+    std::lock_guard lock{mutex_};
+    return active_sessions_;
+}
+
+void SessionLimiter::Release() {
+    Waiter waiter;
+    {
+        std::lock_guard lock{mutex_};
+        --active_sessions_;
+        if (!waiters_.empty()) {
+            waiter = std::move(waiters_.front());
+            waiters_.pop_front();
+        }
+    }
+    // Ожидающего вызываем вне блокировки: он сразу попробует получить разрешение
+    if (waiter) {
+        waiter();
+    }
+}
+
+}  // namespace http_server
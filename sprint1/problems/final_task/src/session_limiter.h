@@ -0,0 +1,65 @@
+// src/session_limiter.h
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+
+#include "small_function.h"
+
+namespace http_server {
+
+// Ограничивает число одновременно открытых сессий. Один ограничитель может быть общим
+// для нескольких Listener (например, для всех шардов сервера).
+// Место под сессию выдаётся в виде разрешения (Permit), которое возвращается при его уничтожении
+class SessionLimiter : public std::enable_shared_from_this<SessionLimiter> {
+public:
+    // Вызывается, когда после неудачной попытки получить разрешение освободилось место
+    using Waiter = SmallFunction<void()>;
+
+    class Permit {
+    public:
+        Permit(Permit&& other) noexcept = default;
+        Permit& operator=(Permit&& other) noexcept;
+        Permit(const Permit&) = delete;
+        Permit& operator=(const Permit&) = delete;
+        ~Permit();
+
+    private:
+        friend class SessionLimiter;
+        explicit Permit(std::shared_ptr<SessionLimiter> limiter) noexcept
+            : limiter_(std::move(limiter)) {
+        }
+
+        std::shared_ptr<SessionLimiter> limiter_;
+    };
+
+    // max_sessions == 0 — без ограничения
+    explicit SessionLimiter(std::size_t max_sessions)
+        : max_sessions_(max_sessions) {
+    }
+
+    SessionLimiter(const SessionLimiter&) = delete;
+    SessionLimiter& operator=(const SessionLimiter&) = delete;
+
+    // Выдаёт разрешение на новую сессию. Если мест нет, возвращает nullopt и запоминает
+    // on_available: он будет вызван один раз, когда одна из сессий завершится.
+    // После этого вызывающий должен повторить попытку сам
+    std::optional<Permit> TryAcquire(Waiter&& on_available);
+
+    std::size_t GetActiveSessions() const;
+    std::size_t GetMaxSessions() const noexcept {
+        return max_sessions_;
+    }
+
+private:
+    void Release();
+
+    const std::size_t max_sessions_;
+    mutable std::mutex mutex_;
+    std::size_t active_sessions_ = 0;
+    std::deque<Waiter> waiters_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,85 @@
+// src/session_pool.h
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace http_server {
+
+// Счётчики пула сессий. Могут быть общими для нескольких пулов (например, для всех шардов)
+struct SessionPoolStats {
+    // Соединение получило сессию из пула
+    std::atomic<std::uint64_t> hits{0};
+    // Пул был пуст, сессия создана заново
+    std::atomic<std::uint64_t> misses{0};
+    // Завершившаяся сессия вернулась в пул
+    std::atomic<std::uint64_t> returns{0};
+    // Пул был полон, завершившаяся сессия уничтожена
+    std::atomic<std::uint64_t> drops{0};
+
+    // Доля соединений, получивших сессию из пула
+    double GetHitRate() const noexcept {
+        const auto hit_count = hits.load(std::memory_order_relaxed);
+        const auto total = hit_count + misses.load(std::memory_order_relaxed);
+        return total != 0 ? static_cast<double>(hit_count) / static_cast<double>(total) : 0.0;
+    }
+};
+
+// Ограниченный пул объектов для повторного использования. Объекты хранятся в стеке:
+// первым выдаётся последний возвращённый, чья память ещё, скорее всего, в кеше процессора.
+// Место под max_size объектов резервируется заранее, поэтому Put не выделяет память и не
+// выбрасывает исключений. Можно использовать из нескольких потоков
+template <typename T>
+class ObjectPool {
+public:
+    // max_size == 0 — пул ничего не хранит, но продолжает вести статистику
+    ObjectPool(std::size_t max_size, std::shared_ptr<SessionPoolStats> stats)
+        : max_size_(max_size)
+        , stats_(stats ? std::move(stats) : std::make_shared<SessionPoolStats>()) {
+        objects_.reserve(max_size_);
+    }
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Выдаёт объект из пула или nullptr, если пул пуст
+    std::unique_ptr<T> Take() {
+        std::unique_ptr<T> object;
+        {
+            std::lock_guard lock{mutex_};
+            if (!objects_.empty()) {
+                object = std::move(objects_.back());
+                objects_.pop_back();
+            }
+        }
+        (object ? stats_->hits : stats_->misses).fetch_add(1, std::memory_order_relaxed);
+        return object;
+    }
+
+    // Возвращает объект в пул. Если пул полон, объект уничтожается
+    void Put(std::unique_ptr<T> object) noexcept {
+        {
+            std::lock_guard lock{mutex_};
+            if (objects_.size() < max_size_) {
+                objects_.push_back(std::move(object));
+            }
+        }
+        // Лишний объект уничтожается вне блокировки
+        (object ? stats_->drops : stats_->returns).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const SessionPoolStats& GetStats() const noexcept {
+        return *stats_;
+    }
+
+private:
+    const std::size_t max_size_;
+    std::shared_ptr<SessionPoolStats> stats_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<T>> objects_;
+};
+
+}  // namespace http_server
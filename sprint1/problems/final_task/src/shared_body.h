@@ -0,0 +1,273 @@
+// src/shared_body.h
+#pragma once
+#include "sdk.h"
+//
+#include <boost/asio/buffer.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/optional.hpp>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace http_server {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+
+// Неизменяемый буфер с подсчётом ссылок. Один и тот же буфер может одновременно
+// отправляться в любое число сокетов
+using SharedBuffer = std::shared_ptr<const std::string>;
+
+inline SharedBuffer MakeSharedBuffer(std::string data) {
+    return std::make_shared<const std::string>(std::move(data));
+}
+
+// Тело HTTP-сообщения для Beast, ссылающееся на SharedBuffer.
+// В отличие от http::string_body, при формировании ответа тело не копируется:
+// сериализатор отдаёт в сокет непосредственно содержимое разделяемого буфера
+struct SharedBufferBody {
+    using value_type = SharedBuffer;
+
+    static std::uint64_t size(const value_type& body) noexcept {
+        return body ? body->size() : 0;
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, typename Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body) {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (!body_ || body_->empty()) {
+                return boost::none;
+            }
+            return {{net::const_buffer(body_->data(), body_->size()), false}};
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+using SharedResponse = http::response<SharedBufferBody>;
+
+// Тело HTTP-сообщения для Beast — участок памяти, которым владеет owner (например, файл,
+// отображённый в память). Как и SharedBufferBody, отправляется без копирования
+struct SpanBody {
+    struct value_type {
+        // Удерживает память data, пока ответ не отправлен
+        std::shared_ptr<const void> owner;
+        net::const_buffer data;
+    };
+
+    static std::uint64_t size(const value_type& body) noexcept {
+        return body.data.size();
+    }
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, typename Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body) {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (body_.data.size() == 0) {
+                return boost::none;
+            }
+            return {{body_.data, false}};
+        }
+
+    private:
+        const value_type& body_;
+    };
+};
+
+using SpanResponse = http::response<SpanBody>;
+
+// Источник тела, которое формируется по частям во время отправки
+class BodyStream {
+public:
+    virtual ~BodyStream() = default;
+
+    // Дописывает в buffer следующую часть тела. Возвращает false, когда тело закончилось
+    virtual bool Next(std::string& buffer) = 0;
+};
+
+// Тело HTTP-сообщения для Beast, которое сериализуется по мере отправки. Размер заранее
+// неизвестен, поэтому prepare_payload включает для HTTP/1.1 Transfer-Encoding: chunked,
+// и первые части уходят клиенту до того, как сформировано всё тело.
+// В памяти одновременно находится только одна часть
+struct StreamBody {
+    using value_type = std::unique_ptr<BodyStream>;
+
+    class writer {
+    public:
+        using const_buffers_type = net::const_buffer;
+
+        template <bool isRequest, typename Fields>
+        writer(const http::header<isRequest, Fields>&, const value_type& body)
+            : body_(body) {
+        }
+
+        void init(beast::error_code& ec) {
+            ec = {};
+        }
+
+        boost::optional<std::pair<const_buffers_type, bool>> get(beast::error_code& ec) {
+            ec = {};
+            if (!body_ || done_) {
+                return boost::none;
+            }
+            // Прежняя часть уже отправлена, её буфер используется для следующей
+            buffer_.clear();
+            bool more = true;
+            while (buffer_.empty() && more) {
+                more = body_->Next(buffer_);
+            }
+            done_ = !more;
+            if (buffer_.empty()) {
+                return boost::none;
+            }
+            return {{net::const_buffer(buffer_.data(), buffer_.size()), more}};
+        }
+
+    private:
+        const value_type& body_;
+        std::string buffer_;
+        bool done_ = false;
+    };
+};
+
+using StreamResponse = http::response<StreamBody>;
+
+// Заранее подготовленный ответ: строка статуса и заголовки сериализуются один раз при создании,
+// тело хранится в разделяемом буфере. Не содержит заголовка Connection - он зависит от запроса
+// и дописывается при отправке (см. CachedResponse)
+class PreparedResponse {
+public:
+    // header - статус и заголовки ответа. Content-Length вычисляется по телу,
+    // заголовки Connection, Content-Length и Transfer-Encoding из header игнорируются.
+    // Ответы без тела (1xx, 204, 304) создаются с пустым body
+    template <typename Fields>
+    PreparedResponse(const http::response_header<Fields>& header, SharedBuffer body)
+        : body_(body ? std::move(body) : MakeSharedBuffer({})) {
+        header_block_.reserve(256);
+        header_block_ += "HTTP/1.1 ";
+        header_block_ += std::to_string(header.result_int());
+        header_block_ += ' ';
+        header_block_ += std::string_view(header.reason().data(), header.reason().size());
+        header_block_ += "\r\n";
+        for (const auto& field : header) {
+            if (field.name() == http::field::connection || field.name() == http::field::content_length
+                || field.name() == http::field::transfer_encoding) {
+                continue;
+            }
+            header_block_ += std::string_view(field.name_string().data(), field.name_string().size());
+            header_block_ += ": ";
+            header_block_ += std::string_view(field.value().data(), field.value().size());
+            header_block_ += "\r\n";
+        }
+        status_ = header.result();
+        // У 1xx, 204 и 304 тела нет по определению, и Content-Length для них не отправляется:
+        // для 304 он означал бы длину тела ответа 200, а не пустого тела
+        const auto code = header.result_int();
+        if (code >= 200 && code != 204 && code != 304) {
+            header_block_ += "Content-Length: ";
+            header_block_ += std::to_string(body_->size());
+            header_block_ += "\r\n";
+        }
+    }
+
+    http::status GetStatus() const noexcept {
+        return status_;
+    }
+
+    // Строка статуса и заголовки, каждая строка завершена CRLF, без завершающей пустой строки
+    const std::string& GetHeaderBlock() const noexcept {
+        return header_block_;
+    }
+
+    const SharedBuffer& GetBody() const noexcept {
+        return body_;
+    }
+
+private:
+    http::status status_;
+    std::string header_block_;
+    SharedBuffer body_;
+};
+
+using PreparedResponsePtr = std::shared_ptr<const PreparedResponse>;
+
+// Создаёт подготовленный ответ с заданным статусом, типом содержимого и телом
+inline PreparedResponsePtr MakePreparedResponse(http::status status, beast::string_view content_type,
+                                                std::string body) {
+    http::response_header<> header;
+    header.result(status);
+    header.set(http::field::content_type, content_type);
+    return std::make_shared<const PreparedResponse>(header, MakeSharedBuffer(std::move(body)));
+}
+
+// Подготовленный ответ, привязанный к конкретному запросу.
+// Отправляется без сериализации: в сокет пишутся заголовки PreparedResponse, заголовок Connection
+// (из статической строки) и разделяемое тело
+struct CachedResponse {
+    PreparedResponsePtr response;
+    unsigned version = 11;
+    bool keep_alive = true;
+    // Ответ на HEAD: заголовки (с Content-Length тела) отправляются, тело — нет (RFC 9110, 9.3.2)
+    bool head_only = false;
+
+    // Нужно ли закрыть соединение после отправки ответа
+    bool need_eof() const noexcept {
+        return !keep_alive;
+    }
+
+    // Буферы, которые нужно записать в сокет. Действительны, пока жив объект
+    std::array<net::const_buffer, 3> GetBuffers() const noexcept {
+        using namespace std::literals;
+        // Для HTTP/1.1 соединение по умолчанию постоянное, для HTTP/1.0 - наоборот
+        static constexpr auto END_OF_HEADER = "\r\n"sv;
+        static constexpr auto KEEP_ALIVE = "Connection: keep-alive\r\n\r\n"sv;
+        static constexpr auto CLOSE = "Connection: close\r\n\r\n"sv;
+
+        std::string_view connection = END_OF_HEADER;
+        if (keep_alive && version < 11) {
+            connection = KEEP_ALIVE;
+        } else if (!keep_alive && version >= 11) {
+            connection = CLOSE;
+        }
+
+        const auto& header_block = response->GetHeaderBlock();
+        const auto& body = *response->GetBody();
+        return {
+            net::const_buffer(header_block.data(), header_block.size()),
+            net::const_buffer(connection.data(), connection.size()),
+            head_only ? net::const_buffer() : net::const_buffer(body.data(), body.size()),
+        };
+    }
+};
+
+}  // namespace http_server
@@ -0,0 +1,256 @@
+// src/singleflight.h
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "shared_body.h"
+
+namespace http_server {
+
+// Счётчики объединения запросов, могут быть общими для нескольких StreamFlights
+struct CoalescingStats {
+    // Запрос начал формировать тело сам
+    std::atomic<std::uint64_t> leaders{0};
+    // Запрос получил тело, которое уже формировалось для другого запроса
+    std::atomic<std::uint64_t> followers{0};
+
+    // Доля запросов, получивших чужое тело
+    double GetCoalescingRatio() const noexcept {
+        const auto follower_count = followers.load(std::memory_order_relaxed);
+        const auto total = follower_count + leaders.load(std::memory_order_relaxed);
+        return total != 0 ? static_cast<double>(follower_count) / static_cast<double>(total) : 0.0;
+    }
+};
+
+// Тело, которое формирует один BodyStream, а отправляют несколько ответов (singleflight).
+// Каждый ответ читает тело своим потоком (Join). Часть тела формируется один раз — тем, кто
+// первым до неё дошёл, — и хранится, пока её не прочитают все. Присоединиться можно, пока
+// сформированные части занимают не больше max_retained байт: присоединившийся читает тело
+// с начала. После этого хранятся только части, которые ещё не прочитал самый медленный ответ.
+// Можно использовать из нескольких потоков
+class SharedStream : public std::enable_shared_from_this<SharedStream> {
+public:
+    // owner удерживается, пока тело читает хотя бы один ответ: например, то, на что ссылается source
+    SharedStream(std::unique_ptr<BodyStream> source, std::size_t max_retained, std::shared_ptr<const void> owner = {})
+        : source_(std::move(source))
+        , max_retained_(max_retained)
+        , owner_(std::move(owner)) {
+    }
+
+    SharedStream(const SharedStream&) = delete;
+    SharedStream& operator=(const SharedStream&) = delete;
+
+    // Поток, читающий тело с начала, или nullptr, если присоединиться уже нельзя
+    std::unique_ptr<BodyStream> Join();
+
+private:
+    class Reader;
+
+    static constexpr std::size_t FINISHED = std::numeric_limits<std::size_t>::max();
+
+    bool Next(std::size_t reader, std::string& buffer);
+    void Leave(std::size_t reader) noexcept;
+    // Освобождает части, которые прочитали все. Вызывается под mutex_
+    void DropRead() noexcept;
+
+    std::mutex mutex_;
+    std::unique_ptr<BodyStream> source_;
+    std::size_t max_retained_;
+    std::shared_ptr<const void> owner_;
+    // Хранимые части, первая из них имеет номер first_part_
+    std::deque<std::string> parts_;
+    std::size_t first_part_ = 0;
+    std::size_t retained_ = 0;
+    // Номер следующей части для каждого ответа, FINISHED — ответ дочитал или брошен
+    std::vector<std::size_t> positions_;
+    bool open_ = true;
+    bool done_ = false;
+    bool failed_ = false;
+};
+
+class SharedStream::Reader final : public BodyStream {
+public:
+    Reader(std::shared_ptr<SharedStream> stream, std::size_t index) noexcept
+        : stream_(std::move(stream))
+        , index_(index) {
+    }
+
+    Reader(const Reader&) = delete;
+    Reader& operator=(const Reader&) = delete;
+
+    ~Reader() override {
+        stream_->Leave(index_);
+    }
+
+    bool Next(std::string& buffer) override {
+        return stream_->Next(index_, buffer);
+    }
+
+private:
+    std::shared_ptr<SharedStream> stream_;
+    std::size_t index_;
+};
+
+inline std::unique_ptr<BodyStream> SharedStream::Join() {
+    std::lock_guard lock{mutex_};
+    if (!open_) {
+        return nullptr;
+    }
+    positions_.push_back(0);
+    return std::make_unique<Reader>(shared_from_this(), positions_.size() - 1);
+}
+
+inline bool SharedStream::Next(std::size_t reader, std::string& buffer) {
+    std::lock_guard lock{mutex_};
+    auto& position = positions_[reader];
+    if (position == FINISHED) {
+        return false;
+    }
+    if (position < first_part_ + parts_.size()) {
+        buffer += parts_[position - first_part_];
+        ++position;
+    } else if (done_) {
+        position = FINISHED;
+        DropRead();
+        return false;
+    } else {
+        if (failed_) {
+            throw std::runtime_error("Shared response body failed");
+        }
+        std::string part;
+        bool more = false;
+        try {
+            more = source_->Next(part);
+        } catch (...) {
+            // Остальные ответы узнают об ошибке, дойдя до этой части
+            failed_ = true;
+            open_ = false;
+            throw;
+        }
+        if (!more) {
+            done_ = true;
+            open_ = false;
+            source_.reset();
+        }
+        if (part.empty()) {
+            if (done_) {
+                position = FINISHED;
+                DropRead();
+            }
+            return !done_;
+        }
+        buffer += part;
+        retained_ += part.size();
+        parts_.push_back(std::move(part));
+        ++position;
+        if (retained_ > max_retained_) {
+            open_ = false;
+        }
+    }
+    DropRead();
+    return true;
+}
+
+inline void SharedStream::Leave(std::size_t reader) noexcept {
+    std::lock_guard lock{mutex_};
+    positions_[reader] = FINISHED;
+    DropRead();
+}
+
+inline void SharedStream::DropRead() noexcept {
+    // Пока можно присоединиться, новый ответ прочитает тело с начала
+    if (open_) {
+        return;
+    }
+    std::size_t slowest = FINISHED;
+    for (const auto position : positions_) {
+        slowest = std::min(slowest, position);
+    }
+    while (!parts_.empty() && first_part_ < slowest) {
+        retained_ -= parts_.front().size();
+        parts_.pop_front();
+        ++first_part_;
+    }
+}
+
+// Тела, которые сейчас формируются, по ключу. Запрос с ключом, тело для которого ещё формируется
+// и к которому можно присоединиться, получает его, а не формирует своё (см. SharedStream).
+// Тело не кешируется: когда его дочитали все ответы, следующий запрос формирует его заново.
+// Ключ должен включать всё, от чего зависит тело. Можно использовать из нескольких потоков
+template <typename Key, typename Hash = std::hash<Key>>
+class StreamFlights {
+public:
+    explicit StreamFlights(std::shared_ptr<CoalescingStats> stats = nullptr)
+        : stats_(stats ? std::move(stats) : std::make_shared<CoalescingStats>()) {
+    }
+
+    StreamFlights(const StreamFlights&) = delete;
+    StreamFlights& operator=(const StreamFlights&) = delete;
+
+    // Присоединяется к телу с ключом key. nullptr — такое тело сейчас не формируется
+    std::unique_ptr<BodyStream> Join(const Key& key) {
+        std::lock_guard lock{mutex_};
+        return JoinLocked(key);
+    }
+
+    // Присоединяется к телу с ключом key, а если его нет, начинает новое: make_source() возвращает
+    // источник тела (nullptr — тело сформировать нельзя, тогда и результат nullptr).
+    // max_retained и owner — см. SharedStream
+    template <typename MakeSource>
+    std::unique_ptr<BodyStream> JoinOrStart(const Key& key, MakeSource&& make_source, std::size_t max_retained,
+                                            std::shared_ptr<const void> owner = {}) {
+        std::lock_guard lock{mutex_};
+        if (auto reader = JoinLocked(key)) {
+            return reader;
+        }
+        auto source = make_source();
+        if (!source) {
+            return nullptr;
+        }
+        // Заодно забываются тела, которые уже никто не читает
+        std::erase_if(flights_, [](const auto& flight) {
+            return flight.second.expired();
+        });
+        auto stream = std::make_shared<SharedStream>(std::move(source), max_retained, std::move(owner));
+        flights_.insert_or_assign(key, stream);
+        stats_->leaders.fetch_add(1, std::memory_order_relaxed);
+        return stream->Join();
+    }
+
+    const CoalescingStats& GetStats() const noexcept {
+        return *stats_;
+    }
+
+private:
+    std::unique_ptr<BodyStream> JoinLocked(const Key& key) {
+        const auto it = flights_.find(key);
+        if (it == flights_.end()) {
+            return nullptr;
+        }
+        if (auto stream = it->second.lock()) {
+            if (auto reader = stream->Join()) {
+                stats_->followers.fetch_add(1, std::memory_order_relaxed);
+                return reader;
+            }
+        }
+        return nullptr;
+    }
+
+    std::shared_ptr<CoalescingStats> stats_;
+    std::mutex mutex_;
+    // Тело удерживают читающие его ответы, таблица только находит его
+    std::unordered_map<Key, std::weak_ptr<SharedStream>, Hash> flights_;
+};
+
+}  // namespace http_server
@@ -0,0 +1,124 @@
+// src/small_function.h
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace http_server {
+
+template <typename Signature, std::size_t BufferSize = 4 * sizeof(void*)>
+class SmallFunction;
+
+// Перемещаемая, но не копируемая замена std::function.
+// Функциональный объект размером до BufferSize байт хранится внутри SmallFunction,
+// больший — в куче. В отличие от std::function, SmallFunction подходит для
+// некопируемых объектов (например, лямбд, захвативших ответ или unique_ptr).
+template <typename R, typename... Args, std::size_t BufferSize>
+class SmallFunction<R(Args...), BufferSize> {
+public:
+    SmallFunction() noexcept = default;
+
+    template <typename F, typename Fn = std::decay_t<F>,
+              typename = std::enable_if_t<!std::is_same_v<Fn, SmallFunction> && std::is_invocable_r_v<R, Fn&, Args...>>>
+    SmallFunction(F&& f) {
+        if constexpr (FitsBuffer<Fn>()) {
+            new (&storage_) Fn(std::forward<F>(f));
+        } else {
+            *reinterpret_cast<Fn**>(&storage_) = new Fn(std::forward<F>(f));
+        }
+        ops_ = &OPS<Fn>;
+    }
+
+    SmallFunction(SmallFunction&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    SmallFunction& operator=(SmallFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    SmallFunction(const SmallFunction&) = delete;
+    SmallFunction& operator=(const SmallFunction&) = delete;
+
+    ~SmallFunction() {
+        Reset();
+    }
+
+    R operator()(Args... args) {
+        return ops_->invoke(&storage_, std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept {
+        return ops_ != nullptr;
+    }
+
+private:
+    struct Ops {
+        R (*invoke)(void* storage, Args&&... args);
+        // Переносит объект из from в пустое хранилище to и уничтожает его в from
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Fn>
+    static constexpr bool FitsBuffer() {
+        return sizeof(Fn) <= BufferSize && alignof(Fn) <= alignof(std::max_align_t)
+               && std::is_nothrow_move_constructible_v<Fn>;
+    }
+
+    template <typename Fn>
+    static Fn& Get(void* storage) noexcept {
+        if constexpr (FitsBuffer<Fn>()) {
+            return *std::launder(reinterpret_cast<Fn*>(storage));
+        } else {
+            return **reinterpret_cast<Fn**>(storage);
+        }
+    }
+
+    template <typename Fn>
+    static constexpr Ops OPS{
+        [](void* storage, Args&&... args) -> R {
+            return Get<Fn>(storage)(std::forward<Args>(args)...);
+        },
+        [](void* from, void* to) noexcept {
+            if constexpr (FitsBuffer<Fn>()) {
+                Fn& fn = Get<Fn>(from);
+                new (to) Fn(std::move(fn));
+                fn.~Fn();
+            } else {
+                // Объект в куче не перемещается, передаётся только указатель
+                *reinterpret_cast<Fn**>(to) = *reinterpret_cast<Fn**>(from);
+            }
+        },
+        [](void* storage) noexcept {
+            if constexpr (FitsBuffer<Fn>()) {
+                Get<Fn>(storage).~Fn();
+            } else {
+                delete *reinterpret_cast<Fn**>(storage);
+            }
+        },
+    };
+
+    void MoveFrom(SmallFunction& other) noexcept {
+        if (other.ops_) {
+            other.ops_->move(&other.storage_, &storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+
+    void Reset() noexcept {
+        if (ops_) {
+            std::exchange(ops_, nullptr)->destroy(&storage_);
+        }
+    }
+
+    alignas(std::max_align_t) std::byte storage_[BufferSize < sizeof(void*) ? sizeof(void*) : BufferSize];
+    const Ops* ops_ = nullptr;
+};
+
+}  // namespace http_server
@@ -0,0 +1,60 @@
+// src/snapshot.cpp
+#include "snapshot.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace util {
+
+thread_local EpochDomain::ThreadSlot EpochDomain::this_thread_slot_;
+
+EpochDomain& EpochDomain::GetInstance() {
+    static EpochDomain domain;
+    return domain;
+}
+
+EpochDomain::Slot& EpochDomain::GetThreadSlot() {
+    if (this_thread_slot_.slot) {
+        return *this_thread_slot_.slot;
+    }
+    for (std::size_t i = 0; i < MAX_READERS; ++i) {
+        auto& slot = slots_[i];
+        if (!slot.owned.load(std::memory_order_relaxed) && !slot.owned.exchange(true, std::memory_order_acquire)) {
+            auto used = used_slots_.load();
+            while (used < i + 1 && !used_slots_.compare_exchange_weak(used, i + 1)) {
+            }
+            this_thread_slot_.slot = &slot;
+            return slot;
+        }
+    }
+    throw std::length_error("Too many threads read snapshots");
+}
+
+EpochDomain::ReadSection::ReadSection(EpochDomain& domain)
+    : domain_(domain) {
+    auto& slot = domain_.GetThreadSlot();
+    if (this_thread_slot_.depth++ == 0) {
+        // Отметка эпохи и последующее чтение указателя на снимок упорядочены (seq_cst): писатель,
+        // не увидевший отметку, уже заменил снимок, и читатель получит новый
+        slot.epoch.store(domain_.epoch_.load());
+    }
+}
+
+EpochDomain::ReadSection::~ReadSection() {
+    if (--this_thread_slot_.depth == 0) {
+        this_thread_slot_.slot->epoch.store(0, std::memory_order_release);
+    }
+}
+
+std::uint64_t EpochDomain::GetOldestReaderEpoch() const noexcept {
+    auto oldest = epoch_.load();
+    const auto used = used_slots_.load();
+    for (std::size_t i = 0; i < used; ++i) {
+        if (const auto epoch = slots_[i].epoch.load(); epoch != 0) {
+            oldest = std::min(oldest, epoch);
+        }
+    }
+    return oldest;
+}
+
+}  // namespace util
@@ -0,0 +1,193 @@
+// src/snapshot.h
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace util {
+
+// Эпохи для освобождения памяти, которую читают без блокировок (epoch-based reclamation).
+// Читатель на время чтения отмечает в своём слоте эпоху, в которую начал читать. Писатель,
+// убрав объект из общего доступа, переводит эпоху вперёд и запоминает, в какой эпохе убрал
+// объект: когда все читающие отметили более позднюю эпоху, объект никто уже не видит.
+// Чтение не ждёт писателя и не пишет в общие с другими потоками строки кэша.
+// Слот закрепляется за потоком при первом чтении и освобождается, когда поток завершается.
+// Все каналы снимков используют одни и те же эпохи (GetInstance)
+class EpochDomain {
+public:
+    // Сколько потоков могут читать одновременно
+    static constexpr std::size_t MAX_READERS = 1024;
+
+    static EpochDomain& GetInstance();
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Чтение, пока объект жив. Вложенные чтения в одном потоке разрешены
+    class ReadSection {
+    public:
+        explicit ReadSection(EpochDomain& domain);
+        ~ReadSection();
+
+        ReadSection(const ReadSection&) = delete;
+        ReadSection& operator=(const ReadSection&) = delete;
+
+    private:
+        EpochDomain& domain_;
+    };
+
+    // Переводит эпоху вперёд. Объект, убранный из общего доступа до вызова, можно освободить,
+    // когда GetOldestReaderEpoch станет больше возвращённой эпохи
+    std::uint64_t Advance() noexcept {
+        return epoch_.fetch_add(1);
+    }
+
+    // Наименьшая эпоха, отмеченная читающими сейчас потоками. Если никто не читает — текущая эпоха
+    std::uint64_t GetOldestReaderEpoch() const noexcept;
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<bool> owned{false};
+        // 0 — поток слота не читает
+        std::atomic<std::uint64_t> epoch{0};
+    };
+
+    // Слот, закреплённый за потоком. Освобождается, когда поток завершается
+    struct ThreadSlot {
+        Slot* slot = nullptr;
+        // Глубина вложенных чтений
+        unsigned depth = 0;
+
+        ~ThreadSlot() {
+            if (slot) {
+                slot->owned.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    EpochDomain() = default;
+
+    // Слот текущего потока. Бросает std::length_error, если все слоты заняты
+    Slot& GetThreadSlot();
+
+    // Эпохи начинаются с 1, чтобы не совпадать с отметкой «не читает»
+    std::atomic<std::uint64_t> epoch_{1};
+    // Слоты с номерами не меньше этого ни разу не выдавались, их писатель не просматривает
+    std::atomic<std::size_t> used_slots_{0};
+    std::array<Slot, MAX_READERS> slots_;
+
+    static thread_local ThreadSlot this_thread_slot_;
+};
+
+// Канал неизменяемых снимков (RCU): писатель публикует снимок целиком, заменяя указатель
+// на текущий атомарно, а читатели берут текущий снимок без блокировок. Читатель и писатель
+// не ждут друг друга: снимок, который кто-то читает, не переписывается, а писатель берёт для
+// следующего снимка буфер, который уже никто не читает, или создаёт новый.
+// Писатель должен быть один в каждый момент времени. Читать можно из любого потока.
+// Канал уничтожается, когда читателей нет
+template <typename T>
+class SnapshotChannel {
+public:
+    SnapshotChannel() = default;
+    SnapshotChannel(const SnapshotChannel&) = delete;
+    SnapshotChannel& operator=(const SnapshotChannel&) = delete;
+
+    ~SnapshotChannel() {
+        delete current_.load();
+    }
+
+    // Текущий снимок. Пока Reader жив, снимок не меняется и не освобождается
+    class Reader {
+    public:
+        explicit Reader(const SnapshotChannel& channel)
+            : section_(EpochDomain::GetInstance())
+            , snapshot_(channel.current_.load()) {
+        }
+
+        // nullptr, если снимков ещё не было
+        const T* Get() const noexcept {
+            return snapshot_;
+        }
+
+        const T& operator*() const noexcept {
+            return *snapshot_;
+        }
+
+        const T* operator->() const noexcept {
+            return snapshot_;
+        }
+
+        explicit operator bool() const noexcept {
+            return snapshot_ != nullptr;
+        }
+
+    private:
+        EpochDomain::ReadSection section_;
+        const T* snapshot_;
+    };
+
+    Reader Read() const {
+        return Reader{*this};
+    }
+
+    // Буфер следующего снимка. Это один из прежних снимков, который никто уже не читает,
+    // или новый объект: писатель заполняет его целиком, а пока не опубликовал, может
+    // получать его повторно
+    T& GetNextBuffer() {
+        if (!next_) {
+            Reclaim();
+            if (!free_.empty()) {
+                next_ = std::move(free_.back());
+                free_.pop_back();
+            } else {
+                next_ = std::make_unique<T>();
+            }
+        }
+        return *next_;
+    }
+
+    // Делает буфер следующего снимка текущим снимком
+    void Publish() {
+        GetNextBuffer();
+        if (T* previous = current_.exchange(next_.release())) {
+            retired_.push_back({std::unique_ptr<T>{previous}, EpochDomain::GetInstance().Advance()});
+        }
+    }
+
+private:
+    // Снимок, который ещё могут читать
+    struct Retired {
+        std::unique_ptr<T> snapshot;
+        // Эпоха, в которую снимок перестал быть текущим
+        std::uint64_t epoch;
+    };
+
+    // Сколько освободившихся снимков хранится для повторного использования. Больше одного
+    // нужно, только пока медленный читатель держит старый снимок
+    static constexpr std::size_t MAX_FREE_BUFFERS = 2;
+
+    // Переносит снимки, которые никто не читает, в свободные буферы
+    void Reclaim() {
+        const auto oldest_reader = EpochDomain::GetInstance().GetOldestReaderEpoch();
+        std::size_t reclaimed = 0;
+        // Снимки убраны в порядке возрастания эпох
+        while (reclaimed < retired_.size() && retired_[reclaimed].epoch < oldest_reader) {
+            if (free_.size() < MAX_FREE_BUFFERS) {
+                free_.push_back(std::move(retired_[reclaimed].snapshot));
+            }
+            ++reclaimed;
+        }
+        retired_.erase(retired_.begin(), retired_.begin() + static_cast<std::ptrdiff_t>(reclaimed));
+    }
+
+    std::atomic<T*> current_{nullptr};
+    // Дальше — состояние писателя
+    std::unique_ptr<T> next_;
+    std::vector<Retired> retired_;
+    std::vector<std::unique_ptr<T>> free_;
+};
+
+}  // namespace util
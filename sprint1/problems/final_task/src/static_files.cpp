@@ -0,0 +1,659 @@
+// src/static_files.cpp
+#include "static_files.h"
+
+#include "content_coding.h"
+#include "content_type.h"
+#include "embedded_static.h"
+#include "etag.h"
+#include "gzip.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cctype>
+#include <charconv>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace http_handler {
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+namespace net = boost::asio;
+using namespace std::literals;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<std::string_view, 7> WEEKDAYS = {"Sun"sv, "Mon"sv, "Tue"sv, "Wed"sv, "Thu"sv, "Fri"sv, "Sat"sv};
+constexpr std::array<std::string_view, 12> MONTHS = {"Jan"sv, "Feb"sv, "Mar"sv, "Apr"sv, "May"sv, "Jun"sv,
+                                                     "Jul"sv, "Aug"sv, "Sep"sv, "Oct"sv, "Nov"sv, "Dec"sv};
+
+// Дата в формате IMF-fixdate (RFC 9110, 5.6.7): "Sun, 06 Nov 1994 08:49:37 GMT".
+// Не зависит от локали
+std::string FormatHttpDate(std::time_t time) {
+    std::tm tm{};
+    gmtime_r(&time, &tm);
+    auto two_digits = [](std::string& out, int value) {
+        out += static_cast<char>('0' + value / 10);
+        out += static_cast<char>('0' + value % 10);
+    };
+    std::string result;
+    result.reserve(29);
+    result += WEEKDAYS[tm.tm_wday];
+    result += ", "sv;
+    two_digits(result, tm.tm_mday);
+    result += ' ';
+    result += MONTHS[tm.tm_mon];
+    result += ' ';
+    result += std::to_string(tm.tm_year + 1900);
+    result += ' ';
+    two_digits(result, tm.tm_hour);
+    result += ':';
+    two_digits(result, tm.tm_min);
+    result += ':';
+    two_digits(result, tm.tm_sec);
+    result += " GMT"sv;
+    return result;
+}
+
+// Разбирает дату в формате IMF-fixdate. Устаревшие форматы RFC 850 и asctime не поддерживаются:
+// такой заголовок игнорируется, и клиент получает файл целиком
+std::optional<std::time_t> ParseHttpDate(std::string_view value) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT"
+    if (value.size() != 29 || value.substr(3, 2) != ", "sv || value.substr(25) != " GMT"sv) {
+        return std::nullopt;
+    }
+    auto number = [&](std::size_t pos, std::size_t size) -> std::optional<int> {
+        int result = 0;
+        const auto [ptr, ec] = std::from_chars(value.data() + pos, value.data() + pos + size, result);
+        if (ec != std::errc{} || ptr != value.data() + pos + size) {
+            return std::nullopt;
+        }
+        return result;
+    };
+    const auto month = std::find(MONTHS.begin(), MONTHS.end(), value.substr(8, 3));
+    const auto day = number(5, 2);
+    const auto year = number(12, 4);
+    const auto hour = number(17, 2);
+    const auto minute = number(20, 2);
+    const auto second = number(23, 2);
+    if (month == MONTHS.end() || !day || !year || !hour || !minute || !second) {
+        return std::nullopt;
+    }
+    std::tm tm{};
+    tm.tm_year = *year - 1900;
+    tm.tm_mon = static_cast<int>(month - MONTHS.begin());
+    tm.tm_mday = *day;
+    tm.tm_hour = *hour;
+    tm.tm_min = *minute;
+    tm.tm_sec = *second;
+    return timegm(&tm);
+}
+
+struct ByteRange {
+    enum class Kind {
+        // Заголовка нет, он некорректен или задаёт несколько диапазонов: отправляется весь файл
+        NONE,
+        // Диапазон за пределами файла: 416 Range Not Satisfiable
+        UNSATISFIABLE,
+        VALID,
+    };
+    Kind kind = Kind::NONE;
+    std::uint64_t first = 0;
+    std::uint64_t last = 0;
+};
+
+// Разбирает заголовок Range (RFC 9110, 14.2) для файла размера size.
+// Поддерживается один диапазон: "bytes=first-last", "bytes=first-" и "bytes=-suffix"
+ByteRange ParseRange(std::string_view value, std::uint64_t size) {
+    constexpr auto UNIT = "bytes="sv;
+    ByteRange range;
+    if (!value.starts_with(UNIT) || value.find(',') != std::string_view::npos) {
+        return range;
+    }
+    value.remove_prefix(UNIT.size());
+    const auto dash = value.find('-');
+    if (dash == std::string_view::npos) {
+        return range;
+    }
+    auto parse = [](std::string_view text) -> std::optional<std::uint64_t> {
+        std::uint64_t result = 0;
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), result);
+        if (text.empty() || ec != std::errc{} || ptr != text.data() + text.size()) {
+            return std::nullopt;
+        }
+        return result;
+    };
+    const auto first_text = value.substr(0, dash);
+    const auto last_text = value.substr(dash + 1);
+    if (first_text.empty()) {
+        // Последние suffix байт файла
+        const auto suffix = parse(last_text);
+        if (!suffix) {
+            return range;
+        }
+        if (*suffix == 0 || size == 0) {
+            range.kind = ByteRange::Kind::UNSATISFIABLE;
+            return range;
+        }
+        range.kind = ByteRange::Kind::VALID;
+        range.first = size - std::min(*suffix, size);
+        range.last = size - 1;
+        return range;
+    }
+    const auto first = parse(first_text);
+    const auto last = last_text.empty() ? std::optional<std::uint64_t>{UINT64_MAX} : parse(last_text);
+    if (!first || !last || *last < *first) {
+        return range;
+    }
+    if (*first >= size) {
+        range.kind = ByteRange::Kind::UNSATISFIABLE;
+        return range;
+    }
+    range.kind = ByteRange::Kind::VALID;
+    range.first = *first;
+    range.last = std::min(*last, size - 1);
+    return range;
+}
+
+http_server::Response MakeTextResponse(const http_server::Request& req, http::status status, std::string_view text) {
+    auto res = http_server::MakeStringResponse(req, status);
+    res.set(http::field::content_type, "text/plain");
+    res.keep_alive(req.keep_alive());
+    res.body().assign(text.data(), text.size());
+    res.prepare_payload();
+    if (req.method() == http::verb::head) {
+        // Content-Length тот же, что у ответа на GET, но тела у ответа на HEAD нет
+        res.body().clear();
+    }
+    return res;
+}
+
+http_server::Response MakeRangeNotSatisfiable(const http_server::Request& req, std::uint64_t size) {
+    auto res = MakeTextResponse(req, http::status::range_not_satisfiable, "Range not satisfiable"sv);
+    std::get<http_server::StringResponse>(res).set(http::field::content_range, "bytes */" + std::to_string(size));
+    return res;
+}
+
+// Дописывает к out путь, заменяя на %XX байты, которые не могут стоять в пути URI как есть (RFC 3986, 3.3)
+void AppendEncodedPath(std::string& out, std::string_view path) {
+    constexpr auto HEX = "0123456789ABCDEF"sv;
+    constexpr auto ALLOWED = "-._~!$&'()*+,;=:@/"sv;
+    for (const char c : path) {
+        const auto byte = static_cast<unsigned char>(c);
+        if ((byte < 0x80 && std::isalnum(byte)) || ALLOWED.find(c) != std::string_view::npos) {
+            out += c;
+        } else {
+            out += '%';
+            out += HEX[byte >> 4];
+            out += HEX[byte & 0xF];
+        }
+    }
+}
+
+// Каталог запрошен без завершающего '/': клиент переходит по адресу с '/', иначе относительные
+// ссылки в index.html разрешались бы от родительского каталога. Строка запроса сохраняется.
+// Location строится из проверенного пути path (см. DecodePath), а не из target: target вида
+// "//host/dir" дал бы адрес на другом сервере
+http_server::Response MakeDirectoryRedirect(const http_server::Request& req, std::string_view path) {
+    const std::string_view target(req.target().data(), req.target().size());
+    const auto query = target.substr(std::min(target.find('?'), target.size()));
+    std::string location;
+    location.reserve(path.size() + query.size() + 2);
+    location += '/';
+    AppendEncodedPath(location, path);
+    location += '/';
+    location += query;
+    auto res = MakeTextResponse(req, http::status::moved_permanently, "Moved permanently"sv);
+    std::get<http_server::StringResponse>(res).set(http::field::location, location);
+    return res;
+}
+
+std::string FormatContentRange(const ByteRange& range, std::uint64_t size) {
+    return "bytes " + std::to_string(range.first) + '-' + std::to_string(range.last) + '/' + std::to_string(size);
+}
+
+beast::string_view ToBeast(std::string_view text) noexcept {
+    return {text.data(), text.size()};
+}
+
+bool SameTime(const std::timespec& a, const std::timespec& b) noexcept {
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+// Читает size байт открытого файла в память. Копия, в отличие от отображения, не даёт SIGBUS,
+// если файл укоротят на месте, пока его отправляют. nullopt, если файл оказался короче
+std::optional<std::string> ReadContents(int fd, std::uint64_t size) {
+    std::string contents(static_cast<std::size_t>(size), '\0');
+    std::size_t done = 0;
+    while (done < contents.size()) {
+        const auto read = ::pread(fd, contents.data() + done, contents.size() - done, static_cast<off_t>(done));
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            return std::nullopt;
+        }
+        done += static_cast<std::size_t>(read);
+    }
+    return contents;
+}
+
+// Путь, по которому на самом деле открыт файл fd, со всеми раскрытыми символическими ссылками
+std::optional<std::filesystem::path> GetOpenedPath([[maybe_unused]] int fd, const std::filesystem::path& path) {
+    std::error_code ec;
+#ifdef __linux__
+    // Ссылка на открытый дескриптор, а не повторный разбор path: файл не подменить между open и проверкой
+    auto opened = std::filesystem::read_symlink("/proc/self/fd/" + std::to_string(fd), ec);
+    if (!ec) {
+        return opened;
+    }
+#endif
+    auto canonical = std::filesystem::canonical(path, ec);
+    if (ec) {
+        return std::nullopt;
+    }
+    return canonical;
+}
+
+// Путь лежит внутри каталога root (root уже канонический)
+bool IsWithin(const std::filesystem::path& path, const std::filesystem::path& root) {
+    const auto [root_end, path_it] = std::mismatch(root.begin(), root.end(), path.begin(), path.end());
+    return root_end == root.end();
+}
+
+}  // namespace
+
+StaticFiles::StaticFiles(StaticFilesOptions options)
+    : options_(std::move(options)) {
+    if (options_.root.empty()) {
+        return;
+    }
+    std::error_code ec;
+    if (!std::filesystem::is_directory(options_.root, ec)) {
+        throw std::invalid_argument("Static files root " + options_.root.string() + " is not a directory");
+    }
+    options_.root = std::filesystem::canonical(options_.root);
+}
+
+std::optional<std::string> StaticFiles::DecodePath(std::string_view target) {
+    target = target.substr(0, target.find('?'));
+    std::string decoded;
+    decoded.reserve(target.size());
+    for (std::size_t i = 0; i < target.size(); ++i) {
+        if (target[i] != '%') {
+            decoded += target[i];
+            continue;
+        }
+        unsigned value = 0;
+        if (i + 2 >= target.size()
+            || std::from_chars(target.data() + i + 1, target.data() + i + 3, value, 16).ptr != target.data() + i + 3) {
+            return std::nullopt;
+        }
+        decoded += static_cast<char>(value);
+        i += 2;
+    }
+
+    // Проверяем уже декодированный путь: "%2e%2e" и "%2F" не должны обойти проверку
+    std::string path;
+    path.reserve(decoded.size());
+    std::string_view rest = decoded;
+    while (!rest.empty()) {
+        const auto slash = rest.find('/');
+        const auto segment = rest.substr(0, slash);
+        rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash + 1);
+        if (segment == ".."sv || segment.find('\0') != std::string_view::npos) {
+            return std::nullopt;
+        }
+        if (segment.empty() || segment == "."sv) {
+            continue;
+        }
+        if (!path.empty()) {
+            path += '/';
+        }
+        path += segment;
+    }
+    // Завершающий '/' означает каталог, из которого отдаётся index.html
+    if (!decoded.empty() && decoded.back() == '/' && !path.empty()) {
+        path += '/';
+    }
+    return path;
+}
+
+http_server::Response StaticFiles::Serve(const http_server::Request& req) {
+    const bool head = req.method() == http::verb::head;
+    if (!head && req.method() != http::verb::get) {
+        auto res = MakeTextResponse(req, http::status::method_not_allowed, "Method not allowed"sv);
+        std::get<http_server::StringResponse>(res).set(http::field::allow, "GET, HEAD");
+        return res;
+    }
+    auto path = DecodePath(std::string_view(req.target().data(), req.target().size()));
+    if (!path) {
+        return MakeTextResponse(req, http::status::bad_request, "Bad request"sv);
+    }
+    // index.html отдаётся только для target с завершающим '/', каталог без него перенаправляется
+    const bool index = path->empty() || path->back() == '/';
+    if (index) {
+        *path += "index.html"sv;
+    }
+    if (options_.root.empty()) {
+        return ServeEmbedded(req, *path, !index);
+    }
+    const auto file = OpenFile(*path, !index);
+    if (!file) {
+        return MakeTextResponse(req, http::status::not_found, "File not found"sv);
+    }
+    if (file->directory) {
+        return MakeDirectoryRedirect(req, *path);
+    }
+
+    const auto last_modified = FormatHttpDate(file->modified);
+    const auto if_modified_since = req[http::field::if_modified_since];
+    if (const auto since = ParseHttpDate(std::string_view(if_modified_since.data(), if_modified_since.size()));
+        since && file->modified <= *since) {
+        auto res = http_server::MakeStringResponse(req, http::status::not_modified);
+        res.set(http::field::last_modified, last_modified);
+        res.keep_alive(req.keep_alive());
+        res.prepare_payload();
+        return res;
+    }
+
+    // Заголовок общий для ответа из памяти и из файла
+    http::response<http::empty_body> header{http::status::ok, req.version()};
+    const auto content_type = http_server::GetContentType(*path);
+    const bool compressible = http_server::IsCompressibleContentType(content_type);
+    header.set(http::field::content_type, ToBeast(content_type));
+    header.set(http::field::last_modified, last_modified);
+    header.set(http::field::accept_ranges, "bytes");
+    if (compressible) {
+        header.set(http::field::vary, "Accept-Encoding");
+    }
+    header.keep_alive(req.keep_alive());
+
+    const auto range_header = req[http::field::range];
+    const auto range = ParseRange(std::string_view(range_header.data(), range_header.size()), file->size);
+
+    // Части файла отдаются из несжатого варианта: Content-Range относится к его байтам
+    const auto accept_encoding = req[http::field::accept_encoding];
+    if (compressible && range.kind == ByteRange::Kind::NONE
+        && http_server::AcceptsEncoding(std::string_view(accept_encoding.data(), accept_encoding.size()),
+                                        "gzip"sv)) {
+        header.set(http::field::content_encoding, "gzip");
+        if (file->gzip) {
+            header.set(http::field::content_length, std::to_string(file->gzip->size()));
+            http_server::SpanResponse res{std::move(header.base())};
+            if (!head) {
+                res.body() = {file->gzip, net::const_buffer(file->gzip->data(), file->gzip->size())};
+            }
+            return res;
+        }
+        if (!file->contents) {
+            if (auto sibling = OpenGzipSibling(*path, *file)) {
+                header.set(http::field::content_length, std::to_string(sibling->size));
+                return MakeFileResponse(std::move(header), *sibling, 0, sibling->size, head);
+            }
+        }
+        header.erase(http::field::content_encoding);
+    }
+
+    std::uint64_t offset = 0;
+    std::uint64_t size = file->size;
+    switch (range.kind) {
+        case ByteRange::Kind::NONE:
+            break;
+        case ByteRange::Kind::UNSATISFIABLE:
+            return MakeRangeNotSatisfiable(req, file->size);
+        case ByteRange::Kind::VALID:
+            header.result(http::status::partial_content);
+            offset = range.first;
+            size = range.last - range.first + 1;
+            header.set(http::field::content_range, FormatContentRange(range, file->size));
+            break;
+    }
+    // Content-Length задаётся явно: у ответа на HEAD тела нет, но длина та же, что у GET
+    header.set(http::field::content_length, std::to_string(size));
+    return MakeFileResponse(std::move(header), *file, offset, size, head);
+}
+
+http_server::Response StaticFiles::MakeFileResponse(http::response<http::empty_body>&& header,
+                                                    const OpenedFile& file, std::uint64_t offset,
+                                                    std::uint64_t size, bool head) {
+    if (file.contents) {
+        http_server::SpanResponse res{std::move(header.base())};
+        if (!head) {
+            res.body() = {file.contents,
+                          net::const_buffer(file.contents->data() + offset, static_cast<std::size_t>(size))};
+        }
+        return res;
+    }
+    http_server::FileResponse res{
+        .header = std::move(header),
+        .file = file.handle,
+        .offset = offset,
+        .size = head ? 0 : size,
+    };
+    return res;
+}
+
+http_server::Response StaticFiles::ServeEmbedded(const http_server::Request& req, std::string_view path,
+                                                 bool allow_directory) {
+    const auto* file = FindEmbeddedFile(path);
+    if (!file && allow_directory && FindEmbeddedFile(std::string{path} + "/index.html")) {
+        // Каталог без завершающего '/'
+        return MakeDirectoryRedirect(req, path);
+    }
+    if (!file) {
+        return MakeTextResponse(req, http::status::not_found, "File not found"sv);
+    }
+
+    const auto range_header = req[http::field::range];
+    const auto range = ParseRange(std::string_view(range_header.data(), range_header.size()), file->data.size());
+    // Части файла отдаются из несжатого варианта: Content-Range относится к его байтам
+    const auto accept_encoding = req[http::field::accept_encoding];
+    const bool gzip = !file->gzip.empty() && range.kind == ByteRange::Kind::NONE
+                      && http_server::AcceptsEncoding(
+                          std::string_view(accept_encoding.data(), accept_encoding.size()), "gzip"sv);
+    const auto body = gzip ? file->gzip : file->data;
+    const auto etag = gzip ? file->gzip_etag : file->etag;
+
+    http::response<http::empty_body> header{http::status::ok, req.version()};
+    header.set(http::field::etag, ToBeast(etag));
+    if (!file->gzip.empty()) {
+        header.set(http::field::vary, "Accept-Encoding");
+    }
+    header.keep_alive(req.keep_alive());
+
+    const auto if_none_match = req[http::field::if_none_match];
+    if (http_server::MatchesIfNoneMatch(std::string_view(if_none_match.data(), if_none_match.size()), etag)) {
+        header.result(http::status::not_modified);
+        return http_server::SpanResponse{std::move(header.base())};
+    }
+
+    header.set(http::field::content_type, ToBeast(file->content_type));
+    header.set(http::field::accept_ranges, "bytes");
+    if (gzip) {
+        header.set(http::field::content_encoding, "gzip");
+    }
+    std::size_t offset = 0;
+    std::size_t size = body.size();
+    switch (range.kind) {
+        case ByteRange::Kind::NONE:
+            break;
+        case ByteRange::Kind::UNSATISFIABLE:
+            return MakeRangeNotSatisfiable(req, body.size());
+        case ByteRange::Kind::VALID:
+            header.result(http::status::partial_content);
+            offset = static_cast<std::size_t>(range.first);
+            size = static_cast<std::size_t>(range.last - range.first + 1);
+            header.set(http::field::content_range, FormatContentRange(range, body.size()));
+            break;
+    }
+    header.set(http::field::content_length, std::to_string(size));
+
+    // Данные встроены в программу и живут до её завершения: владелец не нужен
+    http_server::SpanResponse res{std::move(header.base())};
+    if (req.method() != http::verb::head) {
+        res.body() = {nullptr, net::const_buffer(body.data() + offset, size)};
+    }
+    return res;
+}
+
+std::optional<StaticFiles::OpenedFile> StaticFiles::OpenFile(const std::string& path, bool allow_directory) {
+    const auto now = Clock::now();
+    if (auto cached = FindFresh(path, now)) {
+        return cached;
+    }
+
+    const auto full_path = options_.root / path;
+    const int fd = ::open(full_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        Forget(path);
+        return std::nullopt;
+    }
+    auto handle = std::make_shared<const http_server::FileHandle>(fd);
+    // Символическая ссылка внутри корня не должна выводить за его пределы
+    if (const auto opened = GetOpenedPath(fd, full_path); !opened || !IsWithin(*opened, options_.root)) {
+        Forget(path);
+        return std::nullopt;
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        Forget(path);
+        return std::nullopt;
+    }
+    if (S_ISDIR(st.st_mode) && allow_directory) {
+        OpenedFile directory;
+        directory.directory = true;
+        return directory;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        Forget(path);
+        return std::nullopt;
+    }
+
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+    if (size <= options_.max_cached_file_size && size <= options_.cache_capacity) {
+        auto cached = Cache(path, fd, size, st.st_mtim, now);
+        if (cached.contents) {
+            return cached;
+        }
+    } else {
+        // Файл вырос и больше не помещается в кеш
+        Forget(path);
+    }
+    return OpenedFile{
+        .contents = nullptr,
+        .handle = std::move(handle),
+        .gzip = nullptr,
+        .size = size,
+        .modified = st.st_mtim.tv_sec,
+    };
+}
+
+std::optional<StaticFiles::OpenedFile> StaticFiles::FindFresh(const std::string& path, Clock::time_point now) {
+    std::lock_guard lock{mutex_};
+    auto it = cache_.find(path);
+    if (it == cache_.end() || now - it->second.checked_at >= options_.revalidate_interval) {
+        return std::nullopt;
+    }
+    auto& entry = it->second;
+    lru_.splice(lru_.begin(), lru_, entry.lru_position);
+    return OpenedFile{.contents = entry.contents,
+                      .handle = nullptr,
+                      .gzip = entry.gzip,
+                      .size = entry.size,
+                      .modified = entry.modified.tv_sec};
+}
+
+StaticFiles::OpenedFile StaticFiles::Cache(const std::string& path, int fd, std::uint64_t size,
+                                           const std::timespec& modified, Clock::time_point now) {
+    {
+        // Файл не изменился с прошлой проверки: копия в памяти остаётся прежней
+        std::lock_guard lock{mutex_};
+        if (auto it = cache_.find(path);
+            it != cache_.end() && it->second.size == size && SameTime(it->second.modified, modified)) {
+            auto& entry = it->second;
+            entry.checked_at = now;
+            lru_.splice(lru_.begin(), lru_, entry.lru_position);
+            return {.contents = entry.contents,
+                    .handle = nullptr,
+                    .gzip = entry.gzip,
+                    .size = size,
+                    .modified = modified.tv_sec};
+        }
+    }
+
+    // Файл читается с диска и сжимается вне блокировки кеша
+    auto read = ReadContents(fd, size);
+    if (!read) {
+        return {};
+    }
+    auto contents = http_server::MakeSharedBuffer(std::move(*read));
+    http_server::SharedBuffer gzip;
+    if (size != 0 && http_server::IsCompressibleContentType(http_server::GetContentType(path))) {
+        auto compressed = http_server::GzipCompress(*contents, 9);
+        if (http_server::IsWorthCompressing(contents->size(), compressed.size())) {
+            gzip = http_server::MakeSharedBuffer(std::move(compressed));
+        }
+    }
+
+    std::lock_guard lock{mutex_};
+    auto [it, inserted] = cache_.try_emplace(path);
+    auto& entry = it->second;
+    if (inserted) {
+        lru_.push_front(path);
+        entry.lru_position = lru_.begin();
+    } else {
+        cached_bytes_ -= GetCachedBytes(entry);
+        lru_.splice(lru_.begin(), lru_, entry.lru_position);
+    }
+    entry.contents = contents;
+    entry.gzip = gzip;
+    entry.size = size;
+    entry.modified = modified;
+    entry.checked_at = now;
+    cached_bytes_ += GetCachedBytes(entry);
+
+    // Вытесняем давно не запрашивавшиеся файлы. Копия живёт, пока её отправляют
+    while (cached_bytes_ > options_.cache_capacity && lru_.size() > 1) {
+        auto victim = cache_.find(lru_.back());
+        cached_bytes_ -= GetCachedBytes(victim->second);
+        cache_.erase(victim);
+        lru_.pop_back();
+    }
+    return {.contents = std::move(contents),
+            .handle = nullptr,
+            .gzip = std::move(gzip),
+            .size = size,
+            .modified = modified.tv_sec};
+}
+
+void StaticFiles::Forget(const std::string& path) {
+    std::lock_guard lock{mutex_};
+    if (auto it = cache_.find(path); it != cache_.end()) {
+        cached_bytes_ -= GetCachedBytes(it->second);
+        lru_.erase(it->second.lru_position);
+        cache_.erase(it);
+    }
+}
+
+std::optional<StaticFiles::OpenedFile> StaticFiles::OpenGzipSibling(const std::string& path,
+                                                                     const OpenedFile& file) {
+    auto sibling_path = path + ".gz";
+    auto sibling = OpenFile(sibling_path, false);
+    if (!sibling || sibling->modified < file.modified) {
+        return std::nullopt;
+    }
+    return sibling;
+}
+
+std::uint64_t StaticFiles::GetCachedBytes(const CacheEntry& entry) noexcept {
+    return entry.size + (entry.gzip ? entry.gzip->size() : 0);
+}
+
+}  // namespace http_handler
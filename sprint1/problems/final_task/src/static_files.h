@@ -0,0 +1,113 @@
+// src/static_files.h
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "http_server.h"
+
+namespace http_handler {
+
+struct StaticFilesOptions {
+    // Каталог со статическими файлами. Если он не задан, отдаются файлы, встроенные
+    // в программу при сборке (см. embedded_static.h), а диск не используется
+    std::filesystem::path root;
+    // Файлы не больше этого размера читаются в память и хранятся в кеше.
+    // Более крупные при каждом запросе отправляются из файла вызовом sendfile
+    std::uint64_t max_cached_file_size = 256 * 1024;
+    // Суммарный размер файлов в кеше. Когда он превышен, вытесняются файлы,
+    // которые дольше всех не запрашивали
+    std::uint64_t cache_capacity = 64 * 1024 * 1024;
+    // Как часто файл из кеша сверяется с диском: после изменения файла кеш обновляется
+    std::chrono::steady_clock::duration revalidate_interval = std::chrono::seconds{1};
+};
+
+// Отдача статических файлов из каталога: GET и HEAD, частичные запросы (Range, один диапазон)
+// и условные запросы (If-Modified-Since). Путь запроса декодируется (%XX) и только потом
+// проверяется, что он не выходит за пределы корня; символические ссылки, ведущие за пределы
+// корня, тоже не отдаются.
+// Небольшие часто запрашиваемые файлы отдаются из копии в памяти без системных вызовов,
+// крупные — через sendfile, без копирования через память процесса. Копия, в отличие от
+// отображения файла, не ломается, если файл перезаписывают или укорачивают на месте.
+// Клиент, принимающий gzip, получает текстовые файлы сжатыми: небольшие сжимаются один раз
+// при попадании в кеш, для крупных отдаётся заранее сжатый файл path.gz, если он лежит рядом.
+// Встроенные в программу файлы отдаются прямо из её образа, по ETag (If-None-Match) и, если клиент
+// согласен, в заранее сжатом gzip варианте.
+// Можно использовать из нескольких потоков
+class StaticFiles {
+public:
+    // Бросает std::invalid_argument, если root задан и это не каталог
+    explicit StaticFiles(StaticFilesOptions options);
+
+    StaticFiles(const StaticFiles&) = delete;
+    StaticFiles& operator=(const StaticFiles&) = delete;
+
+    http_server::Response Serve(const http_server::Request& req);
+
+    // Декодирует путь из target запроса: отбрасывает строку запроса, заменяет %XX.
+    // Возвращает путь относительно корня (без ведущего '/') или nullopt, если путь
+    // некорректен или выходит за пределы корня ("..", нулевой байт)
+    static std::optional<std::string> DecodePath(std::string_view target);
+
+private:
+    // Файл, готовый к отправке: либо прочитанный в память (contents), либо открытый (handle).
+    // directory — по пути лежит каталог, ничего не открыто
+    struct OpenedFile {
+        http_server::SharedBuffer contents;
+        std::shared_ptr<const http_server::FileHandle> handle;
+        // Сжатый gzip вариант файла из кеша, если он есть
+        http_server::SharedBuffer gzip;
+        std::uint64_t size = 0;
+        std::time_t modified = 0;
+        bool directory = false;
+    };
+
+    struct CacheEntry {
+        http_server::SharedBuffer contents;
+        // Сжатый вариант. Сжимаются только файлы текстовых типов, и только если сжатие
+        // заметно уменьшает файл
+        http_server::SharedBuffer gzip;
+        std::uint64_t size = 0;
+        // Время изменения с точностью до наносекунд: по нему кеш замечает изменение файла
+        std::timespec modified{};
+        std::chrono::steady_clock::time_point checked_at;
+        std::list<std::string>::iterator lru_position;
+    };
+
+    // allow_directory — перенаправить на path с '/', если path — встроенный каталог с index.html
+    http_server::Response ServeEmbedded(const http_server::Request& req, std::string_view path,
+                                        bool allow_directory);
+    // Ответ с size байтами файла, начиная с offset. У ответа на HEAD тела нет
+    static http_server::Response MakeFileResponse(http_server::http::response<http_server::http::empty_body>&& header,
+                                                  const OpenedFile& file, std::uint64_t offset, std::uint64_t size,
+                                                  bool head);
+    // allow_directory — вернуть для каталога OpenedFile с directory, а не nullopt
+    std::optional<OpenedFile> OpenFile(const std::string& path, bool allow_directory);
+    // Ищет файл в кеше, не обращаясь к диску, если он недавно сверялся с диском
+    std::optional<OpenedFile> FindFresh(const std::string& path, std::chrono::steady_clock::time_point now);
+    OpenedFile Cache(const std::string& path, int fd, std::uint64_t size, const std::timespec& modified,
+                     std::chrono::steady_clock::time_point now);
+    void Forget(const std::string& path);
+    // Заранее сжатый файл path.gz рядом с крупным файлом, который не хранится в кеше.
+    // Подходит, только если он не старше исходного файла
+    std::optional<OpenedFile> OpenGzipSibling(const std::string& path, const OpenedFile& file);
+    // Память, которую запись занимает в кеше
+    static std::uint64_t GetCachedBytes(const CacheEntry& entry) noexcept;
+
+    StaticFilesOptions options_;
+    std::mutex mutex_;
+    // Пути файлов в кеше, в начале — запрошенные последними
+    std::list<std::string> lru_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+    std::uint64_t cached_bytes_ = 0;
+};
+
+}  // namespace http_handler
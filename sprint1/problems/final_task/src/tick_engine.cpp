@@ -0,0 +1,154 @@
+// src/tick_engine.cpp
+#include "tick_engine.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <utility>
+
+namespace model {
+
+namespace {
+
+unsigned GetThreadCount(const TickEngineOptions& options) noexcept {
+    return std::max(1u, options.threads);
+}
+
+}  // namespace
+
+void TickCostStats::Record(std::chrono::steady_clock::duration cost) noexcept {
+    const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(cost).count());
+    ticks.fetch_add(1, std::memory_order_relaxed);
+    total_ns.fetch_add(ns, std::memory_order_relaxed);
+    last_ns.store(ns, std::memory_order_relaxed);
+    if (ns > max_ns.load(std::memory_order_relaxed)) {
+        max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+TickEngine::TickEngine(std::vector<GameSession*> sessions, TickEngineOptions options)
+    : sessions_(std::move(sessions))
+    , options_(options)
+    , session_stats_(std::make_unique<TickCostStats[]>(sessions_.size()))
+    , order_(sessions_.size())
+    , start_barrier_(GetThreadCount(options))
+    , finish_barrier_(GetThreadCount(options), PublishStep{this}) {
+    auto& state = states_.GetNextBuffer();
+    state.sessions.resize(sessions_.size());
+    for (std::size_t i = 0; i < order_.size(); ++i) {
+        order_[i] = i;
+        sessions_[i]->CopyState(state.sessions[i]);
+    }
+    states_.Publish();
+}
+
+TickEngine::~TickEngine() {
+    Stop();
+}
+
+void TickEngine::Start() {
+    const unsigned threads = GetThreadCount(options_);
+    workers_.reserve(threads - 1);
+    for (unsigned i = 1; i < threads; ++i) {
+        workers_.emplace_back([this] {
+            RunWorker();
+        });
+    }
+    schedule_ = std::jthread{[this](std::stop_token stop) {
+        RunSchedule(stop);
+    }};
+}
+
+void TickEngine::Stop() noexcept {
+    if (schedule_.joinable()) {
+        schedule_.request_stop();
+        schedule_.join();
+    }
+    workers_.clear();
+}
+
+void TickEngine::RunSchedule(std::stop_token stop) {
+    std::mutex mutex;
+    std::condition_variable_any wakeup;
+    std::unique_lock lock{mutex};
+    const auto period = options_.period;
+    auto deadline = Clock::now() + period;
+    for (;;) {
+        // Ожидание прерывается остановкой. Если срок уже прошёл, тик начинается сразу
+        wakeup.wait_until(lock, stop, deadline, [] {
+            return false;
+        });
+        if (stop.stop_requested()) {
+            break;
+        }
+        const auto late = Clock::now() - deadline;
+        if (late >= period * (options_.max_catch_up + 1)) {
+            const auto missed = late / period - options_.max_catch_up;
+            stats_.skipped.fetch_add(static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+            deadline += period * missed;
+        }
+        RunTick();
+        deadline += period;
+    }
+    // Остальные потоки ждут начала следующего тика и, увидев stopping_, завершаются
+    stopping_ = true;
+    start_barrier_.arrive_and_wait();
+}
+
+void TickEngine::RunWorker() {
+    for (;;) {
+        start_barrier_.arrive_and_wait();
+        if (stopping_) {
+            return;
+        }
+        TickSessions();
+        finish_barrier_.arrive_and_wait();
+    }
+}
+
+void TickEngine::RunTick() {
+    const auto start = Clock::now();
+    // Дорогие сеансы разбираются первыми, иначе поток, взявший такой сеанс последним, задержит весь тик
+    std::sort(order_.begin(), order_.end(), [this](std::size_t lhs, std::size_t rhs) {
+        return session_stats_[lhs].last_ns.load(std::memory_order_relaxed)
+             > session_stats_[rhs].last_ns.load(std::memory_order_relaxed);
+    });
+    next_session_.store(0, std::memory_order_relaxed);
+    // Буфер снимка никто не читает: это новый объект или снимок, который читатели уже отпустили
+    next_state_ = &states_.GetNextBuffer();
+    next_state_->tick = ++tick_;
+    next_state_->sessions.resize(sessions_.size());
+    start_barrier_.arrive_and_wait();
+    TickSessions();
+    finish_barrier_.arrive_and_wait();
+    const auto duration = Clock::now() - start;
+    stats_.duration.Record(duration);
+    if (duration > options_.period) {
+        stats_.overruns.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (options_.on_tick) {
+        // Рассылка берёт тот же опубликованный снимок, что и читатели GetStates, а не отдельную копию
+        const auto snapshot = states_.Read();
+        options_.on_tick(*snapshot);
+    }
+}
+
+void TickEngine::TickSessions() noexcept {
+    const double dt = std::chrono::duration<double>(options_.period).count();
+    for (;;) {
+        const auto position = next_session_.fetch_add(1, std::memory_order_relaxed);
+        if (position >= order_.size()) {
+            break;
+        }
+        const auto session = order_[position];
+        const auto start = Clock::now();
+        sessions_[session]->Tick(dt, next_state_->sessions[session]);
+        session_stats_[session].Record(Clock::now() - start);
+    }
+}
+
+void TickEngine::PublishStep::operator()() const noexcept {
+    engine->states_.Publish();
+}
+
+}  // namespace model
@@ -0,0 +1,141 @@
+// src/tick_engine.h
+#pragma once
+#include <atomic>
+#include <barrier>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "game_session.h"
+#include "snapshot.h"
+
+namespace model {
+
+struct TickEngineOptions {
+    // Период тика, он же шаг игрового времени
+    std::chrono::steady_clock::duration period = std::chrono::milliseconds{50};
+    // Потоки, выполняющие тики сеансов, включая поток расписания (не меньше одного)
+    unsigned threads = 1;
+    // Сколько опоздавших тиков выполняется подряд, чтобы догнать расписание. Если отставание
+    // больше, лишние тики пропускаются: игровое время отстаёт от реального, но долг не копится
+    unsigned max_catch_up = 4;
+    // Вызывается потоком расписания после каждого тика со снимком, который тик опубликовал
+    // (тот же, что вернёт GetStates().Read()), например чтобы разослать его клиентам.
+    // Следующий тик не начнётся, пока вызов не вернёт управление
+    std::function<void(const GameState&)> on_tick;
+};
+
+// Длительность тиков. Пишет один поток за тик, читать можно из любого потока
+struct TickCostStats {
+    std::atomic<std::uint64_t> ticks{0};
+    std::atomic<std::uint64_t> total_ns{0};
+    std::atomic<std::uint64_t> max_ns{0};
+    std::atomic<std::uint64_t> last_ns{0};
+
+    void Record(std::chrono::steady_clock::duration cost) noexcept;
+
+    double GetAverageMs() const noexcept {
+        const auto count = ticks.load(std::memory_order_relaxed);
+        return count != 0 ? static_cast<double>(total_ns.load(std::memory_order_relaxed)) / count / 1e6 : 0.0;
+    }
+
+    double GetMaxMs() const noexcept {
+        return static_cast<double>(max_ns.load(std::memory_order_relaxed)) / 1e6;
+    }
+};
+
+struct TickEngineStats {
+    // Тик целиком: от начала до публикации состояний всех сеансов
+    TickCostStats duration;
+    // Тики, которые выполнялись дольше периода
+    std::atomic<std::uint64_t> overruns{0};
+    // Тики, пропущенные из-за отставания от расписания
+    std::atomic<std::uint64_t> skipped{0};
+};
+
+// Ход игрового времени: с постоянным периодом выполняет тики всех сеансов параллельно.
+// Сроки тиков отсчитываются от первого срока, а не от конца предыдущего тика, поэтому время
+// самих тиков и опоздания пробуждений не накапливаются. Шаг игрового времени всегда равен периоду.
+// Потоки разбирают сеансы тика из общей очереди, самые дорогие по прошлому тику — первыми:
+// пока есть несделанные сеансы, ни один поток не простаивает.
+// Тик записывает состояния сеансов в буфер следующего снимка GameState, а когда тик закончен во всех
+// сеансах, снимок публикуется на барьере одной атомарной заменой указателя (см. SnapshotChannel).
+// Читатели (GetStates) не застают тик наполовину выполненным, не блокируют тик и не ждут его.
+// Сеансы должны жить дольше движка. Пока движок запущен, сеансами владеют его потоки
+class TickEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    using StateChannel = util::SnapshotChannel<GameState>;
+
+    // Сразу публикует состояние сеансов до первого тика
+    TickEngine(std::vector<GameSession*> sessions, TickEngineOptions options);
+    ~TickEngine();
+
+    TickEngine(const TickEngine&) = delete;
+    TickEngine& operator=(const TickEngine&) = delete;
+
+    // Запускает потоки. Первый тик выполняется через период. Движок запускается один раз
+    void Start();
+
+    // Дожидается конца текущего тика и останавливает потоки
+    void Stop() noexcept;
+
+    std::size_t GetSessionCount() const noexcept {
+        return sessions_.size();
+    }
+
+    const TickCostStats& GetSessionStats(std::size_t session) const noexcept {
+        return session_stats_[session];
+    }
+
+    const TickEngineStats& GetStats() const noexcept {
+        return stats_;
+    }
+
+    // Снимки состояния после каждого тика. Читать можно из любого потока
+    const StateChannel& GetStates() const noexcept {
+        return states_;
+    }
+
+private:
+    // Вызывается барьером, когда все потоки закончили тик
+    struct PublishStep {
+        TickEngine* engine;
+
+        void operator()() const noexcept;
+    };
+
+    // Поток расписания: ждёт сроков и выполняет тики вместе с остальными потоками
+    void RunSchedule(std::stop_token stop);
+    void RunWorker();
+    void RunTick();
+    // Выполняет тики сеансов из общей очереди, пока она не опустеет
+    void TickSessions() noexcept;
+
+    std::vector<GameSession*> sessions_;
+    TickEngineOptions options_;
+    std::unique_ptr<TickCostStats[]> session_stats_;
+    TickEngineStats stats_;
+    // Порядок, в котором потоки разбирают сеансы
+    std::vector<std::size_t> order_;
+    // Позиция очереди сеансов текущего тика в order_
+    std::atomic<std::size_t> next_session_{0};
+    StateChannel states_;
+    // Снимок, который заполняет текущий тик
+    GameState* next_state_ = nullptr;
+    // Номер последнего выполненного тика. Пропущенные тики не считаются
+    std::uint64_t tick_ = 0;
+    bool stopping_ = false;
+    std::barrier<> start_barrier_;
+    std::barrier<PublishStep> finish_barrier_;
+    std::vector<std::jthread> workers_;
+    std::jthread schedule_;
+};
+
+}  // namespace model
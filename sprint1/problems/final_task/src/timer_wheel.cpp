@@ -0,0 +1,79 @@
+// src/timer_wheel.cpp
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace http_server {
+
+TimerWheel::TimerWheel(net::io_context& ioc, Duration tick, std::size_t slot_count)
+    : timer_(ioc)
+    , tick_(tick)
+    , slots_(std::max<std::size_t>(2, slot_count), nullptr) {
+}
+
+void TimerWheel::Start() {
+    DoTick();
+}
+
+void TimerWheel::Schedule(Entry& entry, Duration timeout) {
+    // Текущий тик уже частично прошёл, поэтому добавляем ещё один: таймаут не сработает раньше срока
+    const auto ticks = std::clamp<std::size_t>(
+        static_cast<std::size_t>((timeout + tick_ - Duration{1}) / tick_) + 1, 1, slots_.size() - 1);
+
+    std::lock_guard lock{mutex_};
+    Unlink(entry);
+    const std::size_t slot = (current_ + ticks) % slots_.size();
+    entry.slot_ = slot;
+    entry.prev_ = nullptr;
+    entry.next_ = slots_[slot];
+    if (entry.next_) {
+        entry.next_->prev_ = &entry;
+    }
+    slots_[slot] = &entry;
+}
+
+void TimerWheel::Cancel(Entry& entry) noexcept {
+    std::lock_guard lock{mutex_};
+    Unlink(entry);
+}
+
+void TimerWheel::DoTick() {
+    timer_.expires_after(tick_);
+    timer_.async_wait([self = shared_from_this()](boost::system::error_code ec) {
+        if (!ec) {
+            self->OnTick();
+            self->DoTick();
+        }
+    });
+}
+
+void TimerWheel::OnTick() {
+    std::lock_guard lock{mutex_};
+    current_ = (current_ + 1) % slots_.size();
+    Entry* entry = std::exchange(slots_[current_], nullptr);
+    while (entry) {
+        Entry* next = entry->next_;
+        entry->prev_ = entry->next_ = nullptr;
+        entry->slot_ = NO_SLOT;
+        entry->OnTimeout();
+        entry = next;
+    }
+}
+
+void TimerWheel::Unlink(Entry& entry) noexcept {
+    if (entry.slot_ == NO_SLOT) {
+        return;
+    }
+    if (entry.prev_) {
+        entry.prev_->next_ = entry.next_;
+    } else {
+        slots_[entry.slot_] = entry.next_;
+    }
+    if (entry.next_) {
+        entry.next_->prev_ = entry.prev_;
+    }
+    entry.prev_ = entry.next_ = nullptr;
+    entry.slot_ = NO_SLOT;
+}
+
+}  // namespace http_server
@@ -0,0 +1,73 @@
+// src/timer_wheel.h
+#pragma once
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace http_server {
+
+namespace net = boost::asio;
+
+// Таймерное колесо: много грубых таймаутов на одном steady_timer.
+// Время разбито на тики, у каждого тика свой слот — интрусивный список записей.
+// Постановка и снятие записи — O(1) без выделения памяти, а раз в тик колесо
+// срабатывает для всех записей очередного слота. Таймаут срабатывает не раньше срока
+// и не позже чем через один тик после него.
+// Колесо можно использовать из нескольких потоков.
+class TimerWheel : public std::enable_shared_from_this<TimerWheel> {
+public:
+    using Duration = std::chrono::steady_clock::duration;
+
+    // Запись колеса встраивается в объект, за которым оно следит
+    class Entry {
+    public:
+        Entry() = default;
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+        // Вызывается, когда таймаут истёк. Вызов происходит под блокировкой колеса,
+        // поэтому обработчик должен быть коротким и не обращаться к колесу
+        virtual void OnTimeout() noexcept = 0;
+
+    protected:
+        ~Entry() = default;
+
+    private:
+        friend class TimerWheel;
+        Entry* prev_ = nullptr;
+        Entry* next_ = nullptr;
+        std::size_t slot_ = NO_SLOT;
+    };
+
+    // Колесо из slot_count слотов по tick. Таймауты длиннее (slot_count - 2) тиков укорачиваются
+    TimerWheel(net::io_context& ioc, Duration tick, std::size_t slot_count);
+
+    // Запускает отсчёт тиков
+    void Start();
+
+    // Ставит запись на срабатывание через timeout.
+    // Если запись уже стоит в колесе, она переставляется
+    void Schedule(Entry& entry, Duration timeout);
+
+    // Снимает запись с колеса, если она в нём стоит
+    void Cancel(Entry& entry) noexcept;
+
+private:
+    static constexpr std::size_t NO_SLOT = static_cast<std::size_t>(-1);
+
+    void DoTick();
+    void OnTick();
+    void Unlink(Entry& entry) noexcept;
+
+    net::steady_timer timer_;
+    Duration tick_;
+    std::mutex mutex_;
+    std::vector<Entry*> slots_;
+    std::size_t current_ = 0;
+};
+
+}  // namespace http_server
@@ -0,0 +1,99 @@
+// src/websocket_session.cpp
+#include "websocket_session.h"
+
+#include <boost/asio/dispatch.hpp>
+#include <iostream>
+
+namespace http_server {
+
+void teardown(beast::role_type role, UpgradedSocket& socket, beast::error_code& ec) {
+    websocket::teardown(role, socket.next_layer(), ec);
+}
+
+void StartWebSocketSession(SessionSocket&& socket, SessionLimiter::Permit&& permit, WebSocketUpgrade&& upgrade) {
+    std::make_shared<WebSocketSession>(std::move(socket), std::move(permit))->Run(std::move(upgrade));
+}
+
+WebSocketSession::WebSocketSession(SessionSocket&& socket, SessionLimiter::Permit&& permit)
+    : ws_(std::move(socket))
+    , permit_(std::move(permit)) {
+}
+
+void WebSocketSession::Run(WebSocketUpgrade&& upgrade) {
+    channel_ = std::move(upgrade.channel);
+    // Рекомендованные Beast таймауты сервера: рукопожатие и закрытие ограничены по времени,
+    // а простаивающему клиенту отправляются ping
+    ws_.set_option(websocket::stream_base::timeout::suggested(beast::role_type::server));
+    auto on_accept = BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec) {
+        self->OnAccept(ec);
+    });
+    // Клиент мог прислать первые кадры вместе с запросом. Запрос уже разобран HTTP-сессией,
+    // поток принимает его как есть, а кадры прочитает из буфера сокета
+    if (!upgrade.buffered.empty()) {
+        auto& buffer = ws_.next_layer().buffer();
+        buffer.commit(net::buffer_copy(buffer.prepare(upgrade.buffered.size()), net::buffer(upgrade.buffered)));
+    }
+    ws_.async_accept(upgrade.request, std::move(on_accept));
+}
+
+void WebSocketSession::OnFrame(const SharedBuffer& frame) {
+    // Кадры публикуются из чужого потока, отправка идёт в strand сессии
+    net::dispatch(ws_.get_executor(), BindMemory(handler_memory_, [self = shared_from_this(), frame] {
+        self->next_frame_ = frame;
+        self->DoWrite();
+    }));
+}
+
+void WebSocketSession::OnAccept(beast::error_code ec) {
+    if (ec) {
+        std::cerr << "WebSocket accept error: " << ec.message() << std::endl;
+        return;
+    }
+    accepted_ = true;
+    ws_.text(true);
+    if (channel_) {
+        channel_->Subscribe(weak_from_this());
+    }
+    DoRead();
+}
+
+void WebSocketSession::DoRead() {
+    ws_.async_read(read_buffer_,
+        BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
+            self->OnRead(ec, bytes_transferred);
+        }));
+}
+
+void WebSocketSession::OnRead(beast::error_code ec, std::size_t bytes_transferred) {
+    boost::ignore_unused(bytes_transferred);
+    if (ec) {
+        // Клиент закрыл соединение или истёк таймаут. Канал забудет сессию при следующей публикации
+        closed_ = true;
+        return;
+    }
+    read_buffer_.consume(read_buffer_.size());
+    DoRead();
+}
+
+void WebSocketSession::DoWrite() {
+    if (!accepted_ || closed_ || writing_frame_ || !next_frame_) {
+        return;
+    }
+    writing_frame_ = std::move(next_frame_);
+    ws_.async_write(net::buffer(*writing_frame_),
+        BindMemory(handler_memory_, [self = shared_from_this()](beast::error_code ec, std::size_t bytes_transferred) {
+            self->OnWrite(ec, bytes_transferred);
+        }));
+}
+
+void WebSocketSession::OnWrite(beast::error_code ec, std::size_t bytes_transferred) {
+    boost::ignore_unused(bytes_transferred);
+    writing_frame_.reset();
+    if (ec) {
+        closed_ = true;
+        return;
+    }
+    DoWrite();
+}
+
+}  // namespace http_server
@@ -0,0 +1,65 @@
+// src/websocket_session.h
+#pragma once
+#include <boost/beast/core/buffered_read_stream.hpp>
+#include <boost/beast/websocket.hpp>
+#include <memory>
+#include <utility>
+
+#include "broadcast_channel.h"
+#include "http_server.h"
+
+namespace http_server {
+
+namespace websocket = beast::websocket;
+
+// Сокет WebSocket-сессии. Байты, которые HTTP-сессия прочитала вслед за запросом на переключение,
+// лежат в буфере и читаются раньше, чем данные из сокета
+class UpgradedSocket : public beast::buffered_read_stream<SessionSocket, beast::flat_buffer> {
+public:
+    using buffered_read_stream::buffered_read_stream;
+};
+
+// Закрытие WebSocket-соединения (websocket::stream находит их поиском по аргументам): закрывается сокет,
+// непрочитанные байты буфера уже не нужны
+void teardown(beast::role_type role, UpgradedSocket& socket, beast::error_code& ec);
+
+template <typename TeardownHandler>
+void async_teardown(beast::role_type role, UpgradedSocket& socket, TeardownHandler&& handler) {
+    websocket::async_teardown(role, socket.next_layer(), std::forward<TeardownHandler>(handler));
+}
+
+// WebSocket-сессия, рассылающая клиенту кадры из BroadcastChannel.
+// Сообщения клиента не обрабатываются: чтение нужно только для управляющих кадров (ping, close).
+// Кадры отправляются как есть из разделяемого буфера, без копирования. Если клиент не успевает
+// их принимать, промежуточные кадры пропускаются: отправки ждёт только самый свежий кадр,
+// поэтому медленный клиент не копит очередь и сразу получает актуальное состояние
+class WebSocketSession : public BroadcastSubscriber, public std::enable_shared_from_this<WebSocketSession> {
+public:
+    // Принимает владение сокетом и разрешением на сессию у HTTP-сессии, получившей запрос на переключение
+    WebSocketSession(SessionSocket&& socket, SessionLimiter::Permit&& permit);
+
+    // Завершает рукопожатие и подписывается на канал
+    void Run(WebSocketUpgrade&& upgrade);
+
+    void OnFrame(const SharedBuffer& frame) override;
+
+private:
+    void OnAccept(beast::error_code ec);
+    void DoRead();
+    void OnRead(beast::error_code ec, std::size_t bytes_transferred);
+    void DoWrite();
+    void OnWrite(beast::error_code ec, std::size_t bytes_transferred);
+
+    websocket::stream<UpgradedSocket> ws_;
+    beast::flat_buffer read_buffer_;
+    HandlerMemory handler_memory_;
+    SessionLimiter::Permit permit_;
+    std::shared_ptr<BroadcastChannel> channel_;
+    // Кадр, который отправляется сейчас, и следующий за ним
+    SharedBuffer writing_frame_;
+    SharedBuffer next_frame_;
+    bool accepted_ = false;
+    bool closed_ = false;
+};
+
+}  // namespace http_server
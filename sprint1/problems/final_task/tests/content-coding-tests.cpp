@@ -0,0 +1,33 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string_view>
+
+#include "../src/content_coding.h"
+
+using namespace http_server;
+using namespace std::literals;
+
+TEST_CASE("gzip is accepted when the client lists it") {
+    for (auto header : {"gzip"sv, "GZip"sv, "deflate, gzip"sv, " gzip ,br"sv, "gzip;q=0.5"sv, "gzip; q=1"sv,
+                        "gzip;q=0.001"sv, "br;q=0, gzip"sv, "gzip;level=1"sv}) {
+        INFO(header);
+        CHECK(AcceptsEncoding(header, "gzip"sv));
+    }
+}
+
+TEST_CASE("gzip is not accepted without the header or with zero weight") {
+    for (auto header : {""sv, "identity"sv, "deflate, br"sv, "gzipx"sv, "x-gzip"sv, "gzip;q=0"sv, "gzip; Q=0.0"sv,
+                        "gzip;q=0.000"sv, "br, gzip;q=0"sv}) {
+        INFO(header);
+        CHECK_FALSE(AcceptsEncoding(header, "gzip"sv));
+    }
+}
+
+TEST_CASE("An explicit coding takes precedence over the wildcard") {
+    CHECK(AcceptsEncoding("*"sv, "gzip"sv));
+    CHECK(AcceptsEncoding("br, *;q=0.1"sv, "gzip"sv));
+    CHECK_FALSE(AcceptsEncoding("*;q=0"sv, "gzip"sv));
+    CHECK(AcceptsEncoding("*;q=0, gzip"sv, "gzip"sv));
+    CHECK_FALSE(AcceptsEncoding("*, gzip;q=0"sv, "gzip"sv));
+    CHECK_FALSE(AcceptsEncoding("gzip;q=0, *"sv, "gzip"sv));
+}
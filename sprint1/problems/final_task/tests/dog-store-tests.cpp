@@ -0,0 +1,231 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../src/dog_store.h"
+#include "../src/road_index.h"
+
+using namespace model;
+
+namespace {
+
+constexpr double TICK = 0.05;
+constexpr double EPSILON = 1e-9;
+
+std::vector<Road> MakeCity(int size) {
+    constexpr Coord BLOCK = 10;
+    std::vector<Road> roads;
+    for (int i = 0; i < size; ++i) {
+        const Coord line = i * BLOCK;
+        for (int j = 0; j + 1 < size; ++j) {
+            const Coord from = j * BLOCK;
+            roads.emplace_back(Road::HORIZONTAL, Point{from, line}, from + BLOCK);
+            roads.emplace_back(Road::VERTICAL, Point{line, from + BLOCK}, from);
+        }
+    }
+    return roads;
+}
+
+// Собака, которая движется простым интегрированием: каждый тик сдвигается на speed * dt
+// и останавливается, дойдя до точки, найденной при смене направления
+struct PlainDog {
+    Position position;
+    Speed speed{0.0, 0.0};
+    Direction direction = Direction::NORTH;
+    Position target = position;
+
+    void SetMovement(const RoadIndex& index, Direction new_direction, double value) {
+        direction = new_direction;
+        target = index.GetFarthestPoint(position, direction);
+        switch (direction) {
+            case Direction::NORTH:
+                speed = {0.0, -value};
+                break;
+            case Direction::SOUTH:
+                speed = {0.0, value};
+                break;
+            case Direction::WEST:
+                speed = {-value, 0.0};
+                break;
+            case Direction::EAST:
+                speed = {value, 0.0};
+                break;
+        }
+    }
+
+    void Advance(double dt) {
+        position.x += speed.vx * dt;
+        position.y += speed.vy * dt;
+        const bool reached = (speed.vx > 0 && position.x >= target.x) || (speed.vx < 0 && position.x <= target.x)
+                          || (speed.vy > 0 && position.y >= target.y) || (speed.vy < 0 && position.y <= target.y);
+        if (reached) {
+            position = target;
+            speed = {0.0, 0.0};
+        }
+    }
+};
+
+bool Near(Position lhs, Position rhs) {
+    return std::abs(lhs.x - rhs.x) <= EPSILON && std::abs(lhs.y - rhs.y) <= EPSILON;
+}
+
+bool Near(Speed lhs, Speed rhs) {
+    return std::abs(lhs.vx - rhs.vx) <= EPSILON && std::abs(lhs.vy - rhs.vy) <= EPSILON;
+}
+
+}  // namespace
+
+TEST_CASE("A dog walks along the road and stops at its edge") {
+    const std::vector<Road> roads{{Road::HORIZONTAL, Point{0, 0}, 10}, {Road::VERTICAL, Point{10, 0}, 10}};
+    const RoadIndex index{roads};
+    DogStore dogs{index};
+    auto dog = dogs.Get(dogs.Add({2, 0}));
+    CHECK(dog.GetDirection() == Direction::NORTH);
+    CHECK(Near(dog.GetSpeed(), {0, 0}));
+
+    dog.SetMovement(Direction::EAST, 4.0);
+    CHECK(Near(dog.GetSpeed(), {4.0, 0}));
+    dogs.Advance(1.0);
+    CHECK(Near(dog.GetPosition(), {6, 0}));
+    dogs.Advance(10.0);
+    CHECK(Near(dog.GetPosition(), {10.4, 0}));
+    CHECK(Near(dog.GetSpeed(), {0, 0}));
+    CHECK(dog.GetDirection() == Direction::EAST);
+
+    // От края горизонтальной дороги собака сворачивает на вертикальную
+    dog.SetMovement(Direction::SOUTH, 100.0);
+    dogs.Advance(1.0);
+    CHECK(Near(dog.GetPosition(), {10.4, 10.4}));
+
+    dog.SetMovement(Direction::WEST, 0.0);
+    CHECK(Near(dog.GetSpeed(), {0, 0}));
+    CHECK(dog.GetDirection() == Direction::WEST);
+    dogs.Advance(1.0);
+    CHECK(Near(dog.GetPosition(), {10.4, 10.4}));
+}
+
+TEST_CASE("DogStore handles survive removal of other dogs") {
+    const std::vector<Road> roads{{Road::HORIZONTAL, Point{0, 0}, 100}};
+    const RoadIndex index{roads};
+    DogStore dogs{index};
+    std::vector<DogStore::Handle> handles;
+    for (int i = 0; i < 5; ++i) {
+        handles.push_back(dogs.Add({static_cast<double>(i), 0}));
+    }
+
+    dogs.Remove(handles[1]);
+    CHECK(dogs.GetSize() == 4);
+    CHECK_FALSE(dogs.Contains(handles[1]));
+    for (int i : {0, 2, 3, 4}) {
+        REQUIRE(dogs.Contains(handles[i]));
+        CHECK(Near(dogs.GetPosition(handles[i]), {static_cast<double>(i), 0}));
+    }
+
+    // Освободившийся слот достаётся новой собаке, но старый дескриптор не действует
+    const auto added = dogs.Add({50, 0});
+    CHECK(added.slot == handles[1].slot);
+    CHECK_FALSE(added == handles[1]);
+    CHECK_FALSE(dogs.Contains(handles[1]));
+    CHECK(Near(dogs.GetPosition(added), {50, 0}));
+    dogs.Get(added).SetMovement(Direction::EAST, 1.0);
+    dogs.Advance(1.0);
+    CHECK(Near(dogs.GetPosition(added), {51, 0}));
+    CHECK(Near(dogs.GetPosition(handles[4]), {4, 0}));
+}
+
+TEST_CASE("DogStore ignores stale and repeated removal") {
+    const std::vector<Road> roads{{Road::HORIZONTAL, Point{0, 0}, 100}};
+    const RoadIndex index{roads};
+    DogStore dogs{index};
+
+    // В пустом хранилище удалять нечего
+    CHECK_FALSE(dogs.Remove({0, 0}));
+    CHECK(dogs.GetSize() == 0);
+
+    const auto first = dogs.Add({1, 0});
+    const auto second = dogs.Add({2, 0});
+    CHECK(dogs.Remove(first));
+    // Повторное удаление не трогает ни собак, ни список свободных слотов
+    CHECK_FALSE(dogs.Remove(first));
+    CHECK(dogs.GetSize() == 1);
+
+    // Новая собака занимает слот удалённой, и старый дескриптор не удаляет её
+    const auto third = dogs.Add({3, 0});
+    CHECK(third.slot == first.slot);
+    CHECK_FALSE(dogs.Remove(first));
+    CHECK(dogs.GetSize() == 2);
+    REQUIRE(dogs.Contains(second));
+    REQUIRE(dogs.Contains(third));
+    CHECK(Near(dogs.GetPosition(second), {2, 0}));
+    CHECK(Near(dogs.GetPosition(third), {3, 0}));
+
+    // Единственный свободный слот выдан один раз: следующая собака получает новый
+    const auto fourth = dogs.Add({4, 0});
+    CHECK(fourth.slot != third.slot);
+    CHECK(fourth.slot != second.slot);
+    CHECK(dogs.Remove(second));
+    CHECK(dogs.Remove(third));
+    CHECK(dogs.Remove(fourth));
+    CHECK(dogs.GetSize() == 0);
+    CHECK_FALSE(dogs.Remove(fourth));
+}
+
+TEST_CASE("DogStore ticks match plain per-dog integration") {
+    const auto roads = MakeCity(8);
+    const RoadIndex index{roads};
+    DogStore dogs{index};
+    std::vector<DogStore::Handle> handles;
+    std::vector<PlainDog> expected;
+
+    std::mt19937_64 random{42};
+    std::uniform_real_distribution<double> unit{0.0, 1.0};
+    std::uniform_real_distribution<double> speed{0.0, 6.0};
+    std::uniform_int_distribution<std::size_t> road_index{0, roads.size() - 1};
+    std::uniform_int_distribution<int> direction{0, 3};
+    for (int i = 0; i < 500; ++i) {
+        const auto& road = roads[road_index(random)];
+        const auto start = road.GetStart();
+        const auto end = road.GetEnd();
+        const double t = unit(random);
+        const Position position{start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t};
+        handles.push_back(dogs.Add(position));
+        expected.push_back(PlainDog{.position = position});
+    }
+
+    std::vector<DogState> states;
+    for (int tick = 0; tick < 400; ++tick) {
+        // Время от времени собаки меняют направление и скорость
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            if ((tick + i) % 37 == 0) {
+                const auto new_direction = static_cast<Direction>(direction(random));
+                const double new_speed = speed(random);
+                dogs.Get(handles[i]).SetMovement(new_direction, new_speed);
+                expected[i].SetMovement(index, new_direction, new_speed);
+            }
+        }
+        dogs.Advance(TICK);
+        for (auto& dog : expected) {
+            dog.Advance(TICK);
+        }
+
+        for (std::size_t i = 0; i < handles.size(); ++i) {
+            const auto dog = dogs.Get(handles[i]);
+            INFO("tick " << tick << ", dog " << i);
+            REQUIRE(Near(dog.GetPosition(), expected[i].position));
+            REQUIRE(Near(dog.GetSpeed(), expected[i].speed));
+            REQUIRE(dog.GetDirection() == expected[i].direction);
+            REQUIRE(index.IsOnRoad(dog.GetPosition()));
+        }
+    }
+
+    dogs.CopyStates(states);
+    REQUIRE(states.size() == handles.size());
+    for (std::size_t i = 0; i < handles.size(); ++i) {
+        CHECK(Near(states[i].position, expected[i].position));
+        CHECK(Near(states[i].speed, expected[i].speed));
+        CHECK(states[i].direction == expected[i].direction);
+    }
+}
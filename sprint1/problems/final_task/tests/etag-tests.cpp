@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <string_view>
+
+#include "../src/etag.h"
+
+using namespace http_server;
+using namespace std::literals;
+
+TEST_CASE("Strong ETag depends only on the representation bytes") {
+    const auto etag = MakeStrongETag("hello"sv);
+    CHECK(etag.front() == '"');
+    CHECK(etag.back() == '"');
+    CHECK(etag.starts_with("\"5-"sv));
+    CHECK(etag == MakeStrongETag("hello"sv));
+    CHECK(etag != MakeStrongETag("hellp"sv));
+    CHECK(MakeStrongETag(""sv) != MakeStrongETag("\0"sv));
+
+    SECTION("bytes may be appended in parts") {
+        ETagBuilder builder;
+        builder.Append("he"sv);
+        builder.Append(""sv);
+        builder.Append("llo"sv);
+        CHECK(builder.GetSize() == 5);
+        CHECK(builder.GetETag() == etag);
+    }
+}
+
+TEST_CASE("If-None-Match matches one of the listed tags") {
+    const std::string etag = MakeStrongETag("body"sv);
+    const std::string weak = "W/" + etag;
+    const std::string other = MakeStrongETag("other"sv);
+
+    CHECK(MatchesIfNoneMatch(etag, etag));
+    CHECK(MatchesIfNoneMatch(" " + etag + " ", etag));
+    CHECK(MatchesIfNoneMatch(other + ", " + etag, etag));
+    CHECK(MatchesIfNoneMatch(other + "," + etag + ",", etag));
+    CHECK_FALSE(MatchesIfNoneMatch(other, etag));
+    CHECK_FALSE(MatchesIfNoneMatch(""sv, etag));
+    CHECK_FALSE(MatchesIfNoneMatch(" , ,"sv, etag));
+
+    SECTION("weak comparison ignores the W/ prefix") {
+        CHECK(MatchesIfNoneMatch(weak, etag));
+        CHECK(MatchesIfNoneMatch(other + ", " + weak, etag));
+    }
+
+    SECTION("an asterisk matches any representation") {
+        CHECK(MatchesIfNoneMatch("*"sv, etag));
+        CHECK(MatchesIfNoneMatch("  *"sv, etag));
+    }
+
+    SECTION("a comma inside quotes does not split tags") {
+        CHECK(MatchesIfNoneMatch("\"a,b\""sv, "\"a,b\""sv));
+        CHECK_FALSE(MatchesIfNoneMatch("\"a,b\""sv, "\"a"sv));
+        CHECK_FALSE(MatchesIfNoneMatch("\"a,b\""sv, "b\""sv));
+    }
+
+    SECTION("tags are compared exactly") {
+        CHECK_FALSE(MatchesIfNoneMatch(etag.substr(1, etag.size() - 2), etag));
+        CHECK_FALSE(MatchesIfNoneMatch(etag + "x", etag));
+    }
+}
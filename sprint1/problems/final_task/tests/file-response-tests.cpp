@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "../src/file_response.h"
+
+using namespace http_server;
+using namespace std::literals;
+namespace fs = std::filesystem;
+using tcp = net::ip::tcp;
+
+namespace {
+
+// Временный файл с псевдослучайным содержимым заданного размера
+struct TempFile {
+    fs::path path;
+    std::string contents;
+
+    explicit TempFile(std::size_t size)
+        : path(fs::temp_directory_path() / ("file-response-tests-" + std::to_string(::getpid()))) {
+        contents.reserve(size);
+        unsigned state = 1;
+        for (std::size_t i = 0; i < size; ++i) {
+            state = state * 1103515245 + 12345;
+            contents += static_cast<char>('a' + (state >> 16) % 26);
+        }
+        std::ofstream{path, std::ios::binary} << contents;
+    }
+
+    ~TempFile() {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+
+    std::shared_ptr<const FileHandle> Open() const {
+        return std::make_shared<const FileHandle>(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    }
+};
+
+// Отправляет res через AsyncWriteFile на петлевом интерфейсе и возвращает то, что прочитал клиент.
+// Пока идёт отправка, в том же однопоточном io_context крутится обработчик, считающий, сколько
+// раз ему досталось управление
+struct Transfer {
+    http::response<http::string_body> received;
+    beast::error_code ec;
+    std::size_t written = 0;
+    int ticks = 0;
+    // Сколько раз операция сообщила о прогрессе
+    int progress = 0;
+};
+
+Transfer SendOverLoopback(FileResponse& res) {
+    net::io_context ioc{1};
+    tcp::acceptor acceptor{ioc, {net::ip::make_address("127.0.0.1"), 0}};
+    tcp::socket server{ioc};
+    Transfer transfer;
+
+    std::thread client_thread{[&transfer, endpoint = acceptor.local_endpoint()] {
+        net::io_context client_ioc;
+        tcp::socket client{client_ioc};
+        client.connect(endpoint);
+        beast::flat_buffer buffer;
+        http::response_parser<http::string_body> parser;
+        parser.body_limit(boost::none);
+        http::read(client, buffer, parser);
+        transfer.received = parser.release();
+    }};
+
+    acceptor.accept(server);
+    bool done = false;
+    AsyncWriteFile(
+        server, res,
+        [&] {
+            ++transfer.progress;
+        },
+        [&](beast::error_code ec, std::size_t written) {
+            transfer.ec = ec;
+            transfer.written = written;
+            done = true;
+        });
+    std::function<void()> tick = [&] {
+        if (!done) {
+            ++transfer.ticks;
+            net::post(ioc, tick);
+        }
+    };
+    net::post(ioc, tick);
+    ioc.run();
+    client_thread.join();
+    return transfer;
+}
+
+http::response<http::empty_body> MakeHeader(std::uint64_t content_length) {
+    http::response<http::empty_body> header{http::status::ok, 11};
+    header.set(http::field::content_type, "application/octet-stream");
+    header.set(http::field::content_length, std::to_string(content_length));
+    return header;
+}
+
+}  // namespace
+
+TEST_CASE("AsyncWriteFile sends a file larger than one sendfile chunk") {
+    // Несколько частей по MAX_SENDFILE_SIZE: между ними операция уступает поток
+    const TempFile file{3 * detail::WriteFileOp<tcp::socket>::MAX_SENDFILE_SIZE + 12345};
+    FileResponse res{
+        .header = MakeHeader(file.contents.size()),
+        .file = file.Open(),
+        .offset = 0,
+        .size = file.contents.size(),
+    };
+
+    const auto transfer = SendOverLoopback(res);
+    REQUIRE_FALSE(transfer.ec);
+    CHECK(transfer.received.result() == http::status::ok);
+    CHECK(transfer.received.body() == file.contents);
+    CHECK(transfer.written > file.contents.size());
+    // Другие обработчики io_context получали управление во время отправки
+    CHECK(transfer.ticks > 0);
+    // Заголовок и не меньше четырёх частей тела: по ним сессия продлевает срок записи
+    CHECK(transfer.progress >= 5);
+}
+
+TEST_CASE("AsyncWriteFile sends a range of the file") {
+    const TempFile file{100000};
+    FileResponse res{
+        .header = MakeHeader(1000),
+        .file = file.Open(),
+        .offset = 5000,
+        .size = 1000,
+    };
+
+    const auto transfer = SendOverLoopback(res);
+    REQUIRE_FALSE(transfer.ec);
+    CHECK(transfer.received.body() == file.contents.substr(5000, 1000));
+    CHECK(transfer.progress >= 2);
+}
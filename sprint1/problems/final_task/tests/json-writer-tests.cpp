@@ -0,0 +1,185 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/json.hpp>
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include "../src/json_writer.h"
+#include "../src/map_json.h"
+
+using namespace std::literals;
+namespace json = boost::json;
+using json_writer::JsonWriter;
+
+namespace {
+
+// Строка со всеми управляющими символами, кавычкой, обратной косой чертой,
+// DEL и многобайтовыми символами UTF-8
+std::string MakeTrickyString() {
+    std::string value;
+    for (int c = 0; c < 0x20; ++c) {
+        value += static_cast<char>(c);
+        value += 'a';
+    }
+    value += "\"quoted\" back\\slash / \x7f";
+    value += "Карта №1 — 東京 🐕";
+    return value;
+}
+
+model::Map MakeMap() {
+    model::Map map{model::Map::Id{"map\t\"1\""s}, MakeTrickyString()};
+    map.AddRoad({model::Road::HORIZONTAL, {0, 0}, 40});
+    map.AddRoad({model::Road::VERTICAL, {40, 0}, 30});
+    map.AddRoad({model::Road::HORIZONTAL, {-10, -20}, -5});
+    map.AddBuilding(model::Building{{{5, 5}, {30, 20}}});
+    map.AddBuilding(model::Building{{{-100, 50}, {1, 1}}});
+    map.AddOffice({model::Office::Id{"o0"s}, {40, 30}, {5, 0}});
+    map.AddOffice({model::Office::Id{"\\o1\n"s}, {0, 0}, {-5, -3}});
+    return map;
+}
+
+// Ответ /api/v1/maps/:id через дерево boost::json, как до потоковой записи
+json::object MapToJson(const model::Map& map) {
+    json::object map_obj;
+    map_obj["id"] = *map.GetId();
+    map_obj["name"] = map.GetName();
+    json::array roads_json;
+    for (const auto& road : map.GetRoads()) {
+        json::object road_obj;
+        road_obj["x0"] = road.GetStart().x;
+        road_obj["y0"] = road.GetStart().y;
+        if (road.IsHorizontal()) {
+            road_obj["x1"] = road.GetEnd().x;
+        } else {
+            road_obj["y1"] = road.GetEnd().y;
+        }
+        roads_json.push_back(std::move(road_obj));
+    }
+    map_obj["roads"] = std::move(roads_json);
+    json::array buildings_json;
+    for (const auto& building : map.GetBuildings()) {
+        const auto& bounds = building.GetBounds();
+        json::object building_obj;
+        building_obj["x"] = bounds.position.x;
+        building_obj["y"] = bounds.position.y;
+        building_obj["w"] = bounds.size.width;
+        building_obj["h"] = bounds.size.height;
+        buildings_json.push_back(std::move(building_obj));
+    }
+    map_obj["buildings"] = std::move(buildings_json);
+    json::array offices_json;
+    for (const auto& office : map.GetOffices()) {
+        json::object office_obj;
+        office_obj["id"] = *office.GetId();
+        office_obj["x"] = office.GetPosition().x;
+        office_obj["y"] = office.GetPosition().y;
+        office_obj["offsetX"] = office.GetOffset().dx;
+        office_obj["offsetY"] = office.GetOffset().dy;
+        offices_json.push_back(std::move(office_obj));
+    }
+    map_obj["offices"] = std::move(offices_json);
+    return map_obj;
+}
+
+}  // namespace
+
+TEST_CASE("JsonWriter escapes strings like boost::json::serialize") {
+    SECTION("every single character below 0x80") {
+        for (int c = 0; c < 0x80; ++c) {
+            const std::string value(1, static_cast<char>(c));
+            std::string out;
+            JsonWriter{out}.String(value);
+            INFO("character " << c);
+            CHECK(out == json::serialize(json::string{value}));
+        }
+    }
+    SECTION("a mixed string as a value and as a key") {
+        const auto value = MakeTrickyString();
+        std::string out;
+        JsonWriter{out}.BeginObject().Field(value, value).EndObject();
+        json::object expected;
+        expected[value] = value;
+        CHECK(out == json::serialize(expected));
+    }
+    SECTION("non-ASCII text is written as is") {
+        const auto value = "Привет, мир! 🐕"s;
+        std::string out;
+        JsonWriter{out}.String(value);
+        CHECK(out == json::serialize(json::string{value}));
+        CHECK(out == "\"" + value + "\"");
+    }
+}
+
+TEST_CASE("JsonWriter writes integers and nesting like boost::json::serialize") {
+    std::string out;
+    JsonWriter writer{out};
+    writer.BeginObject()
+        .Field("min", std::numeric_limits<std::int64_t>::min())
+        .Field("max", std::numeric_limits<std::int64_t>::max())
+        .Key("empty")
+        .BeginArray()
+        .EndArray()
+        .Key("nested")
+        .BeginArray()
+        .BeginObject()
+        .EndObject()
+        .Int(0)
+        .String("")
+        .EndArray()
+        .EndObject();
+
+    json::object expected;
+    expected["min"] = std::numeric_limits<std::int64_t>::min();
+    expected["max"] = std::numeric_limits<std::int64_t>::max();
+    expected["empty"] = json::array{};
+    json::array nested;
+    nested.push_back(json::object{});
+    nested.push_back(0);
+    nested.push_back("");
+    expected["nested"] = std::move(nested);
+    CHECK(out == json::serialize(expected));
+}
+
+TEST_CASE("Map JSON matches the boost::json tree byte for byte") {
+    const auto map = MakeMap();
+    const auto expected = json::serialize(MapToJson(map));
+
+    std::string body;
+    JsonWriter writer{body};
+    http_handler::WriteMap(writer, map);
+    CHECK(body == expected);
+
+    // Поток частей даёт те же байты при любом размере части
+    for (const std::size_t chunk_size : {1, 7, 64, 16 * 1024}) {
+        http_handler::MapJsonStream stream{map, chunk_size};
+        std::string streamed;
+        std::string chunk;
+        while (stream.Next(chunk)) {
+            streamed += chunk;
+            chunk.clear();
+        }
+        streamed += chunk;
+        INFO("chunk size " << chunk_size);
+        CHECK(streamed == expected);
+    }
+}
+
+TEST_CASE("Map list JSON matches the boost::json tree byte for byte") {
+    model::Game game;
+    game.AddMap(MakeMap());
+    game.AddMap(model::Map{model::Map::Id{"plain"s}, "Plain map"s});
+
+    json::array expected;
+    for (const auto& map : game.GetMaps()) {
+        json::object map_obj;
+        map_obj["id"] = *map.GetId();
+        map_obj["name"] = map.GetName();
+        expected.push_back(std::move(map_obj));
+    }
+
+    std::string body;
+    JsonWriter writer{body};
+    http_handler::WriteMapList(writer, game.GetMaps());
+    CHECK(body == json::serialize(expected));
+}
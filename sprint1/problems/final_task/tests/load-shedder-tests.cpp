@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+
+#include "../src/request_scheduler.h"
+
+using namespace http_server;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto TARGET = 5ms;
+constexpr auto INTERVAL = 100ms;
+// Время отсчитывается не от нуля часов: так первое окно не совпадает с началом эпохи
+const auto START = LoadShedder::Clock::time_point{} + 1h;
+
+// Проводит через shedder запросы, ждавшие sojourn, с момента from до конца окна, начатого в from
+void FillWindow(LoadShedder& shedder, LoadShedder::Clock::time_point from, LoadShedder::Clock::duration sojourn) {
+    for (auto now = from; now < from + INTERVAL; now += 10ms) {
+        shedder.Admit(now, sojourn);
+    }
+}
+
+}  // namespace
+
+TEST_CASE("LoadShedder lets a burst that drains within the interval through") {
+    LoadShedder shedder{TARGET, INTERVAL};
+    // Всплеск: ожидание растёт, но к концу окна очередь опустошается
+    CHECK(shedder.Admit(START, 50ms) == Admission::ACCEPT);
+    CHECK(shedder.Admit(START + 30ms, 80ms) == Admission::ACCEPT);
+    CHECK(shedder.Admit(START + 60ms, 40ms) == Admission::ACCEPT);
+    CHECK(shedder.Admit(START + 90ms, 1ms) == Admission::ACCEPT);
+
+    // Новое окно: наименьшее ожидание прошлого не превысило target, перегрузки нет
+    CHECK(shedder.Admit(START + INTERVAL, 90ms) == Admission::ACCEPT);
+    CHECK_FALSE(shedder.IsOverloaded());
+    // Но и без перегрузки запрос не ждёт дольше interval
+    CHECK(shedder.Admit(START + INTERVAL + 10ms, INTERVAL + 1ms) == Admission::SHED);
+    CHECK_FALSE(shedder.IsOverloaded());
+}
+
+TEST_CASE("LoadShedder sheds requests over target from a standing queue") {
+    LoadShedder shedder{TARGET, INTERVAL};
+    // Целое окно ни один запрос не дождался обработки за target
+    FillWindow(shedder, START, 20ms);
+    CHECK_FALSE(shedder.IsOverloaded());
+
+    const auto next = START + INTERVAL;
+    CHECK(shedder.Admit(next, 20ms) == Admission::SHED);
+    CHECK(shedder.IsOverloaded());
+    // Отклоняются только запросы, ждавшие дольше target
+    CHECK(shedder.Admit(next + 1ms, 3ms) == Admission::ACCEPT);
+    CHECK(shedder.Admit(next + 2ms, TARGET) == Admission::ACCEPT);
+    CHECK(shedder.Admit(next + 3ms, TARGET + 1ns) == Admission::SHED);
+}
+
+TEST_CASE("LoadShedder stops shedding after a window without waits over target") {
+    LoadShedder shedder{TARGET, INTERVAL};
+    FillWindow(shedder, START, 20ms);
+
+    SECTION("a window with a long wait keeps shedding") {
+        // Пока идут отказы, очередь пуста почти всё окно, но один долгий запрос продлевает перегрузку
+        FillWindow(shedder, START + INTERVAL, 1ms);
+        REQUIRE(shedder.IsOverloaded());
+        CHECK(shedder.Admit(START + INTERVAL + 55ms, 10ms) == Admission::SHED);
+        CHECK(shedder.Admit(START + 2 * INTERVAL, 3ms) == Admission::ACCEPT);
+        CHECK(shedder.IsOverloaded());
+        CHECK(shedder.Admit(START + 2 * INTERVAL + 1ms, 10ms) == Admission::SHED);
+    }
+
+    SECTION("a window with every wait within target recovers") {
+        FillWindow(shedder, START + INTERVAL, TARGET);
+        REQUIRE(shedder.IsOverloaded());
+        CHECK(shedder.Admit(START + 2 * INTERVAL, 20ms) == Admission::ACCEPT);
+        CHECK_FALSE(shedder.IsOverloaded());
+    }
+}
+
+TEST_CASE("LoadShedder forgets overload after an idle interval") {
+    LoadShedder shedder{TARGET, INTERVAL};
+    FillWindow(shedder, START, 20ms);
+    CHECK(shedder.Admit(START + INTERVAL, 20ms) == Admission::SHED);
+    REQUIRE(shedder.IsOverloaded());
+
+    // Целое окно после конца текущего не было запросов: очередь пуста, хотя последний запрос ждал долго
+    CHECK(shedder.Admit(START + 3 * INTERVAL, 20ms) == Admission::ACCEPT);
+    CHECK_FALSE(shedder.IsOverloaded());
+}
+
+TEST_CASE("LoadShedder with a zero interval never sheds") {
+    LoadShedder shedder{TARGET, LoadShedder::Clock::duration::zero()};
+    for (auto now = START; now < START + 10 * INTERVAL; now += 10ms) {
+        CHECK(shedder.Admit(now, 10 * INTERVAL) == Admission::ACCEPT);
+    }
+    CHECK_FALSE(shedder.IsOverloaded());
+}
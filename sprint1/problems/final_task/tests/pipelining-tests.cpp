@@ -0,0 +1,240 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/broadcast_channel.h"
+#include "../src/http_server.h"
+#include "../src/request_handler.h"
+
+using namespace http_server;
+using namespace std::literals;
+
+namespace {
+
+// Обработчик, который копит запросы и отвечает на них в обратном порядке,
+// когда придут все ожидаемые. До ответа он хранит удержания арен запросов
+class ReversingHandler {
+public:
+    explicit ReversingHandler(std::size_t expected)
+        : state_(std::make_shared<State>()) {
+        state_->expected = expected;
+    }
+
+    void operator()(Request&& req, ResponseSender&& send, RequestHold&& hold) const {
+        std::lock_guard lock{state_->mutex};
+        state_->pending.push_back({std::string{req.target()}, req.keep_alive(), std::move(send), std::move(hold)});
+        if (state_->pending.size() != state_->expected) {
+            return;
+        }
+        for (auto it = state_->pending.rbegin(); it != state_->pending.rend(); ++it) {
+            StringResponse res{http::status::ok, 11};
+            res.set(http::field::content_type, "text/plain");
+            res.keep_alive(it->keep_alive);
+            res.body().assign(it->target.begin(), it->target.end());
+            res.prepare_payload();
+            it->send(std::move(res));
+        }
+        state_->pending.clear();
+    }
+
+private:
+    struct Pending {
+        std::string target;
+        bool keep_alive;
+        ResponseSender send;
+        RequestHold hold;
+    };
+
+    struct State {
+        std::mutex mutex;
+        std::size_t expected = 0;
+        std::vector<Pending> pending;
+    };
+
+    std::shared_ptr<State> state_;
+};
+
+// Сервер из одной сессии на петлевом интерфейсе и клиент с блокирующим сокетом
+struct PipeliningFixture {
+    net::io_context ioc;
+    tcp::acceptor acceptor{ioc, {net::ip::make_address("127.0.0.1"), 0}};
+    tcp::socket client{ioc};
+    std::thread server;
+
+    template <typename Handler>
+    void Start(Handler handler, std::size_t pipeline_limit = 16) {
+        acceptor.async_accept(net::make_strand(ioc), [this, handler = std::move(handler), pipeline_limit](
+                                                         beast::error_code ec, SessionSocket socket) mutable {
+            if (ec) {
+                return;
+            }
+            auto permit = std::make_shared<SessionLimiter>(0)->TryAcquire({});
+            std::make_shared<Session<Handler>>(std::move(socket), std::move(*permit), std::move(handler),
+                                               pipeline_limit, SessionTimeouts{})
+                ->Run();
+        });
+        server = std::thread{[this] {
+            ioc.run();
+        }};
+        client.connect(acceptor.local_endpoint());
+    }
+
+    ~PipeliningFixture() {
+        beast::error_code ec;
+        client.close(ec);
+        if (server.joinable()) {
+            server.join();
+        }
+    }
+
+    void Send(std::string_view requests) {
+        net::write(client, net::buffer(requests));
+    }
+
+    // Читает ответы, пока сервер не закроет соединение или не придёт count ответов
+    std::vector<http::response<http::string_body>> Receive(std::size_t count) {
+        std::vector<http::response<http::string_body>> responses;
+        beast::flat_buffer buffer;
+        while (responses.size() < count) {
+            http::response<http::string_body> res;
+            beast::error_code ec;
+            http::read(client, buffer, res, ec);
+            if (ec) {
+                break;
+            }
+            responses.push_back(std::move(res));
+        }
+        return responses;
+    }
+
+    // Читает ответ на HEAD: у него нет тела, хотя Content-Length указан
+    http::response<http::string_body> ReceiveHead(beast::flat_buffer& buffer) {
+        http::response_parser<http::string_body> parser;
+        parser.skip(true);
+        http::read(client, buffer, parser);
+        return parser.release();
+    }
+
+    bool IsClosedByServer() {
+        char byte;
+        beast::error_code ec;
+        client.read_some(net::buffer(&byte, 1), ec);
+        return ec == net::error::eof;
+    }
+};
+
+std::string MakeRequest(std::string_view target, std::string_view connection = {}, std::string_view method = "GET") {
+    std::string request = std::string{method}.append(" ").append(target).append(" HTTP/1.1\r\nHost: localhost\r\n");
+    if (!connection.empty()) {
+        request.append("Connection: ").append(connection).append("\r\n");
+    }
+    return request.append("\r\n");
+}
+
+}  // namespace
+
+TEST_CASE_METHOD(PipeliningFixture, "Session sends pipelined responses in request order") {
+    Start(ReversingHandler{4});
+    // Все запросы уходят одной записью, обработчик отвечает на последний первым
+    Send(MakeRequest("/1") + MakeRequest("/2") + MakeRequest("/3") + MakeRequest("/4"));
+
+    const auto responses = Receive(4);
+    REQUIRE(responses.size() == 4);
+    for (std::size_t i = 0; i < responses.size(); ++i) {
+        CHECK(responses[i].result() == http::status::ok);
+        CHECK(responses[i].body() == "/" + std::to_string(i + 1));
+        CHECK(responses[i].keep_alive());
+    }
+
+    // Соединение остаётся открытым для следующей пачки
+    Send(MakeRequest("/5") + MakeRequest("/6") + MakeRequest("/7") + MakeRequest("/8"));
+    const auto more = Receive(4);
+    REQUIRE(more.size() == 4);
+    CHECK(more.front().body() == "/5");
+    CHECK(more.back().body() == "/8");
+    client.shutdown(tcp::socket::shutdown_send);
+    CHECK(IsClosedByServer());
+}
+
+TEST_CASE_METHOD(PipeliningFixture, "Session closes after a Connection: close response in a pipeline") {
+    // Запрос после Connection: close сессия не читает и обработчику не передаёт
+    Start(ReversingHandler{2});
+    Send(MakeRequest("/1") + MakeRequest("/2", "close") + MakeRequest("/3"));
+
+    const auto responses = Receive(3);
+    REQUIRE(responses.size() == 2);
+    CHECK(responses[0].body() == "/1");
+    CHECK(responses[0].keep_alive());
+    CHECK(responses[1].body() == "/2");
+    CHECK_FALSE(responses[1].keep_alive());
+    CHECK(IsClosedByServer());
+}
+
+
+TEST_CASE_METHOD(PipeliningFixture, "Prepared responses to HEAD carry no body in a pipeline") {
+    model::Game game;
+    game.AddMap(model::Map{model::Map::Id{"map1"s}, "Map 1"s});
+    http_handler::RequestHandler handler{game};
+    Start([&handler](auto&& req, auto&& send, auto&& hold) {
+        handler(std::forward<decltype(req)>(req), std::forward<decltype(send)>(send),
+                std::forward<decltype(hold)>(hold));
+    });
+    // 405 и 400 — готовые ответы с телом. Байты тела после ответа на HEAD клиент принял бы
+    // за начало следующего ответа
+    Send(MakeRequest("/api/v1/maps", {}, "HEAD") + MakeRequest("/api/v1/unknown", {}, "HEAD")
+         + MakeRequest("/api/v1/maps"));
+
+    beast::flat_buffer buffer;
+    const auto not_allowed = ReceiveHead(buffer);
+    CHECK(not_allowed.result() == http::status::method_not_allowed);
+    CHECK(not_allowed[http::field::content_length] != "0");
+    const auto bad_request = ReceiveHead(buffer);
+    CHECK(bad_request.result() == http::status::bad_request);
+
+    http::response<http::string_body> maps;
+    http::read(client, buffer, maps);
+    CHECK(maps.result() == http::status::ok);
+    CHECK(maps.body().find("map1") != std::string::npos);
+    CHECK(maps.keep_alive());
+    // Ничего лишнего после ответа на GET
+    client.shutdown(tcp::socket::shutdown_send);
+    CHECK(buffer.size() == 0);
+    CHECK(IsClosedByServer());
+}
+
+TEST_CASE_METHOD(PipeliningFixture, "WebSocket session reads frames sent with a large handshake") {
+    auto channel = std::make_shared<BroadcastChannel>();
+    Start([channel](Request&& req, ResponseSender&& send, RequestHold&&) {
+        send(MakeWebSocketUpgrade(req, channel));
+    });
+    // Заголовки больше буфера чтения WebSocket-потока, а ping пришёл вместе с ними
+    // и уже лежит в буфере HTTP-сессии
+    const std::string handshake = "GET /api/v1/game/state HTTP/1.1\r\nHost: localhost\r\n"
+                                  "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                                  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n"
+                                  "Cookie: session="s
+                                  + std::string(6000, 'a') + "\r\n\r\n";
+    // Замаскированный ping с телом "hi" (маска из нулей оставляет тело как есть)
+    const std::string ping = "\x89\x82\x00\x00\x00\x00hi"s;
+    Send(handshake + ping);
+
+    beast::flat_buffer buffer;
+    http::response<http::empty_body> res;
+    http::read(client, buffer, res);
+    REQUIRE(res.result() == http::status::switching_protocols);
+
+    // Сервер ответил pong с тем же телом: ping не потерялся при переключении
+    const std::string pong = "\x8A\x02hi"s;
+    while (buffer.size() < pong.size()) {
+        buffer.commit(client.read_some(buffer.prepare(pong.size() - buffer.size())));
+    }
+    CHECK(beast::buffers_to_string(buffer.data()) == pong);
+}
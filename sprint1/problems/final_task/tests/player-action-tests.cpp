@@ -0,0 +1,98 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <string_view>
+
+#include "../src/player_action.h"
+
+using namespace http_handler;
+using namespace std::literals;
+
+namespace {
+
+std::optional<MoveDirection> GetMove(const std::optional<PlayerAction>& action) {
+    return action ? std::optional{action->move} : std::nullopt;
+}
+
+// Быстрый разбор не должен расходиться с полным разбором boost::json
+void CheckSameAsDom(std::string_view body, std::optional<MoveDirection> expected) {
+    INFO("body: " << body);
+    const auto move = GetMove(ParsePlayerAction(body));
+    CHECK(move == GetMove(detail::ParsePlayerActionDom(body)));
+    CHECK(move == expected);
+}
+
+}  // namespace
+
+TEST_CASE("ParsePlayerAction accepts canonical bodies") {
+    CheckSameAsDom(R"({"move":"L"})", MoveDirection::LEFT);
+    CheckSameAsDom(R"({"move":"R"})", MoveDirection::RIGHT);
+    CheckSameAsDom(R"({"move":"U"})", MoveDirection::UP);
+    CheckSameAsDom(R"({"move":"D"})", MoveDirection::DOWN);
+    CheckSameAsDom(R"({"move":""})", MoveDirection::STOP);
+}
+
+TEST_CASE("ParsePlayerAction allows JSON whitespace between tokens") {
+    CheckSameAsDom(R"( { "move" : "L" } )", MoveDirection::LEFT);
+    CheckSameAsDom("{\n\t\"move\":\r\n\"R\"\n}\n", MoveDirection::RIGHT);
+    CheckSameAsDom("\t{\"move\"  :\"\"}  ", MoveDirection::STOP);
+    // Пробел внутри строки — часть значения
+    CheckSameAsDom(R"({"move":" U"})", std::nullopt);
+    // Пробелы вне множества пробелов JSON
+    CheckSameAsDom("{\v\"move\":\"D\"}", std::nullopt);
+    CheckSameAsDom("{\"move\":\"D\"}\f", std::nullopt);
+}
+
+TEST_CASE("ParsePlayerAction unescapes strings like boost::json") {
+    CheckSameAsDom(R"({"move":"\u004C"})", MoveDirection::LEFT);
+    CheckSameAsDom(R"({"move":"\u0052"})", MoveDirection::RIGHT);
+    CheckSameAsDom(R"({"\u006dove":"U"})", MoveDirection::UP);
+    CheckSameAsDom(R"({"move":"\u0044\u0044"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"\n"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"L\"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"\q"})", std::nullopt);
+}
+
+TEST_CASE("ParsePlayerAction handles duplicate and extra members") {
+    CheckSameAsDom(R"({"move":"L","extra":1})", MoveDirection::LEFT);
+    CheckSameAsDom(R"({"extra":[1,2,{"move":"R"}],"move":"D"})", MoveDirection::DOWN);
+    CheckSameAsDom(R"({"extra":"x"})", std::nullopt);
+    CheckSameAsDom(R"({"Move":"L"})", std::nullopt);
+    // Какое из повторённых значений выигрывает, решает boost::json: быстрый разбор с ним совпадает
+    for (const auto body : {R"({"move":"L","move":"R"})"sv, R"({"move":"L","move":"X"})"sv}) {
+        CheckSameAsDom(body, GetMove(detail::ParsePlayerActionDom(body)));
+    }
+}
+
+TEST_CASE("ParsePlayerAction rejects malformed bodies") {
+    // Мусор после объекта
+    CheckSameAsDom(R"({"move":"L"}x)", std::nullopt);
+    CheckSameAsDom(R"({"move":"L"}})", std::nullopt);
+    CheckSameAsDom(R"({"move":"L"}{})", std::nullopt);
+    CheckSameAsDom("{\"move\":\"L\"}\0"sv, std::nullopt);
+    // Незавершённые тела
+    CheckSameAsDom("", std::nullopt);
+    CheckSameAsDom("{", std::nullopt);
+    CheckSameAsDom(R"({"move":"L")", std::nullopt);
+    CheckSameAsDom(R"({"move":"L)", std::nullopt);
+    CheckSameAsDom(R"({"move":"L",})", std::nullopt);
+    // Не объект
+    CheckSameAsDom(R"(["move","L"])", std::nullopt);
+    CheckSameAsDom(R"("L")", std::nullopt);
+    CheckSameAsDom("null", std::nullopt);
+    CheckSameAsDom("42", std::nullopt);
+}
+
+TEST_CASE("ParsePlayerAction rejects bad move values") {
+    CheckSameAsDom(R"({"move":"X"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"l"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"LR"})", std::nullopt);
+    CheckSameAsDom(R"({"move":"Left"})", std::nullopt);
+    CheckSameAsDom(R"({"move":null})", std::nullopt);
+    CheckSameAsDom(R"({"move":76})", std::nullopt);
+    CheckSameAsDom(R"({"move":["L"]})", std::nullopt);
+    CheckSameAsDom(R"({"move":{"L":1}})", std::nullopt);
+    // Недопустимый UTF-8 и управляющий символ внутри строки
+    CheckSameAsDom("{\"move\":\"\xff\"}", std::nullopt);
+    CheckSameAsDom("{\"move\":\"L\x01\"}", std::nullopt);
+}
@@ -0,0 +1,243 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/request_handler.h"
+
+using namespace http_handler;
+using namespace std::literals;
+
+namespace {
+
+// Карта, сериализация которой заметно дольше, чем запуск потоков
+model::Game MakeGame() {
+    model::Map map{model::Map::Id{"map1"s}, "Map 1"s};
+    for (int i = 0; i < 4000; ++i) {
+        map.AddRoad({model::Road::HORIZONTAL, model::Point{0, i}, 100});
+    }
+    model::Game game;
+    game.AddMap(std::move(map));
+    return game;
+}
+
+// Отправляет обработчику запрос карты. Без планировщика ответ отправляется сразу
+http_server::Response GetMap(RequestHandler& handler, bool gzip = false) {
+    Request req{http::verb::get, "/api/v1/maps/map1", 11};
+    if (gzip) {
+        req.set(http::field::accept_encoding, "gzip");
+    }
+    std::optional<http_server::Response> response;
+    handler(std::move(req),
+            [&](http_server::Response&& res) {
+                response = std::move(res);
+            },
+            http_server::RequestHold{});
+    REQUIRE(response);
+    return std::move(*response);
+}
+
+// Дочитывает тело ответа, формируемое по частям
+std::string ReadBody(http_server::StreamResponse&& res) {
+    std::string body;
+    while (res.body()->Next(body)) {
+    }
+    return body;
+}
+
+}  // namespace
+
+TEST_CASE("RequestHandler coalesces concurrent requests for a map outside the catalog") {
+    auto game = MakeGame();
+    // С маленьким пределом карты нет в каталоге, и её тело формируется при запросе
+    RequestHandlerOptions options;
+    options.max_cached_map_size = 1024;
+    RequestHandler handler{game, std::move(options)};
+    constexpr int REQUESTS = 4;
+
+    // Ответы ещё не отправлены: тело формируется, и новые запросы присоединяются к нему
+    std::vector<http_server::StreamResponse> responses;
+    for (int i = 0; i < REQUESTS; ++i) {
+        responses.push_back(std::get<http_server::StreamResponse>(GetMap(handler)));
+    }
+    // Запрос со сжатием получает другое тело
+    auto compressed = std::get<http_server::StreamResponse>(GetMap(handler, true));
+    const auto& stats = handler.GetCoalescingStats();
+    CHECK(stats.leaders == 2);
+    CHECK(stats.followers == REQUESTS - 1);
+
+    // Сериализация карты та же, что у запроса без объединения
+    RequestHandlerOptions separate_options;
+    separate_options.max_cached_map_size = 1024;
+    separate_options.coalesce_requests = false;
+    RequestHandler separate{game, std::move(separate_options)};
+    const auto expected = ReadBody(std::get<http_server::StreamResponse>(GetMap(separate)));
+    for (auto& response : responses) {
+        CHECK(ReadBody(std::move(response)) == expected);
+    }
+    CHECK(compressed[http::field::content_encoding] == "gzip");
+    CHECK(ReadBody(std::move(compressed)) != expected);
+
+    // Тело не кешируется: следующий запрос формирует его заново
+    responses.clear();
+    CHECK(ReadBody(std::get<http_server::StreamResponse>(GetMap(handler))) == expected);
+    CHECK(stats.leaders == 3);
+    CHECK(stats.followers == REQUESTS - 1);
+}
+
+TEST_CASE("RequestHandler does not coalesce catalog requests") {
+    auto game = MakeGame();
+    RequestHandler handler{game};
+
+    // Карта в каталоге уже сериализована: все запросы получают один готовый ответ без объединения
+    const auto first = std::get<http_server::CachedResponse>(GetMap(handler)).response;
+    for (int i = 0; i < 3; ++i) {
+        CHECK(std::get<http_server::CachedResponse>(GetMap(handler)).response == first);
+    }
+    CHECK(first->GetStatus() == http::status::ok);
+    CHECK(handler.GetCoalescingStats().leaders == 0);
+    CHECK(handler.GetCoalescingStats().followers == 0);
+}
+
+TEST_CASE("RequestHandler does not coalesce requests when coalescing is off") {
+    auto game = MakeGame();
+    RequestHandlerOptions options;
+    options.max_cached_map_size = 1024;
+    options.coalesce_requests = false;
+    RequestHandler handler{game, std::move(options)};
+
+    // Без объединения каждый запрос сериализует карту вне каталога сам
+    auto first = GetMap(handler);
+    auto second = GetMap(handler);
+    CHECK(std::holds_alternative<http_server::StreamResponse>(first));
+    CHECK(std::holds_alternative<http_server::StreamResponse>(second));
+    CHECK(handler.GetCoalescingStats().leaders == 0);
+    CHECK(handler.GetCoalescingStats().followers == 0);
+}
+
+TEST_CASE("RequestHandler sheds requests with 503 and Retry-After when the queue stands") {
+    auto game = MakeGame();
+    // Один поток API, а карта вне каталога сериализуется при каждом запросе: запросы, пришедшие разом,
+    // стоят в очереди всё дольше, и после окна, в котором ни один не дождался обработки за бюджет,
+    // ждавшие дольше бюджета получают отказ
+    RequestHandlerOptions options;
+    options.max_cached_map_size = 1024;
+    options.scheduling = http_server::RequestSchedulerOptions{
+        .game_api = {.threads = 1,
+                     .latency_budget = std::chrono::milliseconds{1},
+                     .shedding_interval = std::chrono::milliseconds{10}},
+        .static_files = {},
+        .retry_after = std::chrono::seconds{2},
+    };
+    RequestHandler handler{game, std::move(options)};
+    constexpr int REQUESTS = 300;
+
+    std::mutex mutex;
+    std::condition_variable all_sent;
+    std::vector<http::status> responses;
+    std::size_t retry_after = 0;
+    for (int i = 0; i < REQUESTS; ++i) {
+        handler(Request{http::verb::get, "/api/v1/maps/map1", 11},
+                [&](http_server::Response&& res) {
+                    // Тело карты дочитывается в потоке пула, как если бы его сразу отправляли
+                    auto status = http::status::ok;
+                    bool has_retry_after = false;
+                    if (auto* stream = std::get_if<http_server::StreamResponse>(&res)) {
+                        ReadBody(std::move(*stream));
+                    } else {
+                        const auto& response = std::get<http_server::CachedResponse>(res).response;
+                        status = response->GetStatus();
+                        has_retry_after =
+                            response->GetHeaderBlock().find("Retry-After: 2\r\n") != std::string::npos;
+                    }
+                    std::lock_guard lock{mutex};
+                    responses.push_back(status);
+                    retry_after += has_retry_after;
+                    all_sent.notify_one();
+                },
+                http_server::RequestHold{});
+    }
+    {
+        std::unique_lock lock{mutex};
+        all_sent.wait(lock, [&] {
+            return responses.size() == REQUESTS;
+        });
+    }
+    handler.StopScheduling();
+
+    // Первый запрос не ждал и обработан
+    CHECK(responses.front() == http::status::ok);
+    std::size_t shed = 0;
+    for (const auto status : responses) {
+        if (status == http::status::service_unavailable) {
+            ++shed;
+        } else {
+            CHECK(status == http::status::ok);
+        }
+    }
+    CHECK(shed > 0);
+    CHECK(retry_after == shed);
+    CHECK(handler.GetScheduler()->GetStats(http_server::RequestClass::GAME_API).shed == shed);
+}
+
+TEST_CASE("RequestHandler answers 500 when a scheduled request throws") {
+    auto game = MakeGame();
+    RequestHandlerOptions options;
+    options.scheduling = http_server::RequestSchedulerOptions{};
+    RequestHandler handler{game, std::move(options)};
+
+    // Отправка ответа бросает исключение, в том числе не наследника std::exception:
+    // поток пула продолжает работать, а клиент получает 500
+    for (const bool std_exception : {true, false}) {
+        std::mutex mutex;
+        std::condition_variable sent;
+        std::vector<http::status> statuses;
+        handler(Request{http::verb::get, "/api/v1/maps", 11},
+                [&](http_server::Response&& res) {
+                    std::lock_guard lock{mutex};
+                    statuses.push_back(std::get<http_server::CachedResponse>(res).response->GetStatus());
+                    if (statuses.size() == 1) {
+                        if (std_exception) {
+                            throw std::runtime_error("send failed");
+                        }
+                        throw 42;
+                    }
+                    sent.notify_one();
+                },
+                http_server::RequestHold{});
+        std::unique_lock lock{mutex};
+        sent.wait(lock, [&] {
+            return statuses.size() == 2;
+        });
+        CHECK(statuses == std::vector<http::status>{http::status::ok, http::status::internal_server_error});
+    }
+    handler.StopScheduling();
+}
+
+TEST_CASE("RequestHandler refuses a WebSocket upgrade without game states") {
+    model::Game game;
+    RequestHandler handler{game};
+
+    // Без движка тиков подписчикам нечего рассылать: соединение не переключается
+    Request req{http::verb::get, "/api/v1/game/state", 11};
+    req.set(http::field::host, "localhost");
+    req.set(http::field::upgrade, "websocket");
+    req.set(http::field::connection, "Upgrade");
+    req.set(http::field::sec_websocket_key, "dGhlIHNhbXBsZSBub25jZQ==");
+    req.set(http::field::sec_websocket_version, "13");
+    std::optional<http_server::Response> response;
+    handler(std::move(req),
+            [&](http_server::Response&& res) {
+                response = std::move(res);
+            },
+            http_server::RequestHold{});
+    REQUIRE(response);
+    const auto* cached = std::get_if<http_server::CachedResponse>(&*response);
+    REQUIRE(cached);
+    CHECK(cached->response->GetStatus() == http::status::bad_request);
+}
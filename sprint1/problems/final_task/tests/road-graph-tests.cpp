@@ -0,0 +1,132 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <vector>
+
+#include "../src/road_graph.h"
+
+using namespace model;
+
+namespace {
+
+RoadGraph::NodeId RequireNode(const RoadGraph& graph, Point position) {
+    const auto node = graph.FindNode(position);
+    REQUIRE(node.has_value());
+    return *node;
+}
+
+// Узел, в который ведёт выход из from в направлении direction
+Point GetNeighbour(const RoadGraph& graph, Point from, Direction direction) {
+    const auto node = RequireNode(graph, from);
+    const auto edge = graph.GetExit(node, direction);
+    REQUIRE(edge != RoadGraph::NONE);
+    return graph.GetNodePosition(graph.GetOppositeNode(edge, node));
+}
+
+bool Equal(Point lhs, Point rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+}  // namespace
+
+TEST_CASE("RoadGraph puts nodes at road ends and crossings") {
+    // Горизонтальная улица из двух соприкасающихся дорог и вертикальная, пересекающая её
+    const std::vector<Road> roads{
+        {Road::HORIZONTAL, Point{0, 0}, 10},
+        {Road::HORIZONTAL, Point{20, 0}, 10},
+        {Road::VERTICAL, Point{5, -5}, 5},
+    };
+    const RoadGraph graph{roads};
+
+    CHECK(graph.GetNodeCount() == 5);
+    CHECK(graph.GetEdgeCount() == 4);
+    for (const Point node : {Point{0, 0}, Point{5, 0}, Point{20, 0}, Point{5, -5}, Point{5, 5}}) {
+        CHECK(graph.FindNode(node).has_value());
+    }
+    // Место, где соприкасаются дороги одной улицы, — не перекрёсток
+    CHECK_FALSE(graph.FindNode({10, 0}).has_value());
+    CHECK_FALSE(graph.FindNode({1, 1}).has_value());
+
+    const auto crossing = RequireNode(graph, {5, 0});
+    CHECK(graph.GetIncidentEdges(crossing).size() == 4);
+    CHECK(Equal(GetNeighbour(graph, {5, 0}, Direction::WEST), {0, 0}));
+    CHECK(Equal(GetNeighbour(graph, {5, 0}, Direction::EAST), {20, 0}));
+    CHECK(Equal(GetNeighbour(graph, {5, 0}, Direction::NORTH), {5, -5}));
+    CHECK(Equal(GetNeighbour(graph, {5, 0}, Direction::SOUTH), {5, 5}));
+
+    const auto east = graph.GetExit(crossing, Direction::EAST);
+    CHECK(graph.IsHorizontal(east));
+    CHECK(graph.GetEdgeLength(east) == 15);
+    CHECK(graph.GetEdge(east).from == crossing);
+    const auto south = graph.GetExit(crossing, Direction::SOUTH);
+    CHECK_FALSE(graph.IsHorizontal(south));
+    CHECK(graph.GetEdgeLength(south) == 5);
+
+    const auto end = RequireNode(graph, {20, 0});
+    CHECK(graph.GetIncidentEdges(end).size() == 1);
+    CHECK(graph.GetExit(end, Direction::EAST) == RoadGraph::NONE);
+    CHECK(graph.GetExit(end, Direction::NORTH) == RoadGraph::NONE);
+    CHECK(graph.GetExit(end, Direction::WEST) == east);
+}
+
+TEST_CASE("RoadGraph joins T-junctions and overlapping roads") {
+    const std::vector<Road> roads{
+        {Road::HORIZONTAL, Point{0, 0}, 20},
+        {Road::HORIZONTAL, Point{5, 0}, 15},
+        // Заканчивается на улице: Т-образный перекрёсток
+        {Road::VERTICAL, Point{10, 0}, 10},
+        // Начинается рядом с улицей, но не касается её
+        {Road::VERTICAL, Point{30, 1}, 10},
+    };
+    const RoadGraph graph{roads};
+
+    CHECK(graph.GetNodeCount() == 6);
+    CHECK(graph.GetEdgeCount() == 4);
+    const auto junction = RequireNode(graph, {10, 0});
+    CHECK(graph.GetIncidentEdges(junction).size() == 3);
+    CHECK(graph.GetExit(junction, Direction::NORTH) == RoadGraph::NONE);
+    CHECK(Equal(GetNeighbour(graph, {10, 0}, Direction::SOUTH), {10, 10}));
+    CHECK(Equal(GetNeighbour(graph, {10, 0}, Direction::EAST), {20, 0}));
+    CHECK(Equal(GetNeighbour(graph, {30, 1}, Direction::SOUTH), {30, 10}));
+    CHECK_FALSE(graph.FindNode({5, 0}).has_value());
+    CHECK_FALSE(graph.FindNode({15, 0}).has_value());
+}
+
+TEST_CASE("RoadGraph of a grid connects neighbouring crossings") {
+    constexpr Coord BLOCK = 10;
+    constexpr int N = 8;
+    std::vector<Road> roads;
+    for (int i = 0; i < N; ++i) {
+        const Coord line = i * BLOCK;
+        for (int j = 0; j + 1 < N; ++j) {
+            const Coord from = j * BLOCK;
+            roads.emplace_back(Road::HORIZONTAL, Point{from, line}, from + BLOCK);
+            roads.emplace_back(Road::VERTICAL, Point{line, from + BLOCK}, from);
+        }
+    }
+    const RoadGraph graph{roads};
+
+    REQUIRE(graph.GetNodeCount() == N * N);
+    CHECK(graph.GetEdgeCount() == 2 * N * (N - 1));
+    std::size_t incident = 0;
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const Point position{x * BLOCK, y * BLOCK};
+            const auto node = RequireNode(graph, position);
+            CHECK(Equal(graph.GetNodePosition(node), position));
+            const auto edges = graph.GetIncidentEdges(node);
+            incident += edges.size();
+            CHECK(edges.size() == std::size_t{2} + (x > 0 && x + 1 < N) + (y > 0 && y + 1 < N));
+            if (x + 1 < N) {
+                CHECK(Equal(GetNeighbour(graph, position, Direction::EAST), {position.x + BLOCK, position.y}));
+            }
+            if (y > 0) {
+                CHECK(Equal(GetNeighbour(graph, position, Direction::NORTH), {position.x, position.y - BLOCK}));
+            }
+            for (const auto edge : edges) {
+                CHECK(graph.GetEdgeLength(edge) == BLOCK);
+            }
+        }
+    }
+    CHECK(incident == 2 * graph.GetEdgeCount());
+}
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "../src/road_index.h"
+
+using namespace model;
+
+namespace {
+
+constexpr double HALF_WIDTH = RoadIndex::ROAD_HALF_WIDTH;
+
+std::vector<std::size_t> FindRoads(const RoadIndex& index, Position position) {
+    std::vector<std::size_t> roads;
+    index.ForEachRoadAt(position, [&roads](std::size_t road) {
+        roads.push_back(road);
+    });
+    std::sort(roads.begin(), roads.end());
+    return roads;
+}
+
+bool Covers(const Road& road, Position position) {
+    const auto start = road.GetStart();
+    const auto end = road.GetEnd();
+    return position.x >= std::min(start.x, end.x) - HALF_WIDTH && position.x <= std::max(start.x, end.x) + HALF_WIDTH
+        && position.y >= std::min(start.y, end.y) - HALF_WIDTH && position.y <= std::max(start.y, end.y) + HALF_WIDTH;
+}
+
+bool Equal(Position lhs, Position rhs) {
+    return lhs.x == rhs.x && lhs.y == rhs.y;
+}
+
+}  // namespace
+
+TEST_CASE("RoadIndex finds roads covering a point") {
+    const std::vector<Road> roads{
+        {Road::HORIZONTAL, Point{0, 0}, 10},
+        {Road::VERTICAL, Point{10, 0}, 10},
+        {Road::HORIZONTAL, Point{4, 5}, 0},
+        {Road::HORIZONTAL, Point{20, 0}, 30},
+    };
+    const RoadIndex index{roads};
+
+    CHECK(FindRoads(index, {5, 0}) == std::vector<std::size_t>{0});
+    CHECK(FindRoads(index, {10, 0}) == std::vector<std::size_t>{0, 1});
+    CHECK(FindRoads(index, {10.4, 0.4}) == std::vector<std::size_t>{0, 1});
+    CHECK(FindRoads(index, {10, 0.5}) == std::vector<std::size_t>{1});
+    CHECK(FindRoads(index, {2, 5.3}) == std::vector<std::size_t>{2});
+    CHECK(FindRoads(index, {-0.4, -0.4}) == std::vector<std::size_t>{0});
+    CHECK(FindRoads(index, {25, 0}) == std::vector<std::size_t>{3});
+
+    CHECK(index.IsOnRoad({10, 7.5}));
+    CHECK_FALSE(index.IsOnRoad({5, 0.5}));
+    CHECK_FALSE(index.IsOnRoad({15, 0}));
+    CHECK_FALSE(index.IsOnRoad({-0.5, 0}));
+}
+
+TEST_CASE("RoadIndex finds the farthest reachable point") {
+    const std::vector<Road> roads{
+        {Road::HORIZONTAL, Point{0, 0}, 10},
+        {Road::VERTICAL, Point{10, 0}, 10},
+        {Road::HORIZONTAL, Point{20, 0}, 30},
+    };
+    const RoadIndex index{roads};
+
+    CHECK(Equal(index.GetFarthestPoint({5, 0}, Direction::EAST), {10.4, 0}));
+    CHECK(Equal(index.GetFarthestPoint({5, 0}, Direction::WEST), {-0.4, 0}));
+    CHECK(Equal(index.GetFarthestPoint({5, 0.2}, Direction::NORTH), {5, -0.4}));
+    CHECK(Equal(index.GetFarthestPoint({5, 0}, Direction::SOUTH), {5, 0.4}));
+    CHECK(Equal(index.GetFarthestPoint({10, 5}, Direction::SOUTH), {10, 10.4}));
+    CHECK(Equal(index.GetFarthestPoint({10, 5}, Direction::NORTH), {10, -0.4}));
+    CHECK(Equal(index.GetFarthestPoint({10, 5}, Direction::EAST), {10.4, 5}));
+    // С вертикальной дороги на перекрёстке можно свернуть на горизонтальную
+    CHECK(Equal(index.GetFarthestPoint({10, 0}, Direction::WEST), {-0.4, 0}));
+
+    SECTION("a point on the edge where a move stopped is still on the road") {
+        const auto edge = index.GetFarthestPoint({5, 0}, Direction::EAST);
+        CHECK(index.IsOnRoad(edge));
+        CHECK(Equal(index.GetFarthestPoint(edge, Direction::SOUTH), {edge.x, 10.4}));
+        CHECK(Equal(index.GetFarthestPoint(edge, Direction::WEST), {-0.4, 0}));
+    }
+
+    SECTION("a point off the roads stays in place") {
+        CHECK(Equal(index.GetFarthestPoint({5, 3}, Direction::EAST), {5, 3}));
+        CHECK(Equal(index.GetFarthestPoint({15, 0}, Direction::WEST), {15, 0}));
+    }
+}
+
+TEST_CASE("RoadIndex joins touching and overlapping roads of one line") {
+    const std::vector<Road> roads{
+        {Road::HORIZONTAL, Point{0, 0}, 10},
+        {Road::HORIZONTAL, Point{10, 0}, 20},
+        {Road::HORIZONTAL, Point{30, 0}, 15},
+        {Road::HORIZONTAL, Point{2, 0}, 4},
+    };
+    const RoadIndex index{roads};
+
+    CHECK(Equal(index.GetFarthestPoint({1, 0}, Direction::EAST), {30.4, 0}));
+    CHECK(Equal(index.GetFarthestPoint({29, 0.3}, Direction::WEST), {-0.4, 0.3}));
+    CHECK(FindRoads(index, {3, 0}) == std::vector<std::size_t>{0, 3});
+    CHECK(FindRoads(index, {17, 0}) == std::vector<std::size_t>{1, 2});
+    CHECK(FindRoads(index, {10, 0}) == std::vector<std::size_t>{0, 1});
+}
+
+TEST_CASE("RoadIndex lookups match a scan over all roads") {
+    // Решётка кварталов, поверх каждой четвёртой улицы — сквозной проспект
+    constexpr Coord BLOCK = 10;
+    constexpr int N = 12;
+    std::vector<Road> roads;
+    for (int i = 0; i < N; ++i) {
+        const Coord line = i * BLOCK;
+        for (int j = 0; j + 1 < N; ++j) {
+            const Coord from = j * BLOCK;
+            roads.emplace_back(Road::HORIZONTAL, Point{from, line}, from + BLOCK);
+            roads.emplace_back(Road::VERTICAL, Point{line, from + BLOCK}, from);
+        }
+        if (i % 4 == 0) {
+            roads.emplace_back(Road::HORIZONTAL, Point{(N - 1) * BLOCK, line}, 0);
+            roads.emplace_back(Road::VERTICAL, Point{line, 0}, (N - 1) * BLOCK);
+        }
+    }
+    const RoadIndex index{roads};
+
+    std::mt19937_64 random{42};
+    std::uniform_real_distribution<double> coord{-1.0, N * BLOCK};
+    std::uniform_int_distribution<int> snap{0, 2};
+    for (int i = 0; i < 10'000; ++i) {
+        Position position{coord(random), coord(random)};
+        // Чаще всего точка на линии дороги или на краю дороги
+        if (const int mode = snap(random); mode != 0) {
+            auto& across = i % 2 == 0 ? position.x : position.y;
+            across = std::round(across / BLOCK) * BLOCK + (mode == 1 ? 0.0 : HALF_WIDTH);
+        }
+        std::vector<std::size_t> expected;
+        for (std::size_t road = 0; road < roads.size(); ++road) {
+            if (Covers(roads[road], position)) {
+                expected.push_back(road);
+            }
+        }
+        INFO("x = " << position.x << ", y = " << position.y);
+        REQUIRE(FindRoads(index, position) == expected);
+        REQUIRE(index.IsOnRoad(position) == !expected.empty());
+    }
+}
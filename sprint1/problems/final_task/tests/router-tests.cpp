@@ -0,0 +1,123 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <stdexcept>
+#include <string_view>
+
+#include "../src/router.h"
+
+using namespace http_server;
+using namespace std::literals;
+
+namespace {
+
+using TestRouter = Router<int>;
+using Status = TestRouter::Status;
+using http::verb;
+
+TestRouter MakeRouter() {
+    TestRouter router;
+    router.Add("/api/v1/maps", {verb::get, verb::head}, 1);
+    router.Add("/api/v1/maps/:id", {verb::get, verb::head}, 2);
+    router.Add("/api/v1/maps/special", {verb::get}, 3);
+    router.Add("/api/v1/maps/:id/roads/:road", {verb::get}, 4);
+    router.Add("/api/v1/game/join", {verb::post}, 5);
+    return router;
+}
+
+}  // namespace
+
+TEST_CASE("Router finds routes with constant segments") {
+    const auto router = MakeRouter();
+
+    const auto match = router.Find(verb::get, "/api/v1/maps"sv);
+    CHECK(match.status == Status::FOUND);
+    REQUIRE(match.route != nullptr);
+    CHECK(match.route->value == 1);
+    CHECK(match.params.Size() == 0);
+
+    SECTION("query string and trailing slash are ignored") {
+        for (auto target : {"/api/v1/maps/"sv, "/api/v1/maps?x=1"sv, "/api/v1/maps/?x=/a/b"sv, "api/v1/maps"sv}) {
+            const auto other = router.Find(verb::get, target);
+            CHECK(other.status == Status::FOUND);
+            CHECK(other.route == match.route);
+        }
+    }
+
+    SECTION("unknown and partial paths are not found") {
+        for (auto target : {"/"sv, ""sv, "/api/v1"sv, "/api/v1/map"sv, "/api/v1/maps/a/b"sv, "/api/v2/maps"sv}) {
+            const auto other = router.Find(verb::get, target);
+            CHECK(other.status == Status::NOT_FOUND);
+            CHECK(other.route == nullptr);
+        }
+    }
+}
+
+TEST_CASE("Router extracts path parameters as views into the target") {
+    const auto router = MakeRouter();
+    const auto target = "/api/v1/maps/town/roads/7?full=1"sv;
+
+    const auto match = router.Find(verb::get, target);
+    REQUIRE(match.status == Status::FOUND);
+    CHECK(match.route->value == 4);
+    REQUIRE(match.params.Size() == 2);
+    CHECK(match.params.Get("id"sv) == "town"sv);
+    CHECK(match.params.Get("road"sv) == "7"sv);
+    CHECK(match.params[0] == "town"sv);
+    CHECK(match.params.Get("missing"sv).empty());
+    CHECK(match.params.Get("id"sv).data() == target.data() + "/api/v1/maps/"sv.size());
+
+    SECTION("an empty parameter does not match") {
+        CHECK(router.Find(verb::get, "/api/v1/maps//roads/7"sv).status == Status::NOT_FOUND);
+    }
+}
+
+TEST_CASE("Router prefers constant segments and falls back to parameters") {
+    const auto router = MakeRouter();
+
+    const auto special = router.Find(verb::get, "/api/v1/maps/special"sv);
+    REQUIRE(special.status == Status::FOUND);
+    CHECK(special.route->value == 3);
+
+    const auto map = router.Find(verb::get, "/api/v1/maps/map1"sv);
+    REQUIRE(map.status == Status::FOUND);
+    CHECK(map.route->value == 2);
+    CHECK(map.params.Get("id"sv) == "map1"sv);
+
+    // Под константой "special" маршрута с дорогами нет, поэтому находится путь через параметр
+    const auto roads = router.Find(verb::get, "/api/v1/maps/special/roads/1"sv);
+    REQUIRE(roads.status == Status::FOUND);
+    CHECK(roads.route->value == 4);
+    CHECK(roads.params.Get("id"sv) == "special"sv);
+    CHECK(roads.params.Get("road"sv) == "1"sv);
+}
+
+TEST_CASE("Router reports disallowed methods with the Allow header value") {
+    const auto router = MakeRouter();
+
+    const auto post = router.Find(verb::post, "/api/v1/maps/map1"sv);
+    CHECK(post.status == Status::METHOD_NOT_ALLOWED);
+    REQUIRE(post.route != nullptr);
+    CHECK(post.route->allow == "GET, HEAD"sv);
+    CHECK(post.params.Get("id"sv) == "map1"sv);
+
+    CHECK(router.Find(verb::head, "/api/v1/maps/map1"sv).status == Status::FOUND);
+    CHECK(router.Find(verb::get, "/api/v1/game/join"sv).route->allow == "POST"sv);
+}
+
+TEST_CASE("Router rejects invalid routes") {
+    TestRouter router;
+    router.Add("/a/:x", {verb::get}, 1);
+
+    CHECK_THROWS_AS(router.Add("/a/:y", {verb::get}, 2), std::invalid_argument);
+    CHECK_THROWS_AS(router.Add("/b", {}, 2), std::invalid_argument);
+    CHECK_THROWS_AS(router.Add("/c/:", {verb::get}, 2), std::invalid_argument);
+    CHECK_THROWS_AS(router.Add("/d/:a/:b/:c/:d/:e", {verb::get}, 2), std::invalid_argument);
+    CHECK(router.GetRoutes().size() == 1);
+}
+
+TEST_CASE("GetRoutePath strips the query string and trailing slashes") {
+    CHECK(GetRoutePath("/api/v1/maps/map1/?x=1"sv) == "/api/v1/maps/map1"sv);
+    CHECK(GetRoutePath("/api/v1/maps//"sv) == "/api/v1/maps"sv);
+    CHECK(GetRoutePath("/"sv) == "/"sv);
+    CHECK(GetRoutePath("/?x"sv) == "/"sv);
+}
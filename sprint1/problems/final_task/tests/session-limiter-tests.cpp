@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "../src/session_limiter.h"
+
+using namespace http_server;
+
+namespace net = boost::asio;
+
+namespace {
+
+// Приём соединений, как у Listener: без разрешения он ждёт освобождения места
+// и повторяет попытку в io_context
+struct Acceptor {
+    Acceptor(net::io_context& ioc, std::shared_ptr<SessionLimiter> limiter)
+        : ioc(ioc)
+        , limiter(std::move(limiter)) {
+    }
+
+    net::io_context& ioc;
+    std::shared_ptr<SessionLimiter> limiter;
+    std::optional<SessionLimiter::Permit> permit;
+    int wakeups = 0;
+
+    bool TryAccept() {
+        permit = limiter->TryAcquire([this] {
+            ++wakeups;
+            net::post(ioc, [this] {
+                TryAccept();
+            });
+        });
+        return permit.has_value();
+    }
+};
+
+// Выполняет готовые обработчики. io_context без работы останавливается, поэтому перезапускается
+std::size_t Poll(net::io_context& ioc) {
+    ioc.restart();
+    return ioc.poll();
+}
+
+}  // namespace
+
+TEST_CASE("SessionLimiter hands a released place to the first waiter") {
+    net::io_context ioc;
+    auto limiter = std::make_shared<SessionLimiter>(2);
+    // Ожидающий запоминает адрес Acceptor, поэтому они не перемещаются
+    std::deque<Acceptor> acceptors;
+    for (int i = 0; i < 4; ++i) {
+        acceptors.emplace_back(ioc, limiter);
+    }
+
+    CHECK(acceptors[0].TryAccept());
+    CHECK(acceptors[1].TryAccept());
+    CHECK_FALSE(acceptors[2].TryAccept());
+    CHECK_FALSE(acceptors[3].TryAccept());
+    CHECK(limiter->GetActiveSessions() == 2);
+    CHECK(Poll(ioc) == 0);
+
+    // Завершение сессии будит одного ожидающего, в порядке очереди
+    acceptors[0].permit.reset();
+    CHECK(limiter->GetActiveSessions() == 1);
+    CHECK(acceptors[2].wakeups == 1);
+    CHECK(acceptors[3].wakeups == 0);
+
+    // Повторная попытка в io_context занимает освободившееся место
+    CHECK(Poll(ioc) == 1);
+    CHECK(acceptors[2].permit.has_value());
+    CHECK_FALSE(acceptors[3].permit.has_value());
+    CHECK(limiter->GetActiveSessions() == 2);
+
+    // Перемещающее присваивание разрешения возвращает прежнее место
+    acceptors[1].permit = std::move(acceptors[2].permit);
+    CHECK(limiter->GetActiveSessions() == 1);
+    CHECK(acceptors[3].wakeups == 1);
+    CHECK(Poll(ioc) == 1);
+    CHECK(acceptors[3].permit.has_value());
+    CHECK(limiter->GetActiveSessions() == 2);
+
+    // Очередь пуста: освобождение никого не будит
+    acceptors[1].permit.reset();
+    acceptors[3].permit.reset();
+    CHECK(limiter->GetActiveSessions() == 0);
+    CHECK(Poll(ioc) == 0);
+    for (const auto& acceptor : acceptors) {
+        CHECK(acceptor.wakeups <= 1);
+    }
+}
+
+TEST_CASE("SessionLimiter wakes a waiter that finds the place taken again") {
+    net::io_context ioc;
+    auto limiter = std::make_shared<SessionLimiter>(1);
+    Acceptor holder{ioc, limiter};
+    Acceptor waiter{ioc, limiter};
+    Acceptor intruder{ioc, limiter};
+
+    REQUIRE(holder.TryAccept());
+    REQUIRE_FALSE(waiter.TryAccept());
+    holder.permit.reset();
+    // Место заняли раньше, чем ожидающий повторил попытку: он снова встаёт в очередь
+    REQUIRE(intruder.TryAccept());
+    CHECK(Poll(ioc) == 1);
+    CHECK_FALSE(waiter.permit.has_value());
+
+    intruder.permit.reset();
+    CHECK(waiter.wakeups == 2);
+    CHECK(Poll(ioc) == 1);
+    CHECK(waiter.permit.has_value());
+}
+
+TEST_CASE("SessionLimiter without a limit never makes sessions wait") {
+    net::io_context ioc;
+    auto limiter = std::make_shared<SessionLimiter>(0);
+    std::vector<SessionLimiter::Permit> permits;
+    for (int i = 0; i < 100; ++i) {
+        auto permit = limiter->TryAcquire([] {
+            FAIL("unlimited limiter must not wait");
+        });
+        REQUIRE(permit);
+        permits.push_back(std::move(*permit));
+    }
+    CHECK(limiter->GetActiveSessions() == 100);
+    permits.clear();
+    CHECK(limiter->GetActiveSessions() == 0);
+}
@@ -0,0 +1,210 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/singleflight.h"
+
+using namespace http_server;
+
+namespace {
+
+// Отдаёт заданные части по одной и считает, сколько частей сформировано
+class PartsStream final : public BodyStream {
+public:
+    PartsStream(std::vector<std::string> parts, std::shared_ptr<int> produced)
+        : parts_(std::move(parts))
+        , produced_(std::move(produced)) {
+    }
+
+    bool Next(std::string& buffer) override {
+        if (fail_at_ == next_) {
+            throw std::runtime_error("source failed");
+        }
+        buffer += parts_[next_++];
+        ++*produced_;
+        return next_ < parts_.size();
+    }
+
+    std::size_t fail_at_ = static_cast<std::size_t>(-1);
+
+private:
+    std::vector<std::string> parts_;
+    std::size_t next_ = 0;
+    std::shared_ptr<int> produced_;
+};
+
+std::string ReadAll(BodyStream& stream) {
+    std::string body;
+    while (stream.Next(body)) {
+    }
+    return body;
+}
+
+}  // namespace
+
+TEST_CASE("SharedStream forms each part once for all readers") {
+    auto produced = std::make_shared<int>(0);
+    auto stream = std::make_shared<SharedStream>(
+        std::make_unique<PartsStream>(std::vector<std::string>{"ab", "cd", "ef"}, produced), 100);
+
+    auto first = stream->Join();
+    std::string first_body;
+    REQUIRE(first->Next(first_body));
+    CHECK(first_body == "ab");
+
+    // Присоединившийся позже читает тело с начала, уже сформированные части не формируются заново
+    auto second = stream->Join();
+    REQUIRE(second);
+    CHECK(ReadAll(*second) == "abcdef");
+    while (first->Next(first_body)) {
+    }
+    CHECK(first_body == "abcdef");
+    CHECK(*produced == 3);
+
+    // Тело сформировано целиком: присоединиться больше нельзя
+    CHECK(stream->Join() == nullptr);
+}
+
+TEST_CASE("SharedStream closes once the retained parts exceed the limit") {
+    auto produced = std::make_shared<int>(0);
+    auto stream = std::make_shared<SharedStream>(
+        std::make_unique<PartsStream>(std::vector<std::string>{"abc", "def", "ghi"}, produced), 4);
+
+    auto first = stream->Join();
+    auto second = stream->Join();
+    std::string first_body;
+    REQUIRE(first->Next(first_body));
+    REQUIRE(stream->Join());
+    REQUIRE(first->Next(first_body));
+    // Хранится 6 байт из 4 допустимых: новый ответ уже не прочитает тело с начала
+    CHECK(stream->Join() == nullptr);
+
+    // Отстающий ответ всё равно получает тело целиком
+    CHECK(ReadAll(*second) == "abcdefghi");
+    while (first->Next(first_body)) {
+    }
+    CHECK(first_body == "abcdefghi");
+    CHECK(*produced == 3);
+}
+
+TEST_CASE("SharedStream releases the owner when the last reader leaves") {
+    auto owner = std::make_shared<int>(1);
+    std::weak_ptr<int> weak_owner = owner;
+    auto produced = std::make_shared<int>(0);
+    auto stream = std::make_shared<SharedStream>(
+        std::make_unique<PartsStream>(std::vector<std::string>{"ab", "cd"}, produced), 100, std::move(owner));
+    std::weak_ptr<SharedStream> weak_stream = stream;
+
+    auto reader = stream->Join();
+    stream.reset();
+    CHECK_FALSE(weak_owner.expired());
+
+    // Ответ брошен, не дочитав тело: например, клиент отключился
+    reader.reset();
+    CHECK(weak_stream.expired());
+    CHECK(weak_owner.expired());
+}
+
+TEST_CASE("SharedStream reports a failed source to every reader") {
+    auto produced = std::make_shared<int>(0);
+    auto source = std::make_unique<PartsStream>(std::vector<std::string>{"ab", "cd"}, produced);
+    source->fail_at_ = 1;
+    auto stream = std::make_shared<SharedStream>(std::move(source), 100);
+
+    auto first = stream->Join();
+    auto second = stream->Join();
+    std::string body;
+    REQUIRE(first->Next(body));
+    CHECK_THROWS_AS(first->Next(body), std::runtime_error);
+    CHECK(stream->Join() == nullptr);
+
+    // Уже сформированную часть второй ответ получает, а дальше узнаёт об ошибке
+    std::string second_body;
+    REQUIRE(second->Next(second_body));
+    CHECK(second_body == "ab");
+    CHECK_THROWS_AS(second->Next(second_body), std::runtime_error);
+}
+
+TEST_CASE("StreamFlights joins a body that is being formed and starts a new one afterwards") {
+    StreamFlights<int> flights;
+    auto produced = std::make_shared<int>(0);
+    int sources = 0;
+    auto make_source = [&]() -> std::unique_ptr<BodyStream> {
+        ++sources;
+        return std::make_unique<PartsStream>(std::vector<std::string>{"ab", "cd"}, produced);
+    };
+
+    CHECK(flights.Join(1) == nullptr);
+    auto leader = flights.JoinOrStart(1, make_source, 100);
+    auto follower = flights.JoinOrStart(1, make_source, 100);
+    auto joined = flights.Join(1);
+    REQUIRE(joined);
+    // Тело с другим ключом формируется отдельно
+    auto other = flights.JoinOrStart(2, make_source, 100);
+    CHECK(sources == 2);
+
+    CHECK(ReadAll(*leader) == "abcd");
+    CHECK(ReadAll(*follower) == "abcd");
+    CHECK(ReadAll(*joined) == "abcd");
+    CHECK(ReadAll(*other) == "abcd");
+    CHECK(*produced == 4);
+
+    // Тело не кешируется: когда его дочитали, следующий запрос формирует его заново
+    leader.reset();
+    follower.reset();
+    joined.reset();
+    auto next = flights.JoinOrStart(1, make_source, 100);
+    CHECK(sources == 3);
+    CHECK(ReadAll(*next) == "abcd");
+
+    CHECK(flights.GetStats().leaders == 3);
+    CHECK(flights.GetStats().followers == 2);
+    CHECK(flights.GetStats().GetCoalescingRatio() == 2.0 / 5.0);
+
+    // Источник, который нельзя создать, не начинает тело
+    CHECK(flights.JoinOrStart(3, [] { return std::unique_ptr<BodyStream>{}; }, 100) == nullptr);
+    CHECK(flights.GetStats().leaders == 3);
+}
+
+TEST_CASE("StreamFlights readers on different threads get the same body") {
+    constexpr int THREADS = 4;
+    constexpr int ROUNDS = 500;
+
+    // Два экземпляра с общими счётчиками, как у таблиц разных шардов
+    auto stats = std::make_shared<CoalescingStats>();
+    StreamFlights<int> first{stats};
+    StreamFlights<int> second{stats};
+    std::atomic<int> mismatches{0};
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < ROUNDS; ++i) {
+                auto& flights = (i + t) % 2 == 0 ? first : second;
+                auto body = flights.JoinOrStart(
+                    i % 3,
+                    [] {
+                        return std::make_unique<PartsStream>(std::vector<std::string>{"0123", "4567", "89"},
+                                                             std::make_shared<int>(0));
+                    },
+                    6);
+                if (ReadAll(*body) != "0123456789") {
+                    ++mismatches;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Каждый запрос либо начал тело сам, либо присоединился к чужому, и каждый прочитал его целиком
+    CHECK(mismatches == 0);
+    CHECK(stats->leaders + stats->followers == THREADS * ROUNDS);
+    CHECK(&first.GetStats() == &second.GetStats());
+}
@@ -0,0 +1,165 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <latch>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../src/snapshot.h"
+
+using namespace util;
+
+namespace {
+
+// Снимок, который считает живые экземпляры
+struct Counted {
+    static inline std::atomic<int> live{0};
+
+    std::uint64_t value = 0;
+    std::vector<std::uint64_t> items;
+
+    Counted() {
+        ++live;
+    }
+
+    Counted(const Counted&) = delete;
+    Counted& operator=(const Counted&) = delete;
+
+    ~Counted() {
+        --live;
+    }
+};
+
+using Channel = SnapshotChannel<Counted>;
+
+void Publish(Channel& channel, std::uint64_t value) {
+    auto& next = channel.GetNextBuffer();
+    next.value = value;
+    next.items.assign(16, value);
+    channel.Publish();
+}
+
+}  // namespace
+
+TEST_CASE("SnapshotChannel reuses a snapshot nobody reads") {
+    Channel channel;
+    CHECK_FALSE(channel.Read());
+
+    Publish(channel, 1);
+    const Counted* first = channel.Read().Get();
+    REQUIRE(first != nullptr);
+    CHECK(first->value == 1);
+
+    Publish(channel, 2);
+    CHECK(channel.Read()->value == 2);
+    // Первый снимок больше не текущий и никем не читается: он становится следующим буфером
+    CHECK(&channel.GetNextBuffer() == first);
+    // Пока буфер не опубликован, писатель получает его же
+    CHECK(&channel.GetNextBuffer() == first);
+    CHECK(Counted::live == 2);
+}
+
+TEST_CASE("SnapshotChannel keeps a snapshot while it is read") {
+    Channel channel;
+    Publish(channel, 1);
+
+    std::optional<Channel::Reader> reader;
+    reader.emplace(channel);
+    const Counted* first = reader->Get();
+    for (std::uint64_t value = 2; value < 10; ++value) {
+        CHECK(&channel.GetNextBuffer() != first);
+        Publish(channel, value);
+        // Читатель видит снимок, который взял, нетронутым
+        CHECK((*reader)->value == 1);
+        CHECK((*reader)->items == std::vector<std::uint64_t>(16, 1));
+    }
+    CHECK(channel.Read()->value == 9);
+
+    SECTION("nested reads in one thread keep the snapshot too") {
+        {
+            const auto nested = channel.Read();
+            CHECK(nested->value == 9);
+        }
+        Publish(channel, 10);
+        CHECK(&channel.GetNextBuffer() != first);
+        CHECK((*reader)->value == 1);
+    }
+
+    SECTION("the snapshot is reclaimed after the reader leaves") {
+        reader.reset();
+        Publish(channel, 10);
+        Publish(channel, 11);
+        // Текущий снимок, следующий буфер и не больше двух свободных: остальные освобождены
+        channel.GetNextBuffer();
+        CHECK(Counted::live <= 4);
+    }
+}
+
+TEST_CASE("SnapshotChannel does not reclaim a snapshot read by another thread") {
+    Channel channel;
+    Publish(channel, 1);
+
+    std::latch reading{1};
+    std::latch published{1};
+    std::atomic<std::uint64_t> seen{0};
+    std::thread reader{[&] {
+        const auto snapshot = channel.Read();
+        reading.count_down();
+        published.wait();
+        seen = snapshot->value + snapshot->items.back();
+    }};
+    reading.wait();
+    const Counted* first = channel.Read().Get();
+    for (std::uint64_t value = 2; value < 6; ++value) {
+        CHECK(&channel.GetNextBuffer() != first);
+        Publish(channel, value);
+    }
+    published.count_down();
+    reader.join();
+    CHECK(seen == 2);
+
+    // Поток завершился и отпустил снимок: его память снова идёт в дело
+    Publish(channel, 6);
+    Publish(channel, 7);
+    CHECK(Counted::live <= 4);
+}
+
+TEST_CASE("SnapshotChannel readers never see a partially written snapshot") {
+    constexpr int READERS = 3;
+    constexpr std::uint64_t PUBLISHES = 2000;
+    {
+        Channel channel;
+        Publish(channel, 0);
+
+        std::atomic<bool> stop{false};
+        std::atomic<bool> torn{false};
+        std::vector<std::thread> readers;
+        for (int i = 0; i < READERS; ++i) {
+            readers.emplace_back([&] {
+                std::uint64_t last = 0;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    const auto snapshot = channel.Read();
+                    for (const auto item : snapshot->items) {
+                        torn = torn || item != snapshot->value;
+                    }
+                    // Снимки публикуются по возрастанию: читатель не видит более старый после нового
+                    torn = torn || snapshot->value < last;
+                    last = snapshot->value;
+                }
+            });
+        }
+        for (std::uint64_t value = 1; value <= PUBLISHES; ++value) {
+            Publish(channel, value);
+        }
+        stop = true;
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        CHECK_FALSE(torn);
+        CHECK(channel.Read()->value == PUBLISHES);
+    }
+    // Канал освобождает все снимки, включая ещё не переиспользованные
+    CHECK(Counted::live == 0);
+}
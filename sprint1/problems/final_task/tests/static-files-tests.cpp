@@ -0,0 +1,263 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "../src/static_files.h"
+
+using namespace http_handler;
+using namespace std::literals;
+namespace fs = std::filesystem;
+namespace http = http_server::http;
+
+namespace {
+
+// Время изменения файла и оно же в формате HTTP
+constexpr std::time_t MODIFIED = 784111777;
+constexpr auto MODIFIED_TEXT = "Sun, 06 Nov 1994 08:49:37 GMT"sv;
+
+// Временный каталог с файлом hello.txt ("0123456789") и StaticFiles, который его отдаёт
+struct StaticFilesFixture {
+    fs::path root = MakeRoot();
+    StaticFiles files{StaticFilesOptions{.root = root}};
+
+    ~StaticFilesFixture() {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+
+    static fs::path MakeRoot() {
+        static std::atomic<int> counter{0};
+        auto root = fs::temp_directory_path()
+                  / ("static-files-tests-" + std::to_string(::getpid()) + "-" + std::to_string(counter++));
+        fs::create_directories(root);
+        std::ofstream{root / "hello.txt"} << "0123456789";
+        const timespec times[2] = {{MODIFIED, 0}, {MODIFIED, 0}};
+        ::utimensat(AT_FDCWD, (root / "hello.txt").c_str(), times, 0);
+        return root;
+    }
+
+    http_server::Response Get(std::string_view target, http::field field = http::field::unknown,
+                              std::string_view value = {}) {
+        http_server::Request req{http::verb::get, std::string(target), 11};
+        if (field != http::field::unknown) {
+            req.set(field, std::string(value));
+        }
+        return files.Serve(req);
+    }
+};
+
+unsigned GetStatus(const http_server::Response& res) {
+    return std::visit(
+        [](const auto& response) -> unsigned {
+            if constexpr (requires { response.result_int(); }) {
+                return response.result_int();
+            } else {
+                return 0;
+            }
+        },
+        res);
+}
+
+std::string GetBody(const http_server::Response& res) {
+    const auto& body = std::get<http_server::SpanResponse>(res).body();
+    return {static_cast<const char*>(body.data.data()), body.data.size()};
+}
+
+std::string GetField(const http_server::Response& res, http::field field) {
+    const auto& header = std::get<http_server::SpanResponse>(res);
+    return std::string(header[field]);
+}
+
+}  // namespace
+
+TEST_CASE("DecodePath decodes the target relative to the root") {
+    CHECK(StaticFiles::DecodePath("/"sv) == ""s);
+    CHECK(StaticFiles::DecodePath("/index.html"sv) == "index.html"s);
+    CHECK(StaticFiles::DecodePath("/a/b.js?v=1"sv) == "a/b.js"s);
+    CHECK(StaticFiles::DecodePath("/my%20file%2Etxt"sv) == "my file.txt"s);
+    CHECK(StaticFiles::DecodePath("/a%2Fb"sv) == "a/b"s);
+    CHECK(StaticFiles::DecodePath("/./a//b/"sv) == "a/b/"s);
+    CHECK(StaticFiles::DecodePath("/a/..b/c.."sv) == "a/..b/c.."s);
+}
+
+TEST_CASE("DecodePath rejects paths leaving the root") {
+    for (auto target : {"/.."sv, "/../etc/passwd"sv, "/a/../../b"sv, "/a/.."sv, "/%2e%2e/x"sv, "/%2E%2e"sv,
+                        "/a%2F..%2Fb"sv, "/a/%2e%2e%2f%2e%2e/b"sv, "/a%00.txt"sv}) {
+        INFO(target);
+        CHECK_FALSE(StaticFiles::DecodePath(target));
+    }
+}
+
+TEST_CASE("DecodePath rejects malformed escapes") {
+    for (auto target : {"/a%"sv, "/a%2"sv, "/a%zz"sv, "/a%2g"sv}) {
+        INFO(target);
+        CHECK_FALSE(StaticFiles::DecodePath(target));
+    }
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles answers 400 to traversal and 404 to missing files") {
+    CHECK(GetStatus(Get("/../hello.txt"sv)) == 400);
+    CHECK(GetStatus(Get("/%2e%2e/hello.txt"sv)) == 400);
+    CHECK(GetStatus(Get("/missing.txt"sv)) == 404);
+
+    const auto res = Get("/hello.txt"sv);
+    REQUIRE(GetStatus(res) == 200);
+    CHECK(GetBody(res) == "0123456789"sv);
+    CHECK(GetField(res, http::field::last_modified) == MODIFIED_TEXT);
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles redirects a directory without a trailing slash") {
+    fs::create_directories(root / "docs");
+    std::ofstream{root / "docs" / "index.html"} << "<p>docs</p>";
+
+    auto get_location = [](const http_server::Response& res) {
+        return std::string(std::get<http_server::StringResponse>(res)[http::field::location]);
+    };
+    const auto redirect = Get("/docs"sv);
+    REQUIRE(GetStatus(redirect) == 301);
+    CHECK(get_location(redirect) == "/docs/"sv);
+    // Строка запроса переносится в Location
+    const auto with_query = Get("/docs?lang=ru&x=1"sv);
+    REQUIRE(GetStatus(with_query) == 301);
+    CHECK(get_location(with_query) == "/docs/?lang=ru&x=1"sv);
+
+    // Location строится из проверенного пути, а не из target: "//host/..." в нём был бы адресом
+    // на другом сервере
+    fs::create_directories(root / "evil.example" / "docs");
+    const auto protocol_relative = Get("//evil.example/docs?x=1"sv);
+    REQUIRE(GetStatus(protocol_relative) == 301);
+    CHECK(get_location(protocol_relative) == "/evil.example/docs/?x=1"sv);
+    CHECK(get_location(Get("/./docs"sv)) == "/docs/"sv);
+    fs::create_directories(root / "my docs");
+    CHECK(get_location(Get("/my%20docs"sv)) == "/my%20docs/"sv);
+
+    const auto index = Get("/docs/"sv);
+    REQUIRE(GetStatus(index) == 200);
+    CHECK(GetBody(index) == "<p>docs</p>"sv);
+    // Каталог без index.html по-прежнему не найден
+    fs::create_directories(root / "empty");
+    CHECK(GetStatus(Get("/empty/"sv)) == 404);
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles serves a single byte range") {
+    auto check_range = [&](std::string_view range, std::string_view body, std::string_view content_range) {
+        INFO(range);
+        const auto res = Get("/hello.txt"sv, http::field::range, range);
+        REQUIRE(GetStatus(res) == 206);
+        CHECK(GetBody(res) == body);
+        CHECK(GetField(res, http::field::content_range) == content_range);
+        CHECK(GetField(res, http::field::content_length) == std::to_string(body.size()));
+    };
+    check_range("bytes=2-4"sv, "234"sv, "bytes 2-4/10"sv);
+    check_range("bytes=7-"sv, "789"sv, "bytes 7-9/10"sv);
+    check_range("bytes=8-100"sv, "89"sv, "bytes 8-9/10"sv);
+    check_range("bytes=-3"sv, "789"sv, "bytes 7-9/10"sv);
+    check_range("bytes=-100"sv, "0123456789"sv, "bytes 0-9/10"sv);
+
+    SECTION("ranges outside the file are not satisfiable") {
+        for (auto range : {"bytes=10-"sv, "bytes=10-20"sv, "bytes=-0"sv}) {
+            INFO(range);
+            CHECK(GetStatus(Get("/hello.txt"sv, http::field::range, range)) == 416);
+        }
+    }
+
+    SECTION("malformed and multiple ranges give the whole file") {
+        for (auto range : {"bytes=4-2"sv, "bytes=1-2,4-5"sv, "items=1-2"sv, "bytes=a-b"sv, "bytes=1"sv, "bytes=-"sv}) {
+            INFO(range);
+            const auto res = Get("/hello.txt"sv, http::field::range, range);
+            REQUIRE(GetStatus(res) == 200);
+            CHECK(GetBody(res) == "0123456789"sv);
+        }
+    }
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles answers 304 to If-Modified-Since not older than the file") {
+    CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, MODIFIED_TEXT)) == 304);
+    CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, "Sun, 06 Nov 1994 08:49:38 GMT"sv)) == 304);
+    CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, "Mon, 01 Jan 2035 00:00:00 GMT"sv)) == 304);
+
+    SECTION("an older date gives the file") {
+        CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, "Sun, 06 Nov 1994 08:49:36 GMT"sv)) == 200);
+        CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, "Sat, 05 Nov 1994 08:49:37 GMT"sv)) == 200);
+    }
+
+    SECTION("dates in other formats are ignored") {
+        for (auto date : {"Sunday, 06-Nov-94 08:49:37 GMT"sv, "Sun Nov  6 08:49:37 1994"sv,
+                          "Sun, 06 Nov 1994 08:49:37 UTC"sv, "Sun, 06 Xyz 2035 08:49:37 GMT"sv, "garbage"sv}) {
+            INFO(date);
+            CHECK(GetStatus(Get("/hello.txt"sv, http::field::if_modified_since, date)) == 200);
+        }
+    }
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles sends text files gzipped to clients accepting gzip") {
+    const std::string text(4096, 'a');
+    std::ofstream{root / "text.txt"} << text;
+
+    const auto gzipped = Get("/text.txt"sv, http::field::accept_encoding, "deflate, gzip"sv);
+    REQUIRE(GetStatus(gzipped) == 200);
+    CHECK(GetField(gzipped, http::field::content_encoding) == "gzip"sv);
+    CHECK(GetField(gzipped, http::field::vary) == "Accept-Encoding"sv);
+    const auto body = GetBody(gzipped);
+    CHECK(body.size() < text.size());
+    CHECK(body.starts_with("\x1f\x8b"sv));
+
+    SECTION("identity is sent when gzip is not accepted") {
+        for (auto accept_encoding : {""sv, "br"sv, "gzip;q=0"sv}) {
+            INFO(accept_encoding);
+            const auto res = Get("/text.txt"sv, http::field::accept_encoding, accept_encoding);
+            REQUIRE(GetStatus(res) == 200);
+            CHECK(GetField(res, http::field::content_encoding).empty());
+            CHECK(GetBody(res) == text);
+        }
+    }
+
+    SECTION("ranges are served from the identity representation") {
+        http_server::Request req{http::verb::get, "/text.txt", 11};
+        req.set(http::field::accept_encoding, "gzip");
+        req.set(http::field::range, "bytes=0-1");
+        const auto res = files.Serve(req);
+        REQUIRE(GetStatus(res) == 206);
+        CHECK(GetField(res, http::field::content_encoding).empty());
+        CHECK(GetBody(res) == "aa"sv);
+    }
+}
+
+TEST_CASE_METHOD(StaticFilesFixture, "StaticFiles sends text replies to HEAD without a body") {
+    fs::create_directories(root / "docs");
+    auto head = [&](std::string_view target, http::field field = http::field::unknown, std::string_view value = {}) {
+        http_server::Request req{http::verb::head, std::string(target), 11};
+        if (field != http::field::unknown) {
+            req.set(field, std::string(value));
+        }
+        return std::get<http_server::StringResponse>(files.Serve(req));
+    };
+
+    const auto not_found = head("/missing.txt"sv);
+    CHECK(not_found.result_int() == 404);
+    CHECK(not_found.body().empty());
+    CHECK(std::string(not_found[http::field::content_length]) == std::to_string("File not found"sv.size()));
+
+    const auto bad_request = head("/../secret"sv);
+    CHECK(bad_request.result_int() == 400);
+    CHECK(bad_request.body().empty());
+
+    const auto redirect = head("/docs"sv);
+    CHECK(redirect.result_int() == 301);
+    CHECK(std::string(redirect[http::field::location]) == "/docs/"sv);
+    CHECK(redirect.body().empty());
+    CHECK(std::string(redirect[http::field::content_length]) != "0"sv);
+
+    const auto unsatisfiable = head("/hello.txt"sv, http::field::range, "bytes=100-"sv);
+    CHECK(unsatisfiable.result_int() == 416);
+    CHECK(std::string(unsatisfiable[http::field::content_range]) == "bytes */10"sv);
+    CHECK(unsatisfiable.body().empty());
+}
@@ -0,0 +1,131 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "../src/tick_engine.h"
+
+using namespace model;
+using namespace std::chrono_literals;
+using namespace std::literals;
+
+namespace {
+
+// Период в 1/64 секунды: шаг собаки speed * dt и его суммы точно представимы в double,
+// поэтому положение после n тиков равно n * speed * dt без ошибки округления
+constexpr auto PERIOD = 15625us;
+constexpr double DT = 1.0 / 64;
+constexpr std::size_t SESSIONS = 12;
+constexpr std::size_t DOGS_PER_SESSION = 3;
+constexpr std::uint64_t TICKS = 20;
+
+double GetSpeed(std::size_t session, std::size_t dog) {
+    return static_cast<double>(1 + session * DOGS_PER_SESSION + dog);
+}
+
+// Все ли собаки снимка прошли ровно state.tick шагов
+bool AdvancedByTicks(const GameState& state) {
+    if (state.sessions.size() != SESSIONS) {
+        return false;
+    }
+    for (std::size_t session = 0; session < SESSIONS; ++session) {
+        const auto& dogs = state.sessions[session].dogs;
+        if (dogs.size() != DOGS_PER_SESSION) {
+            return false;
+        }
+        for (std::size_t dog = 0; dog < DOGS_PER_SESSION; ++dog) {
+            if (dogs[dog].position.x != static_cast<double>(state.tick) * GetSpeed(session, dog) * DT) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("TickEngine advances every session once per tick before on_tick") {
+    Map map{Map::Id{"map1"s}, "Map 1"s};
+    map.AddRoad({Road::HORIZONTAL, Point{0, 0}, 1'000'000});
+    map.Compile();
+
+    std::vector<std::unique_ptr<GameSession>> sessions;
+    std::vector<GameSession*> session_ptrs;
+    for (std::size_t session = 0; session < SESSIONS; ++session) {
+        auto& game_session = *sessions.emplace_back(std::make_unique<GameSession>(map));
+        for (std::size_t dog = 0; dog < DOGS_PER_SESSION; ++dog) {
+            const auto handle = game_session.GetDogs().Add({0, 0});
+            game_session.GetDogs().Get(handle).SetMovement(Direction::EAST, GetSpeed(session, dog));
+        }
+        session_ptrs.push_back(&game_session);
+    }
+
+    // on_tick вызывается потоком расписания: результаты проверяются после остановки
+    std::vector<std::uint64_t> ticks_seen;
+    std::vector<bool> complete;
+    std::promise<void> enough;
+    TickEngineOptions options;
+    options.period = PERIOD;
+    options.threads = 4;
+    options.on_tick = [&](const GameState& state) {
+        ticks_seen.push_back(state.tick);
+        complete.push_back(AdvancedByTicks(state));
+        if (ticks_seen.size() == TICKS) {
+            enough.set_value();
+        }
+    };
+    TickEngine engine{std::move(session_ptrs), std::move(options)};
+    REQUIRE(engine.GetStates().Read()->tick == 0);
+    CHECK(AdvancedByTicks(*engine.GetStates().Read()));
+
+    engine.Start();
+    enough.get_future().wait();
+    engine.Stop();
+
+    // Остановка дожидается конца текущего тика, поэтому тиков может быть чуть больше TICKS
+    const auto last = engine.GetStates().Read();
+    REQUIRE(last->tick >= TICKS);
+    CHECK(engine.GetStats().duration.ticks == last->tick);
+    // Один вызов on_tick на каждый тик, по порядку, и каждый видит тик завершённым во всех сеансах
+    REQUIRE(ticks_seen.size() == last->tick);
+    for (std::size_t i = 0; i < ticks_seen.size(); ++i) {
+        INFO("tick " << i + 1);
+        CHECK(ticks_seen[i] == i + 1);
+        CHECK(complete[i]);
+    }
+    CHECK(AdvancedByTicks(*last));
+    for (std::size_t session = 0; session < SESSIONS; ++session) {
+        CHECK(engine.GetSessionStats(session).ticks == last->tick);
+    }
+}
+
+TEST_CASE("GameSession spawns dogs on the roads of its map") {
+    Map map{Map::Id{"map1"s}, "Map 1"s};
+    map.AddRoad({Road::HORIZONTAL, Point{0, 0}, 10});
+    map.AddRoad({Road::VERTICAL, Point{10, 0}, 10});
+    map.Compile();
+    GameSession session{map};
+    std::mt19937_64 random{1};
+
+    session.SpawnDogs(100, random);
+    SessionState state;
+    session.CopyState(state);
+    REQUIRE(state.dogs.size() == 100);
+    for (const auto& dog : state.dogs) {
+        // Каждая собака стоит на одной из двух дорог
+        const bool on_horizontal = dog.position.y == 0 && dog.position.x >= 0 && dog.position.x <= 10;
+        const bool on_vertical = dog.position.x == 10 && dog.position.y >= 0 && dog.position.y <= 10;
+        CHECK((on_horizontal || on_vertical));
+    }
+
+    SECTION("a map without roads gets no dogs") {
+        Map empty{Map::Id{"empty"s}, "Empty"s};
+        empty.Compile();
+        GameSession empty_session{empty};
+        empty_session.SpawnDogs(10, random);
+        CHECK(empty_session.GetDogs().GetSize() == 0);
+    }
+}
@@ -0,0 +1,147 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <boost/asio/io_context.hpp>
+#include <chrono>
+#include <memory>
+
+#include "../src/timer_wheel.h"
+
+using namespace http_server;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr auto TICK = 1ms;
+constexpr std::size_t SLOTS = 8;
+
+struct CountingEntry : TimerWheel::Entry {
+    int fired = 0;
+
+    void OnTimeout() noexcept override {
+        ++fired;
+    }
+};
+
+// Колесо, тики которого прокручиваются вручную: каждый run_one выполняет ровно один тик
+struct TimerWheelFixture {
+    net::io_context ioc;
+    std::shared_ptr<TimerWheel> wheel = std::make_shared<TimerWheel>(ioc, TICK, SLOTS);
+
+    TimerWheelFixture() {
+        wheel->Start();
+    }
+
+    void RunTicks(int count) {
+        for (int i = 0; i < count; ++i) {
+            REQUIRE(ioc.run_one() == 1);
+        }
+    }
+
+    // Сколько тиков прошло до срабатывания entry, не больше limit
+    int TicksUntilFired(CountingEntry& entry, int limit = 2 * SLOTS) {
+        for (int ticks = 1; ticks <= limit; ++ticks) {
+            RunTicks(1);
+            if (entry.fired != 0) {
+                return ticks;
+            }
+        }
+        return -1;
+    }
+};
+
+}  // namespace
+
+TEST_CASE_METHOD(TimerWheelFixture, "TimerWheel fires no earlier than the timeout and within one tick after it") {
+    CountingEntry entry;
+
+    SECTION("zero timeout fires on the next tick") {
+        wheel->Schedule(entry, 0ms);
+        CHECK(TicksUntilFired(entry) == 1);
+    }
+    SECTION("whole ticks get one more tick for the one already under way") {
+        wheel->Schedule(entry, 3 * TICK);
+        CHECK(TicksUntilFired(entry) == 4);
+    }
+    SECTION("a partial tick rounds up") {
+        wheel->Schedule(entry, 3 * TICK + 1ns);
+        CHECK(TicksUntilFired(entry) == 5);
+    }
+    SECTION("slots wrap around the wheel") {
+        RunTicks(SLOTS - 2);
+        wheel->Schedule(entry, 4 * TICK);
+        CHECK(TicksUntilFired(entry) == 5);
+    }
+    CHECK(entry.fired == 1);
+}
+
+TEST_CASE_METHOD(TimerWheelFixture, "TimerWheel clamps long timeouts to the wheel size") {
+    CountingEntry entry;
+    wheel->Schedule(entry, 100 * TICK);
+    CHECK(TicksUntilFired(entry) == static_cast<int>(SLOTS - 1));
+
+    CountingEntry hour;
+    wheel->Schedule(hour, 1h);
+    CHECK(TicksUntilFired(hour) == static_cast<int>(SLOTS - 1));
+    // Сработавшая запись снята с колеса и при следующем обороте не срабатывает снова
+    RunTicks(2 * SLOTS);
+    CHECK(entry.fired == 1);
+    CHECK(hour.fired == 1);
+}
+
+TEST_CASE_METHOD(TimerWheelFixture, "TimerWheel moves a rescheduled entry") {
+    CountingEntry entry;
+    wheel->Schedule(entry, 5 * TICK);
+
+    SECTION("to an earlier slot") {
+        wheel->Schedule(entry, 1 * TICK);
+        CHECK(TicksUntilFired(entry) == 2);
+    }
+    SECTION("to a later slot") {
+        RunTicks(3);
+        wheel->Schedule(entry, 5 * TICK);
+        CHECK(TicksUntilFired(entry) == 6);
+    }
+    // В прежнем слоте записи не осталось
+    RunTicks(2 * SLOTS);
+    CHECK(entry.fired == 1);
+}
+
+TEST_CASE_METHOD(TimerWheelFixture, "TimerWheel cancels entries linked into one slot") {
+    // Три записи в одном слоте: последняя поставленная — голова списка
+    CountingEntry first;
+    CountingEntry middle;
+    CountingEntry head;
+    wheel->Schedule(first, 2 * TICK);
+    wheel->Schedule(middle, 2 * TICK);
+    wheel->Schedule(head, 2 * TICK);
+
+    SECTION("from the middle") {
+        wheel->Cancel(middle);
+        RunTicks(3);
+        CHECK(first.fired == 1);
+        CHECK(middle.fired == 0);
+        CHECK(head.fired == 1);
+    }
+    SECTION("from the head and the tail") {
+        wheel->Cancel(head);
+        wheel->Cancel(first);
+        RunTicks(3);
+        CHECK(first.fired == 0);
+        CHECK(middle.fired == 1);
+        CHECK(head.fired == 0);
+    }
+    SECTION("all of them, twice") {
+        for (auto* entry : {&first, &middle, &head}) {
+            wheel->Cancel(*entry);
+            wheel->Cancel(*entry);
+        }
+        RunTicks(2 * SLOTS);
+        CHECK(first.fired + middle.fired + head.fired == 0);
+    }
+
+    // Снятую запись можно поставить снова, а запись вне колеса — снять
+    CountingEntry idle;
+    wheel->Cancel(idle);
+    wheel->Schedule(middle, 0ms);
+    CHECK(TicksUntilFired(middle) == 1);
+}
@@ -0,0 +1,255 @@
+// tools/embed_static.cpp
+// Генератор встроенных статических файлов. Запускается при сборке:
+//   embed_static <output.cpp> [static_dir]
+// Обходит каталог и записывает в output.cpp массив EmbeddedFile (см. src/embedded_static.h):
+// содержимое файлов, тип содержимого, ETag и вариант, сжатый gzip с максимальной степенью сжатия,
+// а также совершенную хеш-таблицу для FindEmbeddedFile. Если каталог не указан или не существует,
+// получается пустой набор файлов.
+// Файлы обходятся в порядке путей, поэтому одинаковый каталог всегда даёт одинаковый output.cpp
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "content_type.h"
+#include "embedded_static.h"
+#include "etag.h"
+#include "gzip.h"
+
+using namespace std::literals;
+namespace fs = std::filesystem;
+
+namespace {
+
+struct File {
+    std::string path;
+    std::string data;
+    std::string gzip;
+};
+
+std::string ReadFile(const fs::path& path) {
+    std::ifstream input{path, std::ios::binary};
+    if (!input) {
+        throw std::runtime_error("Failed to open " + path.string());
+    }
+    return {std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>()};
+}
+
+std::vector<File> ReadFiles(const fs::path& root) {
+    std::vector<File> files;
+    for (const auto& entry : fs::recursive_directory_iterator(root)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        File file;
+        file.path = entry.path().lexically_relative(root).generic_string();
+        file.data = ReadFile(entry.path());
+        // Сжатый вариант хранится, только если он заметно меньше
+        auto gzip = http_server::GzipCompress(file.data, 9);
+        if (http_server::IsWorthCompressing(file.data.size(), gzip.size())) {
+            file.gzip = std::move(gzip);
+        }
+        files.push_back(std::move(file));
+    }
+    std::sort(files.begin(), files.end(), [](const File& lhs, const File& rhs) {
+        return lhs.path < rhs.path;
+    });
+    return files;
+}
+
+// Совершенная хеш-таблица методом «хеширование и смещение»: ключи делятся на корзины по
+// EmbeddedHash(path, 0), и для каждой корзины подбирается затравка, при которой все её ключи
+// попадают в ещё свободные ячейки. Корзины обрабатываются от больших к меньшим
+struct PerfectHash {
+    std::vector<std::uint32_t> seeds;
+    std::vector<std::int32_t> slots;
+};
+
+PerfectHash BuildPerfectHash(const std::vector<File>& files) {
+    PerfectHash table;
+    if (files.empty()) {
+        return table;
+    }
+    const auto bucket_count = std::max<std::size_t>(1, files.size() / 2);
+    const auto slot_count = files.size();
+    std::vector<std::vector<std::size_t>> buckets(bucket_count);
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        buckets[http_handler::EmbeddedHash(files[i].path, 0) % bucket_count].push_back(i);
+    }
+    std::vector<std::size_t> order(bucket_count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs) {
+        return buckets[lhs].size() > buckets[rhs].size();
+    });
+
+    table.seeds.assign(bucket_count, 0);
+    table.slots.assign(slot_count, -1);
+    for (const auto bucket : order) {
+        if (buckets[bucket].empty()) {
+            break;
+        }
+        for (std::uint32_t seed = 1;; ++seed) {
+            if (seed == 0) {
+                throw std::runtime_error("Failed to build perfect hash table");
+            }
+            std::vector<std::size_t> taken;
+            bool fits = true;
+            for (const auto file : buckets[bucket]) {
+                const auto slot = http_handler::EmbeddedHash(files[file].path, seed) % slot_count;
+                if (table.slots[slot] != -1 || std::find(taken.begin(), taken.end(), slot) != taken.end()) {
+                    fits = false;
+                    break;
+                }
+                taken.push_back(slot);
+            }
+            if (!fits) {
+                continue;
+            }
+            for (std::size_t i = 0; i < taken.size(); ++i) {
+                table.slots[taken[i]] = static_cast<std::int32_t>(buckets[bucket][i]);
+            }
+            table.seeds[bucket] = seed;
+            break;
+        }
+    }
+    return table;
+}
+
+// Строковый литерал C++ с произвольными байтами. Непечатаемые байты записываются
+// восьмеричными escape-последовательностями из трёх цифр: они не продолжаются следующим символом
+void WriteLiteral(std::ostream& out, std::string_view bytes) {
+    constexpr std::size_t LINE_SIZE = 100;
+    out << "std::string_view{";
+    if (bytes.empty()) {
+        out << "}";
+        return;
+    }
+    // Короткая строка (путь, тип, ETag) записывается в одну строку исходника
+    const bool inline_literal = bytes.size() <= LINE_SIZE / 2;
+    std::size_t column = 0;
+    out << (inline_literal ? "\"" : "\n        \"");
+    for (unsigned char c : bytes) {
+        if (column >= LINE_SIZE) {
+            out << "\"\n        \"";
+            column = 0;
+        }
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+            column += 2;
+        } else if (c >= 0x20 && c < 0x7f && c != '?') {
+            // '?' экранируется, чтобы не образовать триграф в старых компиляторах
+            out << c;
+            ++column;
+        } else {
+            out << '\\' << static_cast<char>('0' + (c >> 6)) << static_cast<char>('0' + ((c >> 3) & 7))
+                << static_cast<char>('0' + (c & 7));
+            column += 4;
+        }
+    }
+    out << (inline_literal ? "\", " : "\",\n        ") << bytes.size() << "}";
+}
+
+void WriteSource(std::ostream& out, const std::vector<File>& files, const PerfectHash& table) {
+    out << "// Сгенерировано tools/embed_static.cpp при сборке. Не редактировать\n"
+           "#include <array>\n"
+           "#include <cstdint>\n"
+           "#include <string_view>\n"
+           "\n"
+           "#include \"embedded_static.h\"\n"
+           "\n"
+           "namespace http_handler {\n"
+           "\n"
+           "namespace {\n"
+           "\n";
+    out << "constexpr std::array<EmbeddedFile, " << files.size() << "> FILES = {\n";
+    for (const auto& file : files) {
+        out << "    EmbeddedFile{\n        ";
+        WriteLiteral(out, file.path);
+        out << ",\n        ";
+        WriteLiteral(out, http_server::GetContentType(file.path));
+        out << ",\n        ";
+        WriteLiteral(out, http_server::MakeStrongETag(file.data));
+        out << ",\n        ";
+        WriteLiteral(out, file.data);
+        out << ",\n        ";
+        WriteLiteral(out, file.gzip);
+        out << ",\n        ";
+        WriteLiteral(out, file.gzip.empty() ? ""sv : http_server::MakeStrongETag(file.gzip));
+        out << ",\n    },\n";
+    }
+    out << "};\n\n";
+
+    auto write_array = [&](std::string_view type, std::string_view name, const auto& values) {
+        out << "constexpr std::array<" << type << ", " << values.size() << "> " << name << " = {";
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            out << (i % 12 == 0 ? "\n    " : " ") << values[i] << ',';
+        }
+        out << "\n};\n\n";
+    };
+    write_array("std::uint32_t"sv, "SEEDS"sv, table.seeds);
+    write_array("std::int32_t"sv, "SLOTS"sv, table.slots);
+
+    out << "}  // namespace\n"
+           "\n"
+           "const EmbeddedFile* FindEmbeddedFile(std::string_view path) noexcept {\n";
+    if (files.empty()) {
+        out << "    static_cast<void>(path);\n"
+               "    return nullptr;\n";
+    } else {
+        out << "    const auto seed = SEEDS[EmbeddedHash(path, 0) % SEEDS.size()];\n"
+               "    const auto index = SLOTS[EmbeddedHash(path, seed) % SLOTS.size()];\n"
+               "    if (index < 0 || FILES[index].path != path) {\n"
+               "        return nullptr;\n"
+               "    }\n"
+               "    return &FILES[index];\n";
+    }
+    out << "}\n"
+           "\n"
+           "std::size_t GetEmbeddedFileCount() noexcept {\n"
+           "    return FILES.size();\n"
+           "}\n"
+           "\n"
+           "}  // namespace http_handler\n";
+}
+
+}  // namespace
+
+int main(int argc, const char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: embed_static <output.cpp> [static_dir]"sv << std::endl;
+        return EXIT_FAILURE;
+    }
+    try {
+        std::vector<File> files;
+        if (argc == 3 && fs::is_directory(argv[2])) {
+            files = ReadFiles(argv[2]);
+        }
+        const auto table = BuildPerfectHash(files);
+
+        std::ostringstream source;
+        WriteSource(source, files, table);
+        // Файл перезаписывается, только если содержимое изменилось: иначе при каждой сборке
+        // пересобиралась бы библиотека сервера
+        const fs::path output{argv[1]};
+        if (fs::exists(output) && ReadFile(output) == source.str()) {
+            return EXIT_SUCCESS;
+        }
+        fs::create_directories(output.parent_path());
+        std::ofstream out{output, std::ios::binary};
+        out << source.str();
+        if (!out) {
+            throw std::runtime_error("Failed to write " + output.string());
+        }
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}